@@ -0,0 +1,103 @@
+#include "connections.h"
+#include "inline_query.h"
+#include "joins.h"
+#include "local_joins.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compares the client-side hash joins with the server-side joins on generated tables.
+// Server time covers the join on the server only; local time covers the join on
+// tables already fetched to the client, with fetch time reported separately.
+
+class Timer {
+    std::chrono::high_resolution_clock::time_point start_time;
+public:
+    Timer() : start_time(std::chrono::high_resolution_clock::now()) {}
+
+    double elapsed() {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end_time - start_time).count();
+    }
+};
+
+struct Case {
+    const char* name;
+    K (*local)(K, K, const std::vector<std::string>&, const joins::LocalJoinOptions&);
+    joins::JoinResult (*server)(const std::string&, const std::string&, const std::string&,
+                                const std::vector<std::string>&);
+};
+
+int main(int argc, char** argv) {
+    long long left_rows = argc > 1 ? std::stoll(argv[1]) : 1000000;
+    long long right_rows = argc > 2 ? std::stoll(argv[2]) : left_rows / 2;
+    const int repeats = 5;
+
+    if (!KDBConnection::connect("localhost", 6000)) {
+        std::cerr << "Failed to connect to KDB+ server" << std::endl;
+        return 1;
+    }
+
+    // Two-column keys of mixed types: a symbol and an int
+    std::string n_left = std::to_string(left_rows);
+    std::string n_right = std::to_string(right_rows);
+    if (!inline_query("bench_left:([] sym:" + n_left + "?`4; id:" + n_left + "?100000i; px:" + n_left + "?100f)") ||
+        !inline_query("bench_right:([] sym:" + n_right + "?`4; id:" + n_right + "?100000i; bid:" + n_right +
+                      "?100f; size:" + n_right + "?1000)")) {
+        std::cerr << "Failed to create benchmark tables" << std::endl;
+        return 1;
+    }
+
+    Timer fetch_timer;
+    K left = inline_query("bench_left").get_result();
+    K right = inline_query("bench_right").get_result();
+    double fetch_seconds = fetch_timer.elapsed();
+    if (!left || !right) {
+        std::cerr << "Failed to fetch benchmark tables" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Left rows: " << left_rows << ", right rows: " << right_rows
+              << ", fetch: " << std::fixed << std::setprecision(3) << fetch_seconds << " s\n\n";
+    std::cout << std::left << std::setw(8) << "join" << std::right << std::setw(12) << "server s"
+              << std::setw(12) << "local s" << std::setw(10) << "speedup" << "\n";
+
+    const std::vector<std::string> keys = {"sym", "id"};
+    Case cases[] = {
+        {"inner", joins::local_inner_join, joins::inner_join},
+        {"left", joins::local_left_join, joins::left_join},
+        {"right", joins::local_right_join, joins::right_join},
+    };
+    for (const auto& c : cases) {
+        double server_best = 1e9;
+        double local_best = 1e9;
+        for (int i = 0; i < repeats; ++i) {
+            Timer server_timer;
+            auto result = c.server("bench_left", "bench_right", "bench_result", keys);
+            server_best = std::min(server_best, server_timer.elapsed());
+            if (!result) {
+                std::cerr << "Server " << c.name << " join failed" << std::endl;
+                break;
+            }
+
+            Timer local_timer;
+            K joined = c.local(left, right, keys, joins::LocalJoinOptions());
+            local_best = std::min(local_best, local_timer.elapsed());
+            if (!joined) {
+                std::cerr << "Local " << c.name << " join failed" << std::endl;
+                break;
+            }
+            r0(joined);
+        }
+        std::cout << std::left << std::setw(8) << c.name << std::right << std::setw(12) << server_best
+                  << std::setw(12) << local_best << std::setw(9) << server_best / local_best << "x\n";
+    }
+
+    r0(left);
+    r0(right);
+    inline_query("delete bench_left, bench_right, bench_result from `.");
+    KDBConnection::disconnect();
+    return 0;
+}
@@ -172,7 +172,7 @@ int main() {
             join_cols
         );
         if (asof_result) {
-            print_result(inline_query("5#trade_quote_asof").get_result());
+            print_result(asof_result.fetch_rows(0, 5));
         }
 
         // Demonstrate window join for previous 1-second quote context
@@ -188,7 +188,7 @@ int main() {
             join_cols
         );
         if (window_result) {
-            print_result(inline_query("5#trade_quote_window").get_result());
+            print_result(window_result.fetch_rows(0, 5));
         }
 
         // Use left join to keep all trades even without matching quotes (although this demo has all matching quotes)
@@ -200,7 +200,7 @@ int main() {
             {}  // Natural join on matching columns, will use first common column
         );
         if (left_result) {
-            print_result(inline_query("5#trade_quote_left").get_result());
+            print_result(left_result.fetch_rows(0, 5));
         }
 
         // Calculate metrics using the joined data
@@ -58,6 +58,7 @@ private:
     };
 
     static I instance_handle; ///< Singleton connection handle.
+    static thread_local I thread_handle; ///< Handle bound to the calling thread, if any.
     static std::unique_ptr<Cleanup> cleanup_handler; ///< Cleanup handler instance.
 
 public:
@@ -80,7 +81,20 @@ public:
     static void disconnect();
 
     /**
-     * @brief Retrieves the connection handle for the singleton connection.
+     * @brief Routes the calling thread's queries through its own connection.
+     *
+     * A handle may only carry one request at a time, so threads running
+     * queries concurrently (e.g. joins) each open a connection with
+     * `connect()` and bind it here. The caller keeps ownership of the handle.
+     *
+     * @param handle Connection handle for this thread, or 0 to fall back to the singleton.
+     */
+    static void bind_thread(I handle);
+
+    /**
+     * @brief Retrieves the connection handle for the calling thread.
+     *
+     * This is the handle bound with `bind_thread`, or the singleton connection.
      *
      * @return I Connection handle to the KDB+ server.
      * @throws std::runtime_error If not connected to the server.
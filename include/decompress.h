@@ -0,0 +1,93 @@
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Compression formats recognised for input files.
+ */
+enum class Compression {
+    None,
+    Gzip,   ///< gzip / zlib, always available
+    Zstd    ///< zstd, requires building with ZSTD=1
+};
+
+/**
+ * @brief Detects the compression format of a file from its magic bytes.
+ *
+ * @param filename Path of the file to inspect.
+ * @return Compression The detected format, or `Compression::None` for plain
+ *         (or unreadable) files.
+ */
+Compression detect_compression(const std::string& filename);
+
+/**
+ * @class DecompressingReader
+ * @brief Streams the decompressed contents of a file in blocks.
+ *
+ * Decompression runs on a dedicated thread that fills a bounded queue of
+ * blocks, so inflating the next block overlaps with the caller parsing the
+ * current one while memory use stays capped at `max_blocks * block_size`.
+ * Plain files are passed through unchanged.
+ */
+class DecompressingReader {
+public:
+    /**
+     * @param filename Path of the (possibly compressed) file.
+     * @param compression Format of the file, usually from `detect_compression`.
+     * @param block_size Target size of each decompressed block in bytes.
+     * @param max_blocks Number of blocks that may be queued ahead of the reader.
+     */
+    DecompressingReader(const std::string& filename,
+                        Compression compression,
+                        size_t block_size = 1 << 20,
+                        size_t max_blocks = 4);
+    ~DecompressingReader();
+
+    DecompressingReader(const DecompressingReader&) = delete;
+    DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+    /**
+     * @brief Retrieves the next decompressed block, waiting for it if necessary.
+     *
+     * @param block Receives the block contents.
+     * @return bool False once the stream is exhausted or decompression failed.
+     */
+    bool next(std::string& block);
+
+    /**
+     * @brief Whether the stream stopped because of an error.
+     */
+    bool failed() const;
+
+    /**
+     * @brief Description of the error that stopped the stream, if any.
+     */
+    std::string error() const;
+
+private:
+    void produce();
+    bool push(std::string&& block);
+    void finish(const std::string& error = "");
+
+    std::string filename_;
+    Compression compression_;
+    size_t block_size_;
+    size_t max_blocks_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<std::string> blocks_;
+    bool done_ = false;   ///< Producer has finished (end of input or error)
+    bool stop_ = false;   ///< Consumer has gone away, producer should exit
+    std::string error_;
+    std::thread worker_;
+};
+
+#endif // DECOMPRESS_H
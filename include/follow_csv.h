@@ -0,0 +1,127 @@
+#ifndef FOLLOW_CSV_H
+#define FOLLOW_CSV_H
+
+#include "table_builder.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options for following a growing CSV file.
+ */
+struct FollowOptions {
+    bool header = true;
+    char delimiter = ',';
+    std::string key_column;                      ///< Key for the server table (empty = unkeyed)
+    std::vector<std::string> column_types;       ///< Type keys; empty = infer from the first rows
+    size_t inference_rows = 1000;                ///< Rows observed before the schema is fixed
+    std::chrono::milliseconds inference_timeout{5000};///< Longest wait for inference_rows to arrive
+    size_t batch_rows = 100000;                  ///< Maximum rows per upsert
+    std::chrono::milliseconds poll_interval{500};///< Longest wait between checks for growth
+};
+
+/**
+ * @class CsvFollower
+ * @brief Appends the lines added to a CSV file to a KDB+ table.
+ *
+ * The follower remembers the byte offset of the last complete record it
+ * loaded. Each `poll` reads only the bytes appended since then, tokenizes the
+ * complete lines and upserts them, so the cost of a poll is proportional to
+ * the new data. A line without its terminating newline is held back until
+ * the writer finishes it. The file stays open between polls, so when it is
+ * rotated (moved or deleted and recreated) the lines written to the old file
+ * are read to its end before the new file is followed from the start. A file
+ * truncated in place is also followed again from the start.
+ *
+ * Without `column_types`, rows are held back until `inference_rows` have
+ * been seen or `inference_timeout` has passed since the first one, and the
+ * schema is fixed from them: later values that do not fit their column are
+ * loaded as nulls.
+ */
+class CsvFollower {
+public:
+    CsvFollower(const std::string& table_name,
+                const std::string& filename,
+                const FollowOptions& options = FollowOptions());
+    ~CsvFollower();
+
+    CsvFollower(const CsvFollower&) = delete;
+    CsvFollower& operator=(const CsvFollower&) = delete;
+
+    /**
+     * @brief Loads all complete lines appended since the last poll.
+     *
+     * @return size_t Number of rows appended to the table.
+     */
+    size_t poll();
+
+    /**
+     * @brief Fixes the schema from the rows held so far and loads them.
+     *
+     * Called when following stops, so rows still waiting for
+     * `inference_rows` are not lost.
+     *
+     * @return size_t Number of rows appended to the table.
+     */
+    size_t finish();
+
+    /**
+     * @brief Blocks until the file changes or `timeout` elapses.
+     *
+     * Uses inotify on Linux and a plain sleep elsewhere.
+     */
+    void wait_for_change(std::chrono::milliseconds timeout);
+
+    uint64_t offset() const { return offset_; }        ///< Bytes of the file loaded so far
+    size_t rows_loaded() const { return rows_loaded_; }
+    bool failed() const { return failed_; }
+
+private:
+    bool read_to_end();
+    void consume_pending();
+    void handle_row(const std::vector<std::string>& row);
+    bool resolve_schema();
+    bool flush();
+
+    std::string table_name_;
+    std::string filename_;
+    FollowOptions options_;
+
+    std::ifstream file_;           ///< File being followed, kept open across rotation
+    uint64_t offset_ = 0;          ///< End of the last complete record consumed
+    std::string pending_;          ///< Bytes read past offset_ that do not yet form a record
+    bool header_seen_ = false;
+    std::vector<std::string> headers_;
+    std::vector<std::vector<std::string>> inference_rows_;  ///< Rows held until the schema is known
+    std::chrono::steady_clock::time_point inference_started_;  ///< When the first held row arrived
+    std::unique_ptr<TableBuilder> builder_;
+    size_t batches_ = 0;
+    size_t rows_loaded_ = 0;
+    bool failed_ = false;
+    bool rotated_ = false;         ///< File was moved or deleted; switch once the old one is drained
+    int watch_fd_ = -1;            ///< inotify descriptor (Linux only)
+    int watch_wd_ = -1;            ///< inotify watch on filename_
+};
+
+/**
+ * @brief Follows a CSV file, appending new lines to a table until stopped.
+ *
+ * Loads the existing contents first, then keeps polling for growth until
+ * `stop` becomes true.
+ *
+ * @param table_name Name of the table to create and append to.
+ * @param filename Path to the CSV file being written.
+ * @param stop Set to true (e.g. from another thread) to end the follow.
+ * @param options Parsing, schema and polling options.
+ * @return bool True if stopped normally, false if a load failed.
+ */
+bool follow_csv(const std::string& table_name,
+                const std::string& filename,
+                const std::atomic<bool>& stop,
+                const FollowOptions& options = FollowOptions());
+
+#endif // FOLLOW_CSV_H
@@ -5,6 +5,7 @@
 #include "connections.h"
 #include <string>
 #include <iostream>
+#include <initializer_list>
 #include <variant>
 
 /**
@@ -89,4 +90,17 @@ private:
  */
 QueryResult inline_query(const std::string& query);
 
+/**
+ * @brief Applies a q function to K arguments on the KDB+ server.
+ *
+ * Used to ship client-built data (e.g. `inline_query("upsert", {ks((S)"t"), table})`)
+ * without rendering it into q source. Results are handled as for a query string.
+ *
+ * @param function The q function or expression to apply, e.g. `"set"` or `"{x+y}"`.
+ * @param args Between one and eight arguments. Ownership passes to the call,
+ *        which releases them whether or not it succeeds.
+ * @return QueryResult As for `inline_query(const std::string&)`.
+ */
+QueryResult inline_query(const std::string& function, std::initializer_list<K> args);
+
 #endif // INLINE_QUERY_H
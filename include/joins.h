@@ -4,59 +4,202 @@
 
 #include "k.h"
 #include "connections.h"
+#include "select_from_table.h"
+#include <chrono>
 #include <string>
+#include <tuple>
 #include <vector>
 
 namespace joins {
+    /// Namespace holding join results stored without an explicit name
+    constexpr const char* SCRATCH_NAMESPACE = ".kdbear.join";
+
+    /**
+     * @brief Handle to a joined table that stays on the server.
+     *
+     * A join stores its result under `result_name` and returns only the name,
+     * row count and column schema, collected in the same round trip as the
+     * join. Rows are fetched on demand, whole or by row range or column subset,
+     * and the name can be passed straight to another join so chained joins
+     * never leave the server. Joins given an empty `result_name` store their
+     * result under a unique name in `SCRATCH_NAMESPACE`, so concurrent joins
+     * never collide.
+     */
+    class JoinResult {
+    public:
+        JoinResult() = default;  ///< A failed join
+        JoinResult(std::string name, J rows, std::vector<ColumnMeta> columns)
+            : name_(std::move(name)), rows_(rows), columns_(std::move(columns)), valid_(true) {}
+
+        /**
+         * @brief Whether the join succeeded.
+         */
+        explicit operator bool() const { return valid_; }
+
+        const std::string& name() const { return name_; }
+        J rows() const { return rows_; }
+        const std::vector<ColumnMeta>& columns() const { return columns_; }
+
+        /**
+         * @brief Row and column counts, as returned by `shape`.
+         */
+        std::tuple<int, int> shape() const {
+            return std::make_tuple(static_cast<int>(rows_), static_cast<int>(columns_.size()));
+        }
+
+        /**
+         * @brief Fetches the whole table.
+         *
+         * @return K The table, owned by the caller, or nullptr on failure.
+         */
+        K fetch() const;
+
+        /**
+         * @brief Fetches `count` rows starting at `first` (fewer at the end of the table).
+         *
+         * @return K The rows as a table, owned by the caller, or nullptr on failure.
+         */
+        K fetch_rows(J first, J count) const;
+
+        /**
+         * @brief Fetches a subset of the columns, in the order given.
+         *
+         * @return K The columns as a table, owned by the caller, or nullptr on failure.
+         */
+        K fetch_columns(const std::vector<std::string>& columns) const;
+
+        /**
+         * @brief Deletes the table from the server, e.g. an intermediate of a chained join.
+         */
+        bool drop();
+
+    private:
+        std::string name_;
+        J rows_ = 0;
+        std::vector<ColumnMeta> columns_;
+        bool valid_ = false;
+    };
+
     // Core join functions
-    K inner_join(const std::string& table1,
-                 const std::string& table2,
-                 const std::string& result_name,
-                 const std::vector<std::string>& join_columns = std::vector<std::string>());
+    JoinResult inner_join(const std::string& table1,
+                          const std::string& table2,
+                          const std::string& result_name,
+                          const std::vector<std::string>& join_columns = std::vector<std::string>());
+
+    JoinResult left_join(const std::string& table1,
+                         const std::string& table2,
+                         const std::string& result_name,
+                         const std::vector<std::string>& join_columns = std::vector<std::string>());
 
-    K left_join(const std::string& table1,
-                const std::string& table2,
-                const std::string& result_name,
-                const std::vector<std::string>& join_columns = std::vector<std::string>());
+    JoinResult right_join(const std::string& table1,
+                          const std::string& table2,
+                          const std::string& result_name,
+                          const std::vector<std::string>& join_columns = std::vector<std::string>());
 
-    K right_join(const std::string& table1,
-                 const std::string& table2,
-                 const std::string& result_name,
-                 const std::vector<std::string>& join_columns = std::vector<std::string>());
+    /**
+     * @brief One aggregation of a window join, evaluated over the right rows in each window.
+     *
+     * `function` is any q aggregate, e.g. `count`, `sum`, `avg`, `max` or a
+     * lambda. With a `weight_column` it is applied to the weights and then
+     * the values, so `{"wavg", "price", "size", "vwap"}` gives a
+     * volume-weighted average price.
+     */
+    struct WindowAggregation {
+        std::string function;       ///< q aggregate, e.g. "sum" or "wavg"
+        std::string column;         ///< Right column aggregated
+        std::string weight_column;  ///< First argument of a weighted aggregate (empty if none)
+        std::string name;           ///< Output column (empty = `column`)
+    };
 
     // Window Join
-    K window_join(const std::string& table1,
-                  const std::string& table2,
-                  const std::string& result_name,
-                  const std::string& time_column_left,
-                  const std::string& time_column_right,
-                  double window_size_seconds,
-                  const std::vector<std::string>& join_columns);
-
-    K asof_join(const std::string& table1,
-                const std::string& table2,
-                const std::string& result_name,
-                const std::string& time_column_left,
-                const std::string& time_column_right,
-                const std::vector<std::string>& join_columns);
-
-    K union_join(const std::string& table1,
-                const std::string& table2,
-                const std::string& result_name,
-                const std::vector<std::string>& join_columns = std::vector<std::string>());
+    JoinResult window_join(const std::string& table1,
+                           const std::string& table2,
+                           const std::string& result_name,
+                           const std::string& time_column_left,
+                           const std::string& time_column_right,
+                           double window_size_seconds,
+                           const std::vector<std::string>& join_columns);
+
+    JoinResult window_join(const std::string& table1,
+                           const std::string& table2,
+                           const std::string& result_name,
+                           const std::string& time_column_left,
+                           const std::string& time_column_right,
+                           std::chrono::nanoseconds pre_window,
+                           std::chrono::nanoseconds post_window,
+                           const std::vector<std::string>& join_columns,
+                           const std::vector<WindowAggregation>& aggregations = std::vector<WindowAggregation>());
+
+    JoinResult asof_join(const std::string& table1,
+                         const std::string& table2,
+                         const std::string& result_name,
+                         const std::string& time_column_left,
+                         const std::string& time_column_right,
+                         const std::vector<std::string>& join_columns);
+
+    /**
+     * @brief How a partitioned join splits its work.
+     *
+     * The left table is split into `partitions` groups of distinct
+     * `partition_column` values; each group is joined against the right
+     * rows with the same values. With no `endpoints`, the groups are joined
+     * with `peach` on the server, using its secondary threads (`-s N`) or
+     * processes (`-s -N`), and the result never leaves the server. With
+     * `endpoints`, a pool of `connections` client connections spread over
+     * them issues the groups concurrently; every endpoint must hold both
+     * tables, and the sub-results are gathered into `result_name` on the
+     * main connection. Several connections to one endpoint only run in
+     * parallel if it was started with a negative port (multithreaded input).
+     */
+    struct PartitionOptions {
+        std::string partition_column = "sym";  ///< Must be one of the join columns
+        size_t partitions = 8;                 ///< Groups of partition values
+        std::vector<std::pair<std::string, int>> endpoints;  ///< host/port of join servers (empty = peach)
+        unsigned connections = 0;              ///< Pool size (0 = one per partition)
+    };
+
+    /**
+     * @brief As-of join run as concurrent sub-joins over groups of a partition column.
+     *
+     * Produces the same table as `asof_join`, rows in the left table's order.
+     */
+    JoinResult asof_join_partitioned(const std::string& table1,
+                                     const std::string& table2,
+                                     const std::string& result_name,
+                                     const std::string& time_column_left,
+                                     const std::string& time_column_right,
+                                     const std::vector<std::string>& join_columns,
+                                     const PartitionOptions& options = PartitionOptions());
+
+    JoinResult union_join(const std::string& table1,
+                         const std::string& table2,
+                         const std::string& result_name,
+                         const std::vector<std::string>& join_columns = std::vector<std::string>());
+
+    /**
+     * @brief Deletes every scratch result created over this connection.
+     *
+     * @return bool False if the server could not be reached.
+     */
+    bool clear_scratch();
 
     // Helper functions
     namespace detail {
-        bool prepare_tables(const std::string& table1,
-                          const std::string& table2,
-                          std::string& t1_unkeyed,
-                          std::string& t2_unkeyed);
-        void cleanup_tables(const std::string& t1_unkeyed, const std::string& t2_unkeyed);
+        std::string join_expression(const std::string& body,
+                                    const std::string& table1,
+                                    const std::string& table2);
+        std::string key_list(const std::vector<std::string>& columns);
         std::string build_join_by(const std::vector<std::string>& join_columns);
-        K execute_join(const std::string& query,
-                      const std::string& result_name,
-                      const std::string& t1_unkeyed,
-                      const std::string& t2_unkeyed);
+        std::string group_keys(const std::string& table, const std::vector<std::string>& columns);
+        std::vector<std::string> leading_key(const std::vector<std::string>& columns);
+        std::string sort_by_time(const std::string& table, const std::string& column);
+        std::string result_symbol(const std::string& result_name);
+        JoinResult execute_join(const std::string& query, const std::string& result_name);
+        std::string delete_global(const std::string& name);
+        std::string partition_asof_body(const std::string& time_column_left,
+                                        const std::string& time_column_right,
+                                        const std::vector<std::string>& join_columns,
+                                        const std::string& partition_column);
     }
 }
 
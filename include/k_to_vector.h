@@ -31,6 +31,16 @@ struct KDateTime {
     explicit KDateTime(std::chrono::system_clock::time_point tp) : value(tp) {}
 };
 
+/**
+ * @brief Wrapper struct for K timestamp values
+ *
+ * Holds nanosecond precision regardless of the platform's system_clock resolution
+ */
+struct KTimestamp {
+    std::chrono::sys_time<std::chrono::nanoseconds> value;
+    explicit KTimestamp(std::chrono::sys_time<std::chrono::nanoseconds> tp) : value(tp) {}
+};
+
 /**
  * @brief Variant type representing all possible K column value types
  *
@@ -46,6 +56,7 @@ struct KDateTime {
  * - KS -> std::string
  * - KD -> KDate
  * - KZ -> KDateTime
+ * - KP -> KTimestamp
  */
 using KValue = std::variant<
     bool,           // KB
@@ -58,7 +69,8 @@ using KValue = std::variant<
     char,           // KC
     std::string,    // KS
     KDate,          // KD
-    KDateTime       // KZ
+    KDateTime,      // KZ
+    KTimestamp      // KP
 >;
 
 // Forward declarations for implementation functions
@@ -137,6 +149,14 @@ inline void print_value(const std::optional<KValue>& opt_val) {
             auto time = std::chrono::system_clock::to_time_t(val.value);
             std::cout << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
         }
+        // Special handling for timestamp types, keeping the nanoseconds
+        else if constexpr (std::is_same_v<std::remove_cvref_t<decltype(val)>, KTimestamp>) {
+            auto secs = std::chrono::floor<std::chrono::seconds>(val.value);
+            auto time = std::chrono::system_clock::to_time_t(secs);
+            std::cout << std::put_time(std::gmtime(&time), "%Y-%m-%d %H:%M:%S") << '.'
+                      << std::setfill('0') << std::setw(9) << (val.value - secs).count()
+                      << std::setfill(' ');
+        }
         // Default handling for all other types
         else {
             std::cout << val;
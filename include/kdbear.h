@@ -2,15 +2,25 @@
 #define KDBEAR_H
 
 #include "connections.h"
+#include "follow_csv.h"
 #include "inline_query.h"
 #include "joins.h"
 #include "k_to_vector.h"
+#include "local_joins.h"
 #include "make_table.h"
 #include "print_k.h"
 #include "print_table.h"
 #include "read_csv.h"
+#include "read_csv_glob.h"
+#include "read_fixed.h"
+#include "read_jsonl.h"
+#include "schema.h"
 #include "select_from_table.h"
+#include "splayed_reader.h"
+#include "splayed_writer.h"
+#include "symbol_cache.h"
 #include "table_structure.h"
+#include "table_writer.h"
 #include "type_map.h"
 #include "k.h"
 
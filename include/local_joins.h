@@ -0,0 +1,135 @@
+#ifndef LOCAL_JOINS_H
+#define LOCAL_JOINS_H
+
+#include "k.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace joins {
+    /**
+     * @brief Options for joins run in client memory.
+     */
+    struct LocalJoinOptions {
+        unsigned threads = 0;  ///< Worker threads (0 = hardware concurrency)
+    };
+
+    /**
+     * @brief As-of join of two tables held on the client, without a server.
+     *
+     * For each row of `left`, finds the last row of `right` with the same
+     * key whose `time_column_right` is at or before the row's
+     * `time_column_left`, as `aj` does. Rows of `right` are partitioned by a
+     * hash of the key columns and ordered by time within each key; keys are
+     * then matched in parallel, merging through time-ordered left rows and
+     * falling back to a binary search when the left side steps back in time.
+     *
+     * The result has the columns of `left`, then the columns of `right`
+     * other than the key and time columns, then `<time_column_right>2`
+     * holding the matched right time, the same layout as `asof_join`.
+     * Columns present in both tables take the right value where a match was
+     * found and keep the left value otherwise; right-only columns are null
+     * for unmatched rows. Left columns are shared with `left`, not copied.
+     *
+     * @param left Unkeyed table (type 98), e.g. from `JoinResult::fetch`.
+     * @param right Unkeyed table (type 98).
+     * @param time_column_left Time column of `left`.
+     * @param time_column_right Time column of `right`, of the same type.
+     * @param join_columns Key columns present in both tables with matching types.
+     * @param options Threading options.
+     * @return K The joined table, owned by the caller, or nullptr if the
+     *         tables or columns do not fit together. The inputs are not released.
+     */
+    K local_asof_join(K left,
+                      K right,
+                      const std::string& time_column_left,
+                      const std::string& time_column_right,
+                      const std::vector<std::string>& join_columns,
+                      const LocalJoinOptions& options = LocalJoinOptions());
+
+    /**
+     * @brief Hash joins of two tables held on the client, without a server.
+     *
+     * Each left row is matched to the first right row with the same values
+     * in `join_columns`, as `ij`/`lj` against `join_columns xkey right` do.
+     * Keys may span several columns of any simple type. The right (build)
+     * side is hashed in parallel and split into one partition per thread,
+     * each indexed in its own open-addressing table; left rows are then
+     * probed in parallel. With no join columns, the first column the tables
+     * share is used, as in `inner_join`.
+     *
+     * The result has the columns of `left`, then the non-key columns of
+     * `right`, the same layout as the server-side joins. `local_inner_join`
+     * keeps only matched left rows; `local_left_join` keeps every left row,
+     * with right-only columns null where unmatched; `local_right_join` is
+     * `local_left_join` with the tables swapped, as `right_join` is.
+     *
+     * @return K The joined table, owned by the caller, or nullptr if the
+     *         tables or columns do not fit together. The inputs are not released.
+     */
+    K local_inner_join(K left,
+                       K right,
+                       const std::vector<std::string>& join_columns = std::vector<std::string>(),
+                       const LocalJoinOptions& options = LocalJoinOptions());
+
+    K local_left_join(K left,
+                      K right,
+                      const std::vector<std::string>& join_columns = std::vector<std::string>(),
+                      const LocalJoinOptions& options = LocalJoinOptions());
+
+    K local_right_join(K left,
+                       K right,
+                       const std::vector<std::string>& join_columns = std::vector<std::string>(),
+                       const LocalJoinOptions& options = LocalJoinOptions());
+
+    namespace detail {
+        /**
+         * @brief Open-addressing hash index over the key columns of a table.
+         *
+         * Stores one row per distinct key, the first one inserted, so the
+         * row doubles as the key's group id. Rows of another table are
+         * looked up with `find`, comparing their key columns element-wise;
+         * symbols are compared by content.
+         */
+        class RowIndex {
+        public:
+            RowIndex(std::vector<K> columns, size_t expected_rows);
+
+            /**
+             * @brief Inserts a row of the indexed columns.
+             *
+             * @return J The first row inserted with the same key.
+             */
+            J insert(J row);
+
+            J insert(J row, uint64_t hash);  ///< As above, with the row's `hash_row` precomputed
+
+            /**
+             * @brief Looks up a row of `probe_columns` (same types as the indexed columns).
+             *
+             * @return J The indexed row with the same key, or -1.
+             */
+            J find(const std::vector<K>& probe_columns, J row) const;
+
+            J find(const std::vector<K>& probe_columns, J row, uint64_t hash) const;
+
+        private:
+            struct Slot {
+                uint64_t hash;
+                J row;  ///< -1 when empty
+            };
+
+            std::vector<K> columns_;
+            std::vector<Slot> slots_;
+            size_t mask_;
+        };
+
+        uint64_t hash_row(const std::vector<K>& columns, J row);
+        bool rows_equal(const std::vector<K>& a, J row_a, const std::vector<K>& b, J row_b);
+        K find_column(K table, const std::string& name);
+        K take_rows(K column, const std::vector<J>& rows, K fallback = nullptr);
+        unsigned worker_count(unsigned requested, size_t work_items);
+    }
+}
+
+#endif // LOCAL_JOINS_H
@@ -1,31 +1,90 @@
 #ifndef MAKE_TABLE_H
 #define MAKE_TABLE_H
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <variant>
 #include "k.h"
 #include "connections.h"  
 
+/**
+ * @brief A kdb+ string (char vector) value, as opposed to a symbol.
+ */
+struct CharString {
+    std::string text;
+};
+
+/**
+ * @brief A kdb+ GUID value, as its 16 bytes.
+ */
+struct Guid {
+    std::array<uint8_t, 16> bytes{};
+};
+
 /**
  * @brief Defines the possible data types that can be stored in a KDB+ table.
  *
  * The `KDBType` variant can hold one of the following types:
  * - `std::monostate`: Represents a null value.
  * - `bool`: Boolean values (`true` or `false`).
- * - `int`: Integer values.
- * - `double`: Floating-point values.
- * - `std::string`: String values.
+ * - `int`, `int64_t`: Integer values (long columns).
+ * - `double`: Floating-point values (float columns).
+ * - `float`: Single-precision values (real columns).
+ * - `std::string`: Symbols.
+ * - `std::chrono::sys_time<std::chrono::nanoseconds>`: Timestamps; coarser time points convert implicitly.
+ * - `std::chrono::sys_days`: Dates.
+ * - `std::chrono::nanoseconds`: Timespans; other durations convert implicitly.
+ * - `CharString`: Strings (char vectors).
+ * - `Guid`: GUIDs.
+ */
+using KDBType = std::variant<std::monostate, bool, int, double, std::string,
+                             int64_t, float,
+                             std::chrono::sys_time<std::chrono::nanoseconds>,
+                             std::chrono::sys_days,
+                             std::chrono::nanoseconds,
+                             CharString,
+                             Guid>;
+
+/**
+ * @brief The values of one column, stored contiguously as their kdb+ type.
+ *
+ * - `bool` → boolean, `uint8_t` → byte
+ * - `int16_t` → short, `int32_t` → int, `int64_t` → long
+ * - `float` → real, `double` → float
+ * - `std::string` → symbol
+ * - `std::chrono::sys_days` → date
+ * - `std::chrono::sys_time<std::chrono::nanoseconds>` → timestamp
+ *
+ * Nulls are the kdb+ sentinels of each type, e.g. `nj` or NaN.
+ */
+using ColumnValues = std::variant<std::vector<bool>,
+                                  std::vector<uint8_t>,
+                                  std::vector<int16_t>,
+                                  std::vector<int32_t>,
+                                  std::vector<int64_t>,
+                                  std::vector<float>,
+                                  std::vector<double>,
+                                  std::vector<std::string>,
+                                  std::vector<std::chrono::sys_days>,
+                                  std::vector<std::chrono::sys_time<std::chrono::nanoseconds>>>;
+
+/**
+ * @brief A named column for the columnar `make_table` overload.
  */
-using KDBType = std::variant<std::monostate, bool, int, double, std::string>;
+struct TableColumn {
+    std::string name;
+    ColumnValues values;
+};
 
 /**
  * @brief Creates a KDB+ table with the specified name, columns, and data.
  *
- * This function constructs a q-sql command to create a table in KDB+ with the given
- * `table_name`, `column_names`, and `data`. It handles both single-row and
- * multi-row data, ensuring proper formatting and escaping of values. The command
- * is then executed using the `inline_query` function.
+ * The table is built on the client with `build_table`, so each column is a
+ * typed vector, and sent to the server in one `set` call with no q source
+ * generated or parsed.
  *
  * @param table_name The name of the table to be created in KDB+.
  * @param column_names A vector of strings representing the names of the columns.
@@ -38,4 +97,49 @@ bool make_table(const std::string& table_name,
                const std::vector<std::string>& column_names,
                const std::vector<std::vector<KDBType>>& data);
 
+/**
+ * @brief Builds a kdb+ table on the client from `make_table`-style rows.
+ *
+ * Each column becomes a typed vector: `bool` → boolean, `int`/`int64_t` →
+ * long, `float` → real, `double` → float, `std::string` → symbol, and time
+ * points, dates, durations and GUIDs → timestamp, date, timespan and guid.
+ * Columns mixing integers and floating-point values are widened to float;
+ * `std::monostate` entries become typed nulls. A `CharString` column is a
+ * list of char vectors (a q string column). Columns mixing other
+ * alternatives become general lists of atoms, with `std::monostate` as `::`.
+ * No server is involved, so the result can be sent over IPC or written to
+ * disk directly.
+ *
+ * @param column_names A vector of strings representing the names of the columns.
+ * @param data A two-dimensional vector of rows, as for `make_table`.
+ * @return K A table (type 98) owned by the caller, or `nullptr` if the rows are
+ *         ragged.
+ */
+K build_table(const std::vector<std::string>& column_names,
+              const std::vector<std::vector<KDBType>>& data);
+
+/**
+ * @brief Creates a KDB+ table from whole columns.
+ *
+ * Numeric columns are copied into their K vectors with a single `memcpy`;
+ * dates and timestamps are rebased to the kdb+ epoch and strings are
+ * interned as symbols. Each source vector is released as soon as it has been
+ * copied, so the upload never holds more than one extra column in memory.
+ * The table is sent in one `set` call.
+ *
+ * @param table_name The name of the table to be created in KDB+.
+ * @param columns Named columns of equal length, moved in.
+ * @return bool Returns `true` if the table is created successfully; otherwise, returns `false`.
+ */
+bool make_table(const std::string& table_name, std::vector<TableColumn>&& columns);
+
+/**
+ * @brief Builds a kdb+ table on the client from whole columns.
+ *
+ * @param columns Named columns of equal length, moved in and released as they are copied.
+ * @return K A table (type 98) owned by the caller, or `nullptr` if there are
+ *         no columns or their lengths differ.
+ */
+K build_table(std::vector<TableColumn>&& columns);
+
 #endif // MAKE_TABLE_H
@@ -0,0 +1,53 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a file on disk.
+ *
+ * Maps the whole file into the address space so that callers can scan it
+ * with plain pointer arithmetic instead of stream reads. The mapping is
+ * released when the object goes out of scope.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps the given file read-only.
+     *
+     * @param path Path to the file to map.
+     * @note Check `is_open()` afterwards; construction does not throw.
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Whether the file was opened (an empty file counts as open).
+     */
+    bool is_open() const { return open_; }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+
+private:
+    void release();
+
+    const char* data_ = nullptr; ///< Start of the mapping (nullptr for empty files).
+    size_t size_ = 0;            ///< Length of the mapping in bytes.
+    bool open_ = false;          ///< True once the file has been opened successfully.
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -6,6 +6,10 @@
 
 void print_head(K table, int n = 5);
 void print_tail(K table, int n = 5);
+
+class SplayedTable;
+void print_head(const SplayedTable& table, int n = 5);
+void print_tail(const SplayedTable& table, int n = 5);
 #endif
 
 
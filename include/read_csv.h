@@ -1,14 +1,132 @@
 #ifndef READ_CSV_H
 #define READ_CSV_H
 
+#include "type_map.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 
+/**
+ * @brief Selects which rows of a CSV file are used to infer column types.
+ */
+enum class SampleMode {
+    Head,       ///< Only the first `head_rows` data rows
+    Stride,     ///< Head rows plus `sample_rows` rows at even offsets across the file
+    Reservoir,  ///< Head rows plus a uniform random sample of `sample_rows` rows
+    FullScan    ///< Every row, scanned in parallel chunks
+};
+
+/**
+ * @brief Controls type-inference sampling in `read_csv`.
+ *
+ * The defaults look at the head of the file plus an evenly spread sample,
+ * which catches columns whose type changes after the first few rows without
+ * reading the whole file.
+ */
+struct SampleOptions {
+    SampleMode mode = SampleMode::Stride;
+    size_t head_rows = 5;        ///< Rows always taken from the top of the file
+    size_t sample_rows = 1000;   ///< Extra rows for Stride and Reservoir modes
+    unsigned threads = 0;        ///< Worker threads for FullScan (0 = hardware concurrency)
+    unsigned seed = 0;           ///< Reservoir seed, for reproducible sampling
+};
+
+/**
+ * @brief Output options for writing a CSV file as a date-partitioned database.
+ */
+struct HdbOptions {
+    std::string db_root;            ///< Database directory, as seen by the server process
+    std::string partition_column;   ///< Date, timestamp or datetime column that picks each row's partition
+    size_t batch_rows = 1000000;    ///< Rows held on the client between writes
+};
+
+/**
+ * @brief Where a tolerant `read_csv` load diverts rows that do not parse.
+ *
+ * A row is quarantined when its field count differs from the header or a
+ * non-empty field fails the column type's validator. Both sinks record the
+ * 1-based line number, the reason and the raw record; leave both empty to
+ * only count the bad rows.
+ */
+struct QuarantineOptions {
+    std::string file;                                   ///< Side CSV file (line,reason,record), or empty
+    std::string table;                                  ///< Side table on the server, or empty
+    size_t max_bad_rows = static_cast<size_t>(-1);      ///< Abandon the load beyond this many bad rows
+    size_t batch_rows = 100000;                         ///< Good rows sent to the server per batch
+};
+
+/**
+ * @brief Row counts of a tolerant `read_csv` load.
+ */
+struct QuarantineReport {
+    size_t rows_loaded = 0;
+    size_t rows_quarantined = 0;
+};
+
 bool read_csv(const std::string& table_name,
               const std::string& filename,
               bool header = true,
               char delimiter = ',',
               const std::string& key_column = "",
-              const std::vector<std::string>& column_types = {});
+              const std::vector<std::string>& column_types = {},
+              const SampleOptions& sampling = SampleOptions());
+
+bool read_csv(const std::string& table_name,
+              const std::string& filename,
+              const HdbOptions& hdb,
+              bool header = true,
+              char delimiter = ',',
+              const std::vector<std::string>& column_types = {},
+              const SampleOptions& sampling = SampleOptions());
+
+bool read_csv(const std::string& table_name,
+              const std::string& filename,
+              const QuarantineOptions& quarantine,
+              bool header = true,
+              char delimiter = ',',
+              const std::string& key_column = "",
+              const std::vector<std::string>& column_types = {},
+              const SampleOptions& sampling = SampleOptions(),
+              QuarantineReport* report = nullptr);
+
+/**
+ * @brief Parses a CSV file into a kdb+ table on the client, without a server.
+ *
+ * Uses the same sampling and type inference as `read_csv`; gzip and zstd
+ * input is decompressed on the fly.
+ *
+ * @return K An unkeyed table owned by the caller, or nullptr on failure.
+ */
+K read_csv_table(const std::string& filename,
+                 bool header = true,
+                 char delimiter = ',',
+                 const std::vector<std::string>& column_types = {},
+                 const SampleOptions& sampling = SampleOptions());
+
+namespace detail {
+    // CSV tokenizing, shared by the file, stream and follow loaders
+    const char* find_record_end(const char* p, const char* end);
+    void tokenize_record(const char* begin, const char* end, char delimiter,
+                         std::vector<std::string>& row);
+    bool is_blank_record(const char* begin, const char* end);
+
+    // Header and schema handling
+    bool resolve_headers(const std::vector<std::string>& row, bool header,
+                         const std::string& key_column, std::vector<std::string>& headers);
+    bool resolve_column_types(const std::vector<std::string>& column_types,
+                              size_t column_count, std::vector<I>& col_types);
+
+    // Type inference over a mapped file or an in-memory buffer
+    bool parse_csv(const std::string& filename, char delimiter, bool header,
+                   std::vector<std::string>& headers, std::vector<ColumnTypeAccumulator>& columns,
+                   const std::string& key_column, const SampleOptions& sampling);
+    bool sample_csv_buffer(const char* begin, const char* end, char delimiter, bool header,
+                           std::vector<std::string>& headers, std::vector<ColumnTypeAccumulator>& columns,
+                           const std::string& key_column, const SampleOptions& sampling);
+    std::vector<I> infer_column_types(const std::vector<ColumnTypeAccumulator>& columns);
+
+    // Keys a table loaded batch by batch on `key_column`, or on a new `idx` column when empty
+    bool apply_key(const std::string& table_name, const std::string& key_column);
+}
 
 #endif // READ_CSV_H
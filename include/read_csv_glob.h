@@ -0,0 +1,117 @@
+#ifndef READ_CSV_GLOB_H
+#define READ_CSV_GLOB_H
+
+#include "mapped_file.h"
+#include "read_csv.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options for loading several CSV files into one table.
+ */
+struct GlobOptions {
+    bool header = true;                     ///< Every file starts with the same header row
+    char delimiter = ',';
+    std::string key_column;                 ///< Key for the final table (empty = `idx`)
+    std::vector<std::string> column_types;  ///< Type keys; empty = infer once across all files
+    std::string sort_column;                ///< Sort the loaded table by this column (empty = file order)
+    unsigned threads = 0;                   ///< Parser threads (0 = hardware concurrency)
+    SampleOptions sampling;                 ///< Inference budget, shared out across the files
+};
+
+/**
+ * @brief Totals reported by a multi-file load.
+ */
+struct IngestStats {
+    size_t files = 0;
+    size_t rows = 0;
+    uint64_t bytes = 0;     ///< Uncompressed bytes parsed
+    double seconds = 0.0;   ///< Wall time from expansion to the final server call
+
+    double rows_per_second() const { return seconds > 0 ? rows / seconds : 0.0; }
+    double megabytes_per_second() const { return seconds > 0 ? bytes / seconds / (1 << 20) : 0.0; }
+};
+
+/**
+ * @brief Expands a file pattern such as `data/trades_*.csv` into sorted paths.
+ *
+ * Wildcards (`*`, `?`) are supported in the file name part only.
+ *
+ * @param pattern Path whose last component may contain wildcards.
+ * @return std::vector<std::string> Matching regular files, sorted by name.
+ */
+std::vector<std::string> expand_glob(const std::string& pattern);
+
+/**
+ * @brief Loads every CSV file matching a pattern into one KDB+ table.
+ *
+ * Column types are inferred once from a sample spread over all the files.
+ * The files are then parsed concurrently on a thread pool into typed column
+ * batches, and appended to the table in file-name order with one upsert per
+ * file. gzip and zstd files may be mixed in.
+ *
+ * @param table_name Name of the table to create.
+ * @param pattern File pattern, e.g. `logs/2024-01-02_*.csv`.
+ * @param options Parsing, schema, ordering and threading options.
+ * @param stats Receives row, byte and timing totals (optional).
+ * @return bool True if every file was loaded, false otherwise.
+ */
+bool read_csv_glob(const std::string& table_name,
+                   const std::string& pattern,
+                   const GlobOptions& options = GlobOptions(),
+                   IngestStats* stats = nullptr);
+
+namespace detail {
+    /**
+     * @brief Contents of one input file, mapped or decompressed into memory.
+     */
+    struct FileText {
+        MappedFile mapped{""};
+        std::string inflated;
+        const char* begin = nullptr;
+        const char* end = nullptr;
+    };
+
+    // Maps a plain file or decompresses a gzip/zstd one, stopping at a line end past max_bytes
+    bool load_text(const std::string& filename, FileText& text, std::string& error,
+                   size_t max_bytes = static_cast<size_t>(-1));
+
+    /**
+     * @brief One parsed piece of input (a file or a chunk), waiting to be uploaded in order.
+     */
+    struct IngestBatch {
+        K table = nullptr;      ///< nullptr if the piece had no rows
+        size_t rows = 0;
+        uint64_t bytes = 0;     ///< Input bytes the piece covered
+        size_t lines = 0;       ///< Lines in the piece, to number the next piece's lines
+        size_t error_line = 0;  ///< Line within the piece of `error` (0 = not line-specific)
+        std::string error;      ///< Set by the parser to stop the load
+        bool ready = false;
+    };
+
+    /**
+     * @brief Parses pieces on a thread pool and uploads them in order from the calling thread.
+     *
+     * `parse(i, batch)` fills the batch for piece `i` on a worker thread;
+     * workers stay at most `threads + 1` pieces ahead of the upload to bound
+     * memory. The first non-empty batch creates the table with `set`, later
+     * ones `upsert` into it. On an error the partial table is deleted.
+     *
+     * @param source File or pattern named in error messages.
+     * @param totals Receives the rows and bytes uploaded.
+     * @return bool True if every piece was parsed and uploaded.
+     */
+    bool upload_in_order(const std::string& table_name,
+                         const std::string& source,
+                         size_t pieces,
+                         unsigned threads,
+                         const std::function<void(size_t, IngestBatch&)>& parse,
+                         IngestStats& totals);
+
+    // Prints the rows, size and throughput of a finished load
+    void report_ingest(const std::string& table_name, const std::string& source, const IngestStats& totals);
+}
+
+#endif // READ_CSV_GLOB_H
@@ -0,0 +1,76 @@
+#ifndef READ_FIXED_H
+#define READ_FIXED_H
+
+#include "read_csv_glob.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Position and type of one field inside a fixed-layout record.
+ */
+struct FixedField {
+    std::string name;    ///< Column name
+    size_t offset = 0;   ///< Byte offset of the field within the record
+    size_t width = 0;    ///< Field length in bytes
+    std::string type;    ///< Type key from the type map, e.g. "j", "f", "s", "d"
+};
+
+/**
+ * @brief Layout and loading options shared by the fixed-width and binary loaders.
+ */
+struct FixedRecordOptions {
+    size_t record_length = 0;    ///< Bytes per record including any terminator; 0 = one record per line (text only)
+    size_t skip_bytes = 0;       ///< File header to skip before the first record
+    std::string key_column;      ///< Key for the final table (empty = `idx`)
+    unsigned threads = 0;        ///< Conversion threads (0 = hardware concurrency)
+    size_t batch_rows = 1000000; ///< Records converted and sent per batch
+};
+
+/**
+ * @brief Loads a fixed-width text file into a KDB+ table.
+ *
+ * Each field is cut from its byte range, trimmed of spaces and parsed with
+ * the type map's value assigner, so every type `read_csv` accepts is
+ * supported; blank or unparsable fields become nulls. There is no
+ * tokenizing: records are either `record_length` bytes apart or, with
+ * `record_length` 0, one per line, and fields beyond the end of a short line
+ * are null. Batches are converted on several threads.
+ *
+ * @param table_name Name of the table to create.
+ * @param filename Path to the file (mapped, not read).
+ * @param fields Column layout.
+ * @param options Record length, header size, key and threading options.
+ * @param stats Receives row, byte and timing totals (optional).
+ * @return bool True if the file was loaded, false otherwise.
+ */
+bool read_fixed_width(const std::string& table_name,
+                      const std::string& filename,
+                      const std::vector<FixedField>& fields,
+                      const FixedRecordOptions& options = FixedRecordOptions(),
+                      IngestStats* stats = nullptr);
+
+/**
+ * @brief Loads a file of packed little-endian binary records into a KDB+ table.
+ *
+ * Numeric and temporal fields must hold the kdb+ representation of their
+ * type (e.g. `d` as int32 days since 2000.01.01, `p` as int64 nanoseconds
+ * since 2000.01.01), so `width` must equal the type's element size; they are
+ * copied straight from the mapped file into the column vectors. `s` fields
+ * are fixed-size character arrays, trimmed of trailing NULs and spaces.
+ * `record_length` is required.
+ *
+ * @param table_name Name of the table to create.
+ * @param filename Path to the file (mapped, not read).
+ * @param fields Column layout.
+ * @param options Record length, header size, key and threading options.
+ * @param stats Receives row, byte and timing totals (optional).
+ * @return bool True if the file was loaded, false otherwise.
+ */
+bool read_binary_records(const std::string& table_name,
+                         const std::string& filename,
+                         const std::vector<FixedField>& fields,
+                         const FixedRecordOptions& options = FixedRecordOptions(),
+                         IngestStats* stats = nullptr);
+
+#endif // READ_FIXED_H
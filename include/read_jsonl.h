@@ -0,0 +1,49 @@
+#ifndef READ_JSONL_H
+#define READ_JSONL_H
+
+#include "read_csv.h"
+#include "read_csv_glob.h"
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options for loading a JSON Lines (NDJSON) file.
+ */
+struct JsonlOptions {
+    std::string key_column;                          ///< Key for the final table (empty = `idx`)
+    std::map<std::string, std::string> column_types; ///< Type keys by field name; other fields are inferred
+    SampleOptions sampling;                          ///< Lines used to discover fields and infer types
+    unsigned threads = 0;                            ///< Parser threads (0 = hardware concurrency)
+    size_t chunk_bytes = 64 << 20;                   ///< Input per parse task and per upload
+};
+
+/**
+ * @brief Loads a JSON Lines file, one flat object per line, into a KDB+ table.
+ *
+ * Columns are the fields seen in the sampled lines, in first-seen order, and
+ * their types are inferred exactly as for CSV columns: strings, numbers and
+ * booleans are validated as text, `null` and missing fields become nulls, and
+ * nested objects or arrays are kept as their JSON text. The file is split into
+ * chunks at line boundaries that are parsed concurrently into typed batches
+ * and uploaded in file order. gzip and zstd input is decompressed first.
+ *
+ * @param table_name Name of the table to create.
+ * @param filename Path to the `.jsonl` file.
+ * @param options Schema, sampling and threading options.
+ * @param stats Receives row, byte and timing totals (optional).
+ * @return bool True if every line was loaded, false on I/O or syntax errors.
+ */
+bool read_jsonl(const std::string& table_name,
+                const std::string& filename,
+                const JsonlOptions& options = JsonlOptions(),
+                IngestStats* stats = nullptr);
+
+namespace detail {
+    // Splits one JSON object into field names and values as CSV-style text
+    bool parse_json_record(const char* begin, const char* end,
+                           std::vector<std::pair<std::string, std::string>>& fields,
+                           std::string& error);
+}
+
+#endif // READ_JSONL_H
@@ -0,0 +1,336 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include "k.h"
+#include "symbol_cache.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Compile-time mapping between C++ structs and kdb+ tables.
+ *
+ * A struct is described once with `KDBEAR_SCHEMA`:
+ *
+ *     struct Trade { std::chrono::sys_time<std::chrono::nanoseconds> ts; double price; int64_t size; std::string sym; };
+ *     KDBEAR_SCHEMA(Trade, ts, price, size, sym)
+ *
+ * which gives `schema::column_names<Trade>()`, `schema::column_types<Trade>()`,
+ * `schema::to_table` / `schema::from_table` and the struct-of-arrays
+ * `schema::ColumnBuffer<Trade>`. Column types come from `ColumnTraits` at
+ * compile time, so there are no type-map lookups, and each converter is one
+ * loop per column over member pointers the compiler resolves to fixed
+ * offsets. The macro must appear in the struct's namespace (it defines a
+ * function found by argument-dependent lookup).
+ */
+namespace schema {
+
+constexpr I KDB_EPOCH_DAYS = 10957;                    ///< Days from 1970.01.01 to 2000.01.01
+constexpr J KDB_EPOCH_NANOS = 946684800000000000LL;    ///< Nanoseconds from 1970.01.01 to 2000.01.01
+
+/**
+ * @brief kdb+ type of a member type, and conversions to and from its vector element.
+ *
+ * `Stored` is the element type of the K vector; `store`/`load` convert one
+ * value. Specialize it to map further member types.
+ */
+template <typename T>
+struct ColumnTraits;
+
+/**
+ * @brief Traits for members stored in K vectors with the same bytes.
+ */
+template <typename T, I Type>
+struct PlainTraits {
+    static constexpr I type = Type;
+    using Stored = T;
+    static Stored store(const T& value) { return value; }
+    static T load(Stored value) { return value; }
+};
+
+template <> struct ColumnTraits<bool> {
+    static constexpr I type = KB;
+    using Stored = G;
+    static Stored store(bool value) { return value; }
+    static bool load(Stored value) { return value != 0; }
+};
+template <> struct ColumnTraits<uint8_t> : PlainTraits<uint8_t, KG> {};
+template <> struct ColumnTraits<char> : PlainTraits<char, KC> {};
+template <> struct ColumnTraits<int16_t> : PlainTraits<int16_t, KH> {};
+template <> struct ColumnTraits<int32_t> : PlainTraits<int32_t, KI> {};
+template <> struct ColumnTraits<int64_t> : PlainTraits<int64_t, KJ> {};
+template <> struct ColumnTraits<float> : PlainTraits<float, KE> {};
+template <> struct ColumnTraits<double> : PlainTraits<double, KF> {};
+
+template <> struct ColumnTraits<std::string> {
+    static constexpr I type = KS;
+    using Stored = S;
+    static Stored store(const std::string& value) { return intern_symbol(value); }
+    static std::string load(Stored value) { return value ? value : ""; }
+};
+
+template <> struct ColumnTraits<std::chrono::sys_days> {
+    static constexpr I type = KD;
+    using Stored = I;
+    static Stored store(std::chrono::sys_days value) {
+        return static_cast<I>(value.time_since_epoch().count() - KDB_EPOCH_DAYS);
+    }
+    static std::chrono::sys_days load(Stored value) {
+        return std::chrono::sys_days(std::chrono::days(value + KDB_EPOCH_DAYS));
+    }
+};
+
+template <> struct ColumnTraits<std::chrono::sys_time<std::chrono::nanoseconds>> {
+    static constexpr I type = KP;
+    using Stored = J;
+    static Stored store(std::chrono::sys_time<std::chrono::nanoseconds> value) {
+        return value.time_since_epoch().count() - KDB_EPOCH_NANOS;
+    }
+    static std::chrono::sys_time<std::chrono::nanoseconds> load(Stored value) {
+        return std::chrono::sys_time<std::chrono::nanoseconds>(std::chrono::nanoseconds(value + KDB_EPOCH_NANOS));
+    }
+};
+
+/**
+ * @brief One described member: its column name and member pointer.
+ */
+template <typename Class, typename Member>
+struct Field {
+    const char* name;
+    Member Class::*member;
+    using Traits = ColumnTraits<Member>;
+};
+
+template <typename Class, typename Member>
+constexpr Field<Class, Member> field(const char* name, Member Class::*member) {
+    return {name, member};
+}
+
+/**
+ * @brief Whether `T` has been described with `KDBEAR_SCHEMA`.
+ */
+template <typename T>
+concept Described = requires { kdbear_schema_fields(static_cast<const T*>(nullptr)); };
+
+/**
+ * @brief The described fields of `T`, as a tuple of `Field`s.
+ */
+template <Described T>
+constexpr auto fields() {
+    return kdbear_schema_fields(static_cast<const T*>(nullptr));
+}
+
+template <Described T>
+constexpr size_t column_count = std::tuple_size_v<decltype(fields<T>())>;
+
+/**
+ * @brief Column names of `T`, in declaration order.
+ */
+template <Described T>
+constexpr std::array<const char*, column_count<T>> column_names() {
+    return std::apply([](auto... f) { return std::array<const char*, column_count<T>>{f.name...}; }, fields<T>());
+}
+
+/**
+ * @brief kdb+ vector type of each column of `T`.
+ */
+template <Described T>
+constexpr std::array<I, column_count<T>> column_types() {
+    return std::apply([](auto... f) { return std::array<I, column_count<T>>{decltype(f)::Traits::type...}; },
+                      fields<T>());
+}
+
+namespace detail {
+
+template <typename T, typename F>
+constexpr void for_each_field(F&& f) {
+    constexpr auto described = fields<T>();
+    [&]<size_t... Index>(std::index_sequence<Index...>) {
+        (f(std::integral_constant<size_t, Index>(), std::get<Index>(described)), ...);
+    }(std::make_index_sequence<column_count<T>>());
+}
+
+template <typename T>
+K names_vector() {
+    constexpr auto names = column_names<T>();
+    K vector = ktn(KS, static_cast<J>(names.size()));
+    for (size_t col = 0; col < names.size(); ++col) kS(vector)[col] = ss(const_cast<S>(names[col]));
+    return vector;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Builds a kdb+ table from an array of structs.
+ *
+ * @param rows Structs to convert, one row each.
+ * @return K A table (type 98) owned by the caller.
+ */
+template <Described T>
+K to_table(std::span<const T> rows) {
+    J count = static_cast<J>(rows.size());
+    K values = ktn(0, static_cast<J>(column_count<T>));
+    detail::for_each_field<T>([&](auto index, auto f) {
+        using Traits = typename decltype(f)::Traits;
+        constexpr auto member = std::get<decltype(index)::value>(fields<T>()).member;
+        K column = ktn(Traits::type, count);
+        auto* out = reinterpret_cast<typename Traits::Stored*>(kG(column));
+        for (J row = 0; row < count; ++row) out[row] = Traits::store(rows[row].*member);
+        kK(values)[index] = column;
+    });
+    return xT(xD(detail::names_vector<T>(), values));
+}
+
+/**
+ * @brief Reads a kdb+ table into an array of structs.
+ *
+ * Columns are found by name, so the table may have extra columns or a
+ * different order, but each described column must be present with exactly
+ * its kdb+ type. Keyed tables are read through their value columns and key
+ * columns alike.
+ *
+ * @param table Table (type 98) or keyed table (type 99); not released.
+ * @param rows Receives one struct per row, replacing its contents.
+ * @return bool False if a column is missing or has another type.
+ */
+template <Described T>
+bool from_table(K table, std::vector<T>& rows) {
+    // Keyed tables: look up each column in the key table, then the value table
+    K parts[2] = {nullptr, nullptr};
+    if (table && table->t == XT) {
+        parts[0] = table->k;
+    } else if (table && table->t == XD && kK(table)[0]->t == XT && kK(table)[1]->t == XT) {
+        parts[0] = kK(table)[0]->k;
+        parts[1] = kK(table)[1]->k;
+    } else {
+        std::cerr << "Error: Expected a table" << std::endl;
+        return false;
+    }
+
+    std::array<K, column_count<T>> columns{};
+    constexpr auto names = column_names<T>();
+    constexpr auto types = column_types<T>();
+    for (size_t col = 0; col < names.size(); ++col) {
+        for (K dict : parts) {
+            if (!dict || columns[col]) continue;
+            K keys = kK(dict)[0];
+            for (J i = 0; i < keys->n; ++i) {
+                if (std::strcmp(kS(keys)[i], names[col]) == 0) columns[col] = kK(kK(dict)[1])[i];
+            }
+        }
+        if (!columns[col]) {
+            std::cerr << "Error: Table has no column '" << names[col] << "'" << std::endl;
+            return false;
+        }
+        if (columns[col]->t != types[col]) {
+            std::cerr << "Error: Column '" << names[col] << "' has type " << static_cast<int>(columns[col]->t)
+                      << ", expected " << types[col] << std::endl;
+            return false;
+        }
+    }
+
+    size_t count = static_cast<size_t>(columns[0]->n);
+    rows.resize(count);
+    detail::for_each_field<T>([&](auto index, auto f) {
+        using Traits = typename decltype(f)::Traits;
+        constexpr auto member = std::get<decltype(index)::value>(fields<T>()).member;
+        const auto* in = reinterpret_cast<const typename Traits::Stored*>(kG(columns[index]));
+        for (size_t row = 0; row < count; ++row) rows[row].*member = Traits::load(in[row]);
+    });
+    return true;
+}
+
+/**
+ * @brief Struct-of-arrays buffer that collects structs column by column.
+ *
+ * Each column is a contiguous vector of its kdb+ element type, so appending
+ * touches one cache line per column and `take_table` is one `memcpy` per
+ * column.
+ */
+template <Described T>
+class ColumnBuffer {
+public:
+    void push_back(const T& row) {
+        detail::for_each_field<T>([&](auto index, auto f) {
+            using Traits = typename decltype(f)::Traits;
+            constexpr auto member = std::get<decltype(index)::value>(fields<T>()).member;
+            std::get<decltype(index)::value>(columns_).push_back(Traits::store(row.*member));
+        });
+    }
+
+    void reserve(size_t rows) {
+        std::apply([&](auto&... column) { (column.reserve(rows), ...); }, columns_);
+    }
+
+    size_t size() const { return std::get<0>(columns_).size(); }
+    bool empty() const { return size() == 0; }
+    void clear() {
+        std::apply([](auto&... column) { (column.clear(), ...); }, columns_);
+    }
+
+    /**
+     * @brief Copies the buffered rows into a kdb+ table and empties the buffer.
+     *
+     * @return K A table (type 98) owned by the caller.
+     */
+    K take_table() {
+        K values = ktn(0, static_cast<J>(column_count<T>));
+        detail::for_each_field<T>([&](auto index, auto f) {
+            using Traits = typename decltype(f)::Traits;
+            const auto& source = std::get<decltype(index)::value>(columns_);
+            K column = ktn(Traits::type, static_cast<J>(source.size()));
+            if (!source.empty()) std::memcpy(kG(column), source.data(), source.size() * sizeof(typename Traits::Stored));
+            kK(values)[index] = column;
+        });
+        clear();
+        return xT(xD(detail::names_vector<T>(), values));
+    }
+
+private:
+    template <typename Tuple>
+    struct Storage;
+    template <typename... Fields>
+    struct Storage<std::tuple<Fields...>> {
+        using type = std::tuple<std::vector<typename Fields::Traits::Stored>...>;
+    };
+
+    typename Storage<decltype(fields<T>())>::type columns_;
+};
+
+}  // namespace schema
+
+// Applies macro(Type, member) to each member name (C++20 __VA_OPT__ recursion, up to 256 members)
+#define KDBEAR_PP_PARENS ()
+#define KDBEAR_PP_EXPAND(...) KDBEAR_PP_EXPAND4(KDBEAR_PP_EXPAND4(KDBEAR_PP_EXPAND4(KDBEAR_PP_EXPAND4(__VA_ARGS__))))
+#define KDBEAR_PP_EXPAND4(...) KDBEAR_PP_EXPAND3(KDBEAR_PP_EXPAND3(KDBEAR_PP_EXPAND3(KDBEAR_PP_EXPAND3(__VA_ARGS__))))
+#define KDBEAR_PP_EXPAND3(...) KDBEAR_PP_EXPAND2(KDBEAR_PP_EXPAND2(KDBEAR_PP_EXPAND2(KDBEAR_PP_EXPAND2(__VA_ARGS__))))
+#define KDBEAR_PP_EXPAND2(...) KDBEAR_PP_EXPAND1(KDBEAR_PP_EXPAND1(KDBEAR_PP_EXPAND1(KDBEAR_PP_EXPAND1(__VA_ARGS__))))
+#define KDBEAR_PP_EXPAND1(...) __VA_ARGS__
+#define KDBEAR_PP_FOR_EACH(macro, type, ...) \
+    __VA_OPT__(KDBEAR_PP_EXPAND(KDBEAR_PP_FOR_EACH_HELPER(macro, type, __VA_ARGS__)))
+#define KDBEAR_PP_FOR_EACH_HELPER(macro, type, first, ...) \
+    macro(type, first) __VA_OPT__(KDBEAR_PP_FOR_EACH_AGAIN KDBEAR_PP_PARENS (macro, type, __VA_ARGS__))
+#define KDBEAR_PP_FOR_EACH_AGAIN() KDBEAR_PP_FOR_EACH_HELPER
+
+#define KDBEAR_SCHEMA_FIELD(Type, member) ::schema::field(#member, &Type::member),
+
+/**
+ * @brief Describes the kdb+ columns of a struct: `KDBEAR_SCHEMA(Trade, ts, price, size, sym)`.
+ *
+ * Column names are the member names; column types follow the member types
+ * through `schema::ColumnTraits`. Place it in the struct's namespace.
+ */
+#define KDBEAR_SCHEMA(Type, ...)                                                   \
+    [[maybe_unused]] constexpr auto kdbear_schema_fields(const Type*) {            \
+        return std::tuple{KDBEAR_PP_FOR_EACH(KDBEAR_SCHEMA_FIELD, Type, __VA_ARGS__)}; \
+    }
+
+#endif // SCHEMA_H
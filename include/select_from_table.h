@@ -40,7 +40,8 @@ public:
         Minute,     // -KU, KU
         Second,     // -KV, KV
         DateTime,   // -KZ, KZ
-        TimeSpan    // -KN, KN
+        TimeSpan,   // -KN, KN
+        Timestamp   // -KP, KP
     };
 
     /**
@@ -109,6 +110,13 @@ public:
         return val;
     }
 
+    static KDBValue create_timestamp(long long nanoseconds) {
+        KDBValue val;
+        val.type_ = Type::Timestamp;
+        val.long_val_ = nanoseconds;
+        return val;
+    }
+
     // Type checking methods
     bool is_null() const { return type_ == Type::Null; }
     bool is_boolean() const { return type_ == Type::Boolean; }
@@ -127,6 +135,7 @@ public:
     bool is_second() const { return type_ == Type::Second; }
     bool is_datetime() const { return type_ == Type::DateTime; }
     bool is_timespan() const { return type_ == Type::TimeSpan; }
+    bool is_timestamp() const { return type_ == Type::Timestamp; }
 
     // Value getters with type checking
     bool get_boolean() const {
@@ -210,6 +219,11 @@ public:
         return long_val_;
     }
 
+    long long get_timestamp() const {
+        if (!is_timestamp()) throw std::runtime_error("Not a timestamp value");
+        return long_val_;
+    }
+
     // Generic converter to string for display
     std::string to_string() const {
         if (is_null()) return "null";
@@ -239,6 +253,7 @@ public:
             case Type::Second: return format_second(int_val_);
             case Type::DateTime: return format_datetime(float_val_);
             case Type::TimeSpan: return format_timespan(long_val_);
+            case Type::Timestamp: return format_timestamp(long_val_);
             default: return "unknown";
         }
     }
@@ -340,6 +355,21 @@ private:
             << std::setfill('0') << std::setw(9) << nanoseconds;
         return oss.str();
     }
+
+    static std::string format_timestamp(long long nanoseconds) {
+        long long seconds = nanoseconds / 1000000000LL;
+        long long nanos = nanoseconds % 1000000000LL;
+        if (nanos < 0) {
+            nanos += 1000000000LL;
+            seconds -= 1;
+        }
+        std::time_t time = static_cast<std::time_t>(seconds) + 946684800LL;  // Adjust for KDB+ epoch (2000.01.01)
+        std::tm* tm = std::gmtime(&time);
+        std::ostringstream oss;
+        oss << std::put_time(tm, "%Y-%m-%d %H:%M:%S") << '.'
+            << std::setfill('0') << std::setw(9) << nanos;
+        return oss.str();
+    }
 };
 
 using KDBRow = std::vector<KDBValue>;
@@ -475,4 +505,38 @@ std::vector<ColumnMeta> get_metadata(const std::string& table_name, bool interna
 KDBResult iloc(const std::string& table_name, const std::vector<int>& rows, const std::vector<int>& cols);
 KDBResult loc(const std::string& table_name, const std::string& condition);
 
+/**
+ * @enum Attribute
+ * @brief kdb+ column attributes, as listed in the `a` column of `meta`.
+ */
+enum class Attribute {
+    None,     ///< No attribute
+    Sorted,   ///< `s#`: ascending; enables binary search
+    Unique,   ///< `u#`: distinct values; hashed lookups
+    Parted,   ///< `p#`: equal values contiguous; per-value ranges
+    Grouped   ///< `g#`: hash index from each value to its rows
+};
+
+/**
+ * @brief Reads the attribute of every column of a table via `meta`.
+ *
+ * @param table_name Name of the table in KDB+.
+ * @return std::vector<std::pair<std::string, Attribute>> Column names and
+ *         attributes, in column order; empty if the table cannot be read.
+ */
+std::vector<std::pair<std::string, Attribute>> get_attributes(const std::string& table_name);
+
+/**
+ * @brief Applies (or with `Attribute::None`, removes) an attribute on a column of a global table.
+ *
+ * `Sorted` and `Parted` only succeed if the data already has that shape;
+ * `Unique` needs distinct values.
+ *
+ * @param table_name Name of the table in KDB+.
+ * @param column Column to change.
+ * @param attribute Attribute to set.
+ * @return bool True if the server applied it, false otherwise.
+ */
+bool set_attribute(const std::string& table_name, const std::string& column, Attribute attribute);
+
 #endif
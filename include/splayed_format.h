@@ -0,0 +1,38 @@
+#ifndef SPLAYED_FORMAT_H
+#define SPLAYED_FORMAT_H
+
+#include <cstdint>
+
+/**
+ * @brief On-disk layout of kdb+ vector files, shared by the splayed writer and reader.
+ *
+ * An uncompressed column file is a 16-byte header that mirrors the in-memory
+ * K object header, followed by the raw elements, so kdb+ can map it straight
+ * into memory. Symbol vectors (the `.d` column list and the `sym` file)
+ * store null-terminated strings after the header. Symbol columns of splayed
+ * tables hold 64-bit indices into the database's `sym` file, as an
+ * enumeration vector of type 20.
+ */
+namespace splayed {
+
+struct VectorHeader {
+    uint8_t magic;       ///< MAGIC
+    uint8_t version;     ///< VERSION
+    int8_t type;         ///< kdb+ vector type, or SYM_ENUM
+    uint8_t attribute;   ///< 0 none, 1 s#, 2 u#, 3 p#, 4 g#
+    int32_t refcount;    ///< Always 0 on disk
+    int64_t count;       ///< Number of elements
+};
+static_assert(sizeof(VectorHeader) == 16, "vector header must match the K object header");
+
+constexpr uint8_t MAGIC = 0xfe;
+constexpr uint8_t VERSION = 0x20;
+constexpr int8_t SYM_ENUM = 20;      ///< Enumeration against the `sym` domain
+using EnumIndex = int64_t;           ///< Element type of SYM_ENUM vectors
+
+constexpr const char* COLUMNS_FILE = ".d";
+constexpr const char* SYM_FILE = "sym";
+
+}  // namespace splayed
+
+#endif // SPLAYED_FORMAT_H
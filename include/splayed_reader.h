@@ -0,0 +1,143 @@
+#ifndef SPLAYED_READER_H
+#define SPLAYED_READER_H
+
+#include "k.h"
+#include "mapped_file.h"
+#include "splayed_format.h"
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace detail {
+
+class SymDomain;  ///< Lazily mapped `sym` file, shared by the columns enumerated against it
+
+}  // namespace detail
+
+/**
+ * @class SymbolColumn
+ * @brief View of an enumerated symbol column, resolving indices on access.
+ *
+ * Holds no copies: indices point into the mapped column file and the returned
+ * strings into the mapped `sym` file, so both stay valid while the owning
+ * SplayedTable is alive.
+ */
+class SymbolColumn {
+public:
+    SymbolColumn() = default;
+    SymbolColumn(std::span<const splayed::EnumIndex> indices, std::shared_ptr<detail::SymDomain> domain);
+
+    size_t size() const { return indices_.size(); }
+    bool empty() const { return indices_.empty(); }
+
+    /**
+     * @brief Raw enumeration indices into the `sym` file.
+     */
+    std::span<const splayed::EnumIndex> indices() const { return indices_; }
+
+    /**
+     * @brief Resolves one row to its symbol; an index outside the domain yields "".
+     */
+    std::string_view operator[](size_t row) const;
+
+private:
+    std::span<const splayed::EnumIndex> indices_;
+    std::shared_ptr<detail::SymDomain> domain_;
+};
+
+/**
+ * @class SplayedTable
+ * @brief Read-only, memory-mapped access to a splayed table on disk.
+ *
+ * Opens `table_dir/.d` and maps every listed column file, validating each
+ * header and length, without a kdb+ process. Columns are exposed in place as
+ * typed spans; nothing is copied until `slice` (or `print_head`/`print_tail`)
+ * builds a K table for a range of rows. The `sym` file is only read when a
+ * symbol column is first resolved. By default it is looked up next to the
+ * table and then one directory higher, which covers both `db/table/` and
+ * `db/partition/table/` layouts.
+ */
+class SplayedTable {
+public:
+    /**
+     * @param table_dir Directory of the splayed table (containing `.d`).
+     * @param sym_file Enumeration domain to use instead of searching for `sym`.
+     * @note Check `is_open()` afterwards; construction does not throw.
+     */
+    explicit SplayedTable(const std::string& table_dir, const std::string& sym_file = "");
+
+    bool is_open() const { return open_; }
+    size_t rows() const { return rows_; }
+    const std::vector<std::string>& column_names() const { return names_; }
+
+    /**
+     * @brief kdb+ type of a column (KS for enumerated symbols), or 0 if it does not exist.
+     */
+    int column_type(const std::string& name) const;
+
+    /**
+     * @brief Typed view of a simple column's elements.
+     *
+     * `T` must match the column's storage: `bool` for booleans, `uint8_t` for
+     * bytes, `char` for chars, `float`/`double` for reals, floats and datetimes,
+     * and the integer type of the same width for every other type (`int32_t`
+     * for dates, `int64_t` for timestamps, ...).
+     *
+     * @return std::span<const T> The elements, or an empty span (with an error
+     *         printed) if the column is missing or `T` does not match.
+     */
+    template <typename T>
+    std::span<const T> column(const std::string& name) const {
+        const void* data = typed_data(name, sizeof(T), storage_kind<T>());
+        return data ? std::span<const T>(static_cast<const T*>(data), rows_) : std::span<const T>();
+    }
+
+    /**
+     * @brief View of an enumerated symbol column; empty if `name` is not one.
+     */
+    SymbolColumn symbols(const std::string& name) const;
+
+    /**
+     * @brief Copies rows `[first, first + count)` into a K table (symbols de-enumerated).
+     *
+     * @return K Table owned by the caller, or `nullptr` if the table is not open.
+     */
+    K slice(size_t first, size_t count) const;
+
+private:
+    enum class StorageKind { Boolean, Char, Integer, Floating };
+
+    template <typename T>
+    static constexpr StorageKind storage_kind() {
+        static_assert(std::is_arithmetic_v<T>, "column views need an arithmetic element type");
+        if constexpr (std::is_same_v<T, bool>) return StorageKind::Boolean;
+        else if constexpr (std::is_same_v<T, char>) return StorageKind::Char;
+        else if constexpr (std::is_floating_point_v<T>) return StorageKind::Floating;
+        else return StorageKind::Integer;
+    }
+
+    struct Column {
+        explicit Column(const std::string& path) : file(path) {}
+
+        MappedFile file;
+        int8_t type = 0;
+        uint8_t attribute = 0;
+        const char* data = nullptr;  ///< First element, just past the header
+    };
+
+    bool validate_column(const std::string& path, Column& column);
+    const Column* find(const std::string& name) const;
+    const void* typed_data(const std::string& name, size_t element_bytes, StorageKind kind) const;
+
+    std::vector<std::string> names_;
+    std::vector<Column> columns_;
+    std::shared_ptr<detail::SymDomain> domain_;
+    size_t rows_ = 0;
+    bool open_ = false;
+};
+
+#endif // SPLAYED_READER_H
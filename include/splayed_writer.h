@@ -0,0 +1,75 @@
+#ifndef SPLAYED_WRITER_H
+#define SPLAYED_WRITER_H
+
+#include "k.h"
+#include "make_table.h"
+#include "splayed_format.h"
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class SplayedWriter
+ * @brief Writes kdb+ splayed and partitioned tables to disk without a server.
+ *
+ * Each column of a table is written as a kdb+ vector file in
+ * `db_root/[partition/]table/`, followed by the `.d` column list. Symbol
+ * columns are enumerated against the database's `sym` file, which is loaded
+ * on first use and saved after every table so the database stays loadable
+ * with `\l db_root`. Only one writer may update a database at a time.
+ */
+class SplayedWriter {
+public:
+    /**
+     * @param db_root Database directory; created if it does not exist.
+     */
+    explicit SplayedWriter(const std::string& db_root);
+
+    /**
+     * @brief Writes a table as a splayed table, replacing any existing one.
+     *
+     * @param table_name Name of the table directory.
+     * @param table Unkeyed table of simple columns; ownership stays with the caller.
+     * @param partition Partition directory such as `2024.12.02`, or empty for a
+     *        splayed table directly under the root.
+     * @return bool True if every file was written, false otherwise.
+     */
+    bool write_table(const std::string& table_name, K table, const std::string& partition = "");
+
+    /**
+     * @brief Writes `make_table`-style rows as a splayed table.
+     */
+    bool write_table(const std::string& table_name,
+                     const std::vector<std::string>& column_names,
+                     const std::vector<std::vector<KDBType>>& data,
+                     const std::string& partition = "");
+
+    /**
+     * @brief Parses a CSV file with `read_csv`'s inference and writes it as a splayed table.
+     */
+    bool write_csv(const std::string& table_name,
+                   const std::string& filename,
+                   const std::string& partition = "",
+                   bool header = true,
+                   char delimiter = ',',
+                   const std::vector<std::string>& column_types = {});
+
+    /**
+     * @brief Number of distinct symbols in the database's sym file.
+     */
+    size_t symbol_count() const { return syms_.size(); }
+
+private:
+    bool load_sym();
+    bool save_sym();
+    std::vector<splayed::EnumIndex> enumerate(K symbols);
+
+    std::filesystem::path root_;
+    std::vector<std::string> syms_;                   ///< Contents of the sym file, in index order
+    std::unordered_map<std::string, J> sym_index_;    ///< Symbol text to index in syms_
+    size_t saved_syms_ = 0;                           ///< Entries of syms_ already on disk
+    bool sym_loaded_ = false;
+};
+
+#endif // SPLAYED_WRITER_H
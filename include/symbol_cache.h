@@ -0,0 +1,79 @@
+#ifndef SYMBOL_CACHE_H
+#define SYMBOL_CACHE_H
+
+#include "k.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class SymbolCache
+ * @brief Maps strings to their interned kdb+ symbols without calling `ss()` again.
+ *
+ * `ss()` hashes and looks up its argument in the process-wide symbol pool on
+ * every call. Symbol columns usually repeat a few thousand distinct values
+ * over millions of rows, so the cache keeps each `S` it has seen in a small
+ * open-addressing table keyed by a fast word-at-a-time hash and only falls
+ * through to `sn()` for new strings. Keys point at the interned strings
+ * themselves, which live for the whole session, so nothing is copied.
+ *
+ * When `max_entries` distinct strings have been seen the table is emptied
+ * and refilled, bounding memory for high-cardinality columns. A cache is not
+ * thread-safe; `intern_symbol` uses one per thread.
+ */
+class SymbolCache {
+public:
+    explicit SymbolCache(size_t max_entries = 1 << 16);
+
+    /**
+     * @brief Interned symbol for `text`.
+     */
+    S intern(std::string_view text);
+
+    /**
+     * @brief Interns a whole column, reusing the previous result for runs of equal values.
+     *
+     * @param values Strings to intern.
+     * @param out Receives one symbol per value (e.g. `kS(vector)`).
+     */
+    void intern_all(std::span<const std::string> values, S* out);
+
+    void clear();
+    size_t size() const { return size_; }
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+
+private:
+    struct Slot {
+        uint64_t hash;
+        S symbol;          ///< nullptr for an empty slot
+        size_t length;
+    };
+
+    S insert(std::string_view text, uint64_t hash, size_t slot);
+    void rehash(size_t capacity);
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    size_t max_entries_;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+/**
+ * @brief Interns `text` through the calling thread's `SymbolCache`.
+ *
+ * Safe to call from loader worker threads (after `setm(1)`), since each
+ * thread has its own cache.
+ */
+S intern_symbol(std::string_view text);
+
+/**
+ * @brief Interns a column of strings through the calling thread's `SymbolCache`.
+ */
+void intern_symbols(std::span<const std::string> values, S* out);
+
+#endif // SYMBOL_CACHE_H
@@ -0,0 +1,95 @@
+#ifndef TABLE_BUILDER_H
+#define TABLE_BUILDER_H
+
+#include "k.h"
+#include "type_map.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class TableBuilder
+ * @brief Converts rows of text fields into typed kdb+ column vectors.
+ *
+ * Each column is a K vector of its final type, filled in place through the
+ * type map's value assigners, so a batch can be handed to the server as a
+ * table without going through q source text. Fields that fail to parse are
+ * stored as nulls, matching `assign_value`. Columns start small and double
+ * in size up to `batch_rows`, so many builders can be open at once.
+ */
+class TableBuilder {
+public:
+    /**
+     * @param column_names Column names of the table.
+     * @param column_types kdb+ vector type code of each column (e.g. KJ).
+     * @param batch_rows Maximum rows per batch; `full()` reports when reached.
+     */
+    TableBuilder(std::vector<std::string> column_names,
+                 const std::vector<I>& column_types,
+                 size_t batch_rows = 100000);
+    ~TableBuilder();
+
+    TableBuilder(const TableBuilder&) = delete;
+    TableBuilder& operator=(const TableBuilder&) = delete;
+
+    /**
+     * @brief Whether every column type is supported by the type map.
+     */
+    bool is_valid() const { return valid_; }
+
+    /**
+     * @brief Appends one row; missing trailing fields become nulls, extra fields are ignored.
+     */
+    void append_row(const std::vector<std::string>& fields);
+
+    /**
+     * @brief Checks that a row has one field per column and that every field parses.
+     *
+     * Uses the type map's validators, the same ones type inference applies,
+     * so rows that `append_row` would silently null-fill are caught.
+     *
+     * @param fields Fields of one record.
+     * @param reason Receives a description of the first problem found.
+     * @return bool True if the row can be appended without losing values.
+     */
+    bool validate_row(const std::vector<std::string>& fields, std::string& reason) const;
+
+    /**
+     * @brief Allocates room for `rows` rows up front (capped at `batch_rows`).
+     */
+    void reserve(size_t rows);
+
+    size_t rows() const { return rows_; }
+    bool full() const { return rows_ == batch_rows_; }
+
+    /**
+     * @brief Hands over the rows collected so far as a kdb+ table and starts a new batch.
+     *
+     * @return K An unkeyed table (type 98) owned by the caller, or nullptr if
+     *         no rows have been appended.
+     */
+    K take_table();
+
+private:
+    void allocate(size_t capacity);
+
+    std::vector<std::string> names_;
+    std::vector<const TypeInfo*> types_;
+    std::vector<K> columns_;   ///< Current batch, nullptr until the first row
+    size_t batch_rows_;
+    size_t capacity_ = 0;      ///< Rows allocated in the current batch
+    size_t rows_ = 0;
+    bool valid_ = true;
+};
+
+/**
+ * @brief Sends a client-built table to the server as a global.
+ *
+ * @param table_name Name of the global to write.
+ * @param table Table to send; ownership passes to the call.
+ * @param append Upsert into the existing table instead of replacing it.
+ * @return bool True if the server accepted the table, false otherwise.
+ */
+bool upload_table(const std::string& table_name, K table, bool append);
+
+#endif // TABLE_BUILDER_H
@@ -0,0 +1,147 @@
+#ifndef TABLE_WRITER_H
+#define TABLE_WRITER_H
+
+#include "k.h"
+#include "make_table.h"
+#include "type_map.h"
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Batching and flow-control settings for a `TableWriter`.
+ */
+struct TableWriterOptions {
+    size_t batch_rows = 100000;              ///< Rows per `upsert` call
+    std::chrono::milliseconds max_age{0};    ///< Flush rows buffered this long on the next write or `poll()` (0 = size only)
+    bool async = false;                      ///< Send batches without waiting for the server's reply
+    size_t max_in_flight = 4;                ///< Async batches sent before waiting for the server to catch up
+    std::string function = "upsert";         ///< q function applied to (table name; batch), e.g. ".u.upd"
+};
+
+/**
+ * @class TableWriter
+ * @brief Appends rows to a KDB+ table in batches.
+ *
+ * Rows and column blocks are collected in typed K vectors on the client and
+ * sent as one table per batch through a single `upsert` (or `options.function`)
+ * call with K arguments, so nothing is rendered as q source. A batch is sent
+ * when `batch_rows` rows are buffered or, with `max_age`, when the oldest
+ * buffered row is that old.
+ *
+ * With `async`, batches are sent on the negative handle and the writer does
+ * not wait for each reply; after `max_in_flight` batches it makes one
+ * synchronous round trip, which returns once the server has applied them, so
+ * a slow server pushes back on the producer instead of filling its input
+ * queue. Errors raised by async batches are reported in the server's console,
+ * not to the writer.
+ *
+ * The table must already exist with the writer's columns, or `function` must
+ * create it. A writer is not thread-safe; use one per feed thread.
+ */
+class TableWriter {
+public:
+    /**
+     * @param table_name Table to append to.
+     * @param column_names Column names, in table order.
+     * @param column_types Type key of each column from the type map, e.g. "j", "f", "s", "p".
+     * @param options Batch size, age and async settings.
+     */
+    TableWriter(std::string table_name,
+                std::vector<std::string> column_names,
+                const std::vector<std::string>& column_types,
+                TableWriterOptions options = TableWriterOptions());
+
+    /**
+     * @brief Sends any buffered rows and waits for outstanding async batches.
+     */
+    ~TableWriter();
+
+    TableWriter(const TableWriter&) = delete;
+    TableWriter& operator=(const TableWriter&) = delete;
+
+    /**
+     * @brief Whether the column names and types were accepted.
+     */
+    bool is_valid() const { return valid_; }
+
+    /**
+     * @brief Buffers one row, sending a batch if it fills or ages out.
+     *
+     * Integers and floating-point values fill numeric columns, `bool`
+     * fills boolean columns, and time points, dates, durations and GUIDs
+     * fill timestamp, date, timespan and guid columns. Strings fill symbol
+     * columns or are parsed for other types (e.g. "2024.01.02D10:00:00" into
+     * a timestamp column). `std::monostate` is a typed null.
+     *
+     * @param row One value per column.
+     * @return bool False if the row does not fit the columns (nothing is
+     *         buffered) or a batch could not be sent.
+     */
+    bool write(const std::vector<KDBType>& row);
+
+    /**
+     * @brief Buffers a block of whole columns.
+     *
+     * Columns are matched to the writer's by position and must have the
+     * writer's kdb+ types, e.g. `std::vector<int64_t>` for "j".
+     *
+     * @param columns Named columns of equal length, moved in.
+     * @return bool False if the block does not fit the columns or a batch could not be sent.
+     */
+    bool write_columns(std::vector<TableColumn>&& columns);
+
+    /**
+     * @brief Buffers the rows of a client-built table.
+     *
+     * A table of at least `batch_rows` rows arriving with nothing buffered is
+     * sent as it is, without copying.
+     *
+     * @param table Unkeyed table with the writer's column types; ownership passes to the call.
+     * @return bool False if the table does not fit the columns or a batch could not be sent.
+     */
+    bool write_table(K table);
+
+    /**
+     * @brief Sends the buffered rows if they are older than `max_age`.
+     *
+     * For feeds that may go quiet; call it from the producer's idle loop.
+     */
+    bool poll();
+
+    /**
+     * @brief Sends the buffered rows now, if any.
+     */
+    bool flush();
+
+    /**
+     * @brief Flushes, then waits until the server has applied every batch sent.
+     */
+    bool sync();
+
+    size_t rows_buffered() const { return rows_; }
+    size_t rows_sent() const { return rows_sent_; }
+    size_t batches_sent() const { return batches_sent_; }
+
+private:
+    bool append_rows(K table, size_t first, size_t count);
+    bool send(K batch);
+    void allocate(size_t capacity);
+    K take_batch();
+
+    std::string table_name_;
+    std::vector<std::string> names_;
+    std::vector<const TypeInfo*> types_;
+    TableWriterOptions options_;
+    std::vector<K> columns_;   ///< Current batch, nullptr until the first row
+    size_t capacity_ = 0;      ///< Rows allocated in the current batch
+    size_t rows_ = 0;
+    std::chrono::steady_clock::time_point oldest_;  ///< When the first buffered row arrived
+    size_t in_flight_ = 0;     ///< Async batches sent since the last round trip
+    size_t rows_sent_ = 0;
+    size_t batches_sent_ = 0;
+    bool valid_ = true;
+};
+
+#endif // TABLE_WRITER_H
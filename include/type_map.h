@@ -28,9 +28,16 @@ namespace detail {
     I parse_date(const std::string& s);
     F parse_datetime(const std::string& s);
     I parse_time(const std::string& s);
+    J parse_timestamp(const std::string& s);
+    J parse_timespan(const std::string& s);
+    I parse_month(const std::string& s);
+    I parse_minute(const std::string& s);
+    I parse_second(const std::string& s);
 }
 
 // Value handling functions
+const TypeInfo* find_type_info(int kdb_type);  // Entry for a kdb+ type code, or nullptr
+size_t element_size(int kdb_type);             // Bytes per element of a simple vector type
 bool is_null_value(K col_data, size_t idx);
 void assign_null_value(K col_data, size_t idx);
 void assign_value(K col_data, const std::string& value, size_t idx);
@@ -39,4 +46,27 @@ std::string format_value(K col_data, size_t idx);
 // Type inference
 I infer_column_type(const std::vector<std::string>& data);
 
+/**
+ * @brief Incrementally narrows down the kdb+ type of a single column.
+ *
+ * Values are observed one at a time, so inference can run over sampled or
+ * streamed rows without materialising the column. Accumulators filled on
+ * separate threads are combined with `merge` before calling `resolve`.
+ */
+class ColumnTypeAccumulator {
+public:
+    ColumnTypeAccumulator();
+
+    void observe(const std::string& value);              // Empty strings count as nulls
+    void merge(const ColumnTypeAccumulator& other);      // Intersect candidate types
+    I resolve() const;                                   // Highest priority type still valid
+    size_t observed() const { return observed_; }        // Non-empty values seen
+
+private:
+    std::vector<const TypeInfo*> candidates_;  // Type map entries in inference priority order
+    std::vector<char> valid_;                  // Parallel to candidates_
+    size_t remaining_ = 0;                     // Candidates with a validator still valid
+    size_t observed_ = 0;
+};
+
 #endif // TYPE_MAP_H
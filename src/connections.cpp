@@ -12,6 +12,7 @@
 
 // Initialize static members
 I KDBConnection::instance_handle = 0;
+thread_local I KDBConnection::thread_handle = 0;
 std::unique_ptr<KDBConnection::Cleanup> KDBConnection::cleanup_handler;
 
 // KDBConnection implementation
@@ -36,7 +37,12 @@ void KDBConnection::disconnect() {
     }
 }
 
+void KDBConnection::bind_thread(I handle) {
+    thread_handle = handle > 0 ? handle : 0;
+}
+
 I KDBConnection::getHandle() {
+    if (thread_handle > 0) return thread_handle;
     if (instance_handle <= 0) {
         throw std::runtime_error("Not connected to KDB+ server");
     }
@@ -0,0 +1,248 @@
+#include "decompress.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <zlib.h>
+
+#ifdef KDBEAR_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+constexpr size_t READ_CHUNK = 256 * 1024;  ///< Compressed bytes read per fread
+
+using FilePtr = std::unique_ptr<FILE, int (*)(FILE*)>;
+
+}  // namespace
+
+/**
+ * @brief Detects gzip (1f 8b) and zstd (28 b5 2f fd) inputs by their magic bytes
+ *
+ * @param filename Path of the file to inspect
+ * @return Compression The detected format
+ */
+Compression detect_compression(const std::string& filename) {
+    FilePtr file(std::fopen(filename.c_str(), "rb"), &std::fclose);
+    if (!file) return Compression::None;
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    size_t n = std::fread(magic, 1, sizeof(magic), file.get());
+
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return Compression::Gzip;
+    if (n >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+DecompressingReader::DecompressingReader(const std::string& filename,
+                                         Compression compression,
+                                         size_t block_size,
+                                         size_t max_blocks)
+    : filename_(filename),
+      compression_(compression),
+      block_size_(block_size),
+      max_blocks_(max_blocks == 0 ? 1 : max_blocks) {
+    worker_ = std::thread(&DecompressingReader::produce, this);
+}
+
+/**
+ * @brief Stops the producer thread, even if blocks are still queued
+ */
+DecompressingReader::~DecompressingReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    not_full_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+bool DecompressingReader::next(std::string& block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !blocks_.empty() || done_; });
+    if (blocks_.empty()) return false;
+
+    block = std::move(blocks_.front());
+    blocks_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return true;
+}
+
+bool DecompressingReader::failed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !error_.empty();
+}
+
+std::string DecompressingReader::error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+/**
+ * @brief Queues a block, blocking while the queue is full
+ *
+ * @return bool False if the consumer has stopped and the producer should exit
+ */
+bool DecompressingReader::push(std::string&& block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return blocks_.size() < max_blocks_ || stop_; });
+    if (stop_) return false;
+    blocks_.push_back(std::move(block));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+void DecompressingReader::finish(const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+        error_ = error;
+    }
+    not_empty_.notify_all();
+}
+
+/**
+ * @brief Producer thread body: reads the file and queues decompressed blocks
+ */
+void DecompressingReader::produce() {
+    FilePtr file(std::fopen(filename_.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        finish("unable to open " + filename_);
+        return;
+    }
+
+    std::vector<unsigned char> in(READ_CHUNK);
+    std::string out;
+
+    if (compression_ == Compression::None) {
+        // Pass-through: queue the raw bytes in block_size_ pieces
+        while (true) {
+            out.resize(block_size_);
+            size_t n = std::fread(out.data(), 1, block_size_, file.get());
+            if (n == 0) break;
+            out.resize(n);
+            if (!push(std::move(out))) return;
+            out = std::string();
+        }
+        finish(std::ferror(file.get()) ? "read error on " + filename_ : "");
+        return;
+    }
+
+    if (compression_ == Compression::Gzip) {
+        z_stream zs{};
+        // 15 + 32: maximum window, auto-detect gzip or zlib header
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+            finish("failed to initialise zlib");
+            return;
+        }
+        std::unique_ptr<z_stream, int (*)(z_stream*)> guard(&zs, &inflateEnd);
+
+        out.resize(block_size_);
+        size_t filled = 0;
+        bool at_eof = false;
+        bool in_member = false;  // a gzip member has started but not yet ended
+        while (true) {
+            if (zs.avail_in == 0 && !at_eof) {
+                size_t n = std::fread(in.data(), 1, in.size(), file.get());
+                if (n == 0) {
+                    at_eof = true;
+                } else {
+                    zs.next_in = in.data();
+                    zs.avail_in = static_cast<uInt>(n);
+                }
+            }
+
+            zs.next_out = reinterpret_cast<Bytef*>(out.data() + filled);
+            zs.avail_out = static_cast<uInt>(block_size_ - filled);
+            uInt in_before = zs.avail_in;
+            uInt out_before = zs.avail_out;
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+                finish("corrupt gzip data in " + filename_ + (zs.msg ? std::string(": ") + zs.msg : ""));
+                return;
+            }
+            bool progressed = zs.avail_in != in_before || zs.avail_out != out_before;
+            if (progressed) in_member = true;
+            filled = block_size_ - zs.avail_out;
+
+            if (filled == block_size_) {
+                if (!push(std::move(out))) return;
+                out = std::string(block_size_, '\0');
+                filled = 0;
+            }
+
+            if (ret == Z_STREAM_END) {
+                // Concatenated gzip members (e.g. from `cat a.gz b.gz`) continue the stream
+                in_member = false;
+                inflateReset(&zs);
+            } else if (at_eof && !progressed) {
+                // Input is exhausted and inflate has no more pending output to flush
+                break;
+            }
+        }
+
+        if (filled > 0) {
+            out.resize(filled);
+            if (!push(std::move(out))) return;
+        }
+        finish(in_member ? "truncated gzip data in " + filename_ : "");
+        return;
+    }
+
+#ifdef KDBEAR_WITH_ZSTD
+    std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> zds(ZSTD_createDStream(), &ZSTD_freeDStream);
+    if (!zds || ZSTD_isError(ZSTD_initDStream(zds.get()))) {
+        finish("failed to initialise zstd");
+        return;
+    }
+
+    out.resize(block_size_);
+    ZSTD_outBuffer output{out.data(), block_size_, 0};
+    size_t last = 0;
+    // Feeds one input buffer, queueing each output block as it fills. A full
+    // output buffer may leave data inside the decoder, so decoding continues
+    // after the input is consumed until the decoder returns short of a block.
+    auto decode = [&](ZSTD_inBuffer& input) {
+        bool full = false;
+        do {
+            last = ZSTD_decompressStream(zds.get(), &output, &input);
+            if (ZSTD_isError(last)) {
+                finish("corrupt zstd data in " + filename_ + ": " + ZSTD_getErrorName(last));
+                return false;
+            }
+            full = output.pos == output.size;
+            if (full) {
+                if (!push(std::move(out))) return false;
+                out = std::string(block_size_, '\0');
+                output = ZSTD_outBuffer{out.data(), block_size_, 0};
+            }
+            // last == 0: the frame ended and everything has been flushed
+        } while (input.pos < input.size || (full && last != 0));
+        return true;
+    };
+
+    while (true) {
+        size_t n = std::fread(in.data(), 1, in.size(), file.get());
+        if (n == 0) break;
+        ZSTD_inBuffer input{in.data(), n, 0};
+        if (!decode(input)) return;
+    }
+    if (last != 0) {
+        // Final flush of anything the decoder still holds after the last read
+        ZSTD_inBuffer input{in.data(), 0, 0};
+        if (!decode(input)) return;
+    }
+
+    if (output.pos > 0) {
+        out.resize(output.pos);
+        if (!push(std::move(out))) return;
+    }
+    finish(last == 0 ? "" : "truncated zstd data in " + filename_);
+#else
+    finish("zstd input requires KDBear to be built with ZSTD=1");
+#endif
+}
@@ -0,0 +1,314 @@
+#include "follow_csv.h"
+#include "inline_query.h"
+#include "read_csv.h"
+#include "type_map.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t READ_CHUNK = 16 << 20;  ///< Largest read per step, bounds memory on big backlogs
+
+}  // namespace
+
+CsvFollower::CsvFollower(const std::string& table_name,
+                         const std::string& filename,
+                         const FollowOptions& options)
+    : table_name_(table_name),
+      filename_(filename),
+      options_(options),
+      header_seen_(!options.header) {
+}
+
+CsvFollower::~CsvFollower() {
+#ifdef __linux__
+    if (watch_fd_ >= 0) ::close(watch_fd_);
+#endif
+}
+
+/**
+ * @brief Reads the bytes appended since the last poll and loads the complete records
+ *
+ * @return size_t Number of rows appended to the table
+ */
+size_t CsvFollower::poll() {
+    if (failed_) return 0;
+
+    size_t before = rows_loaded_;
+    if (!file_.is_open()) file_.open(filename_, std::ios::binary);
+    bool shrunk = file_.is_open() && !read_to_end();
+
+    // The open file has been read to its end; switch if the path now names another one
+    std::error_code ec;
+    uint64_t path_size = std::filesystem::file_size(filename_, ec);
+    if (rotated_ || shrunk || (!ec && path_size < offset_ + pending_.size())) {
+        // Truncated or replaced: the existing rows stay, the new file is read from the top
+        std::cerr << "Warning: " << filename_ << " was truncated or replaced, following from the start." << std::endl;
+        file_.close();
+        offset_ = 0;
+        pending_.clear();
+        header_seen_ = !options_.header;
+        rotated_ = false;
+        file_.open(filename_, std::ios::binary);
+        if (file_.is_open()) read_to_end();
+    }
+
+    // Fix the schema from fewer rows once the writer has been quiet for long enough
+    if (!builder_ && !inference_rows_.empty() && !failed_ &&
+        std::chrono::steady_clock::now() - inference_started_ >= options_.inference_timeout) {
+        resolve_schema();
+    }
+    flush();
+    return rows_loaded_ - before;
+}
+
+/**
+ * @brief Fixes the schema from the rows held so far and loads them
+ *
+ * @return size_t Number of rows appended to the table
+ */
+size_t CsvFollower::finish() {
+    size_t before = rows_loaded_;
+    if (!builder_ && !inference_rows_.empty() && !failed_) resolve_schema();
+    flush();
+    return rows_loaded_ - before;
+}
+
+/**
+ * @brief Reads the open file from the last position read to its current end
+ *
+ * @return bool False if the file is now shorter than what was already read
+ */
+bool CsvFollower::read_to_end() {
+    file_.clear();
+    file_.seekg(0, std::ios::end);
+    std::streamoff end = file_.tellg();
+    if (end < 0) return true;
+
+    uint64_t size = static_cast<uint64_t>(end);
+    uint64_t pos = offset_ + pending_.size();
+    if (size < pos) return false;
+    file_.seekg(static_cast<std::streamoff>(pos));
+
+    std::string chunk;
+    while (pos < size && !failed_) {
+        chunk.resize(static_cast<size_t>(std::min<uint64_t>(size - pos, READ_CHUNK)));
+        file_.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        size_t got = static_cast<size_t>(file_.gcount());
+        if (got == 0) break;
+        pending_.append(chunk, 0, got);
+        pos += got;
+        consume_pending();
+    }
+    return true;
+}
+
+/**
+ * @brief Tokenizes every complete record in pending_ and advances the offset past it
+ */
+void CsvFollower::consume_pending() {
+    const char* begin = pending_.data();
+    const char* end = begin + pending_.size();
+    const char* p = begin;
+    std::vector<std::string> row;
+
+    while (p < end && !failed_) {
+        const char* rec_end = detail::find_record_end(p, end);
+        if (rec_end == end) break;  // Writer has not finished this line yet
+
+        if (!detail::is_blank_record(p, rec_end)) {
+            detail::tokenize_record(p, rec_end, options_.delimiter, row);
+            if (!header_seen_) {
+                header_seen_ = true;
+                if (headers_.empty() &&
+                    !detail::resolve_headers(row, true, options_.key_column, headers_)) {
+                    failed_ = true;
+                }
+            } else {
+                handle_row(row);
+            }
+        }
+        p = rec_end + 1;
+    }
+
+    offset_ += p - begin;
+    pending_.erase(0, p - begin);
+}
+
+/**
+ * @brief Adds one data row, holding it back while the schema is still being inferred
+ */
+void CsvFollower::handle_row(const std::vector<std::string>& row) {
+    if (!builder_) {
+        if (headers_.empty()) {
+            detail::resolve_headers(row, false, options_.key_column, headers_);
+        }
+        if (inference_rows_.empty()) inference_started_ = std::chrono::steady_clock::now();
+        inference_rows_.push_back(row);
+        if (!options_.column_types.empty() ||
+            inference_rows_.size() >= std::max<size_t>(1, options_.inference_rows)) {
+            resolve_schema();
+        }
+        return;
+    }
+
+    builder_->append_row(row);
+    if (builder_->full()) flush();
+}
+
+/**
+ * @brief Fixes the column types and loads the rows held for inference
+ */
+bool CsvFollower::resolve_schema() {
+    std::vector<I> col_types;
+    if (!options_.column_types.empty()) {
+        if (!detail::resolve_column_types(options_.column_types, headers_.size(), col_types)) {
+            failed_ = true;
+            return false;
+        }
+    } else {
+        std::vector<ColumnTypeAccumulator> columns(headers_.size());
+        for (const auto& r : inference_rows_) {
+            size_t n = std::min(r.size(), columns.size());
+            for (size_t col = 0; col < n; ++col) columns[col].observe(r[col]);
+        }
+        for (const auto& column : columns) col_types.push_back(column.resolve());
+    }
+
+    builder_ = std::make_unique<TableBuilder>(headers_, col_types, options_.batch_rows);
+    if (!builder_->is_valid()) {
+        std::cerr << "Error: Unsupported column type for " << filename_ << std::endl;
+        failed_ = true;
+        return false;
+    }
+
+    std::vector<std::vector<std::string>> held;
+    held.swap(inference_rows_);
+    for (const auto& r : held) {
+        builder_->append_row(r);
+        if (builder_->full() && !flush()) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sends the current batch; the first batch creates (and keys) the table
+ */
+bool CsvFollower::flush() {
+    if (!builder_ || builder_->rows() == 0 || failed_) return !failed_;
+
+    size_t rows = builder_->rows();
+    bool first = batches_ == 0;
+    if (!upload_table(table_name_, builder_->take_table(), !first)) {
+        failed_ = true;
+        return false;
+    }
+    batches_++;
+    rows_loaded_ += rows;
+
+    if (first && !options_.key_column.empty()) {
+        auto result = inline_query("(`" + options_.key_column + ") xkey `" + table_name_);
+        if (K data = result.get_result()) r0(data);
+        if (!bool(result)) {
+            failed_ = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for the file to be written to, moved or deleted
+ *
+ * @param timeout Longest time to wait
+ */
+void CsvFollower::wait_for_change(std::chrono::milliseconds timeout) {
+#ifdef __linux__
+    if (watch_fd_ < 0) watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd_ >= 0 && watch_wd_ < 0) {
+        watch_wd_ = inotify_add_watch(watch_fd_, filename_.c_str(),
+                                      IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                      IN_MOVE_SELF | IN_DELETE_SELF);
+    }
+
+    if (watch_wd_ >= 0) {
+        pollfd pfd{watch_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, static_cast<int>(timeout.count())) > 0) {
+            alignas(inotify_event) char events[4096];
+            ssize_t n;
+            while ((n = ::read(watch_fd_, events, sizeof(events))) > 0) {
+                for (char* p = events; p < events + n; ) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(p);
+                    // IN_IGNORED also arrives for watches already removed below, so match the wd
+                    if (event->wd == watch_wd_ &&
+                        (event->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED))) {
+                        // The path now names a different file (or none); re-watch it
+                        inotify_rm_watch(watch_fd_, watch_wd_);
+                        watch_wd_ = -1;
+                        rotated_ = true;
+                    }
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        }
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(timeout);
+}
+
+/**
+ * @brief Follows a CSV file until `stop` is set
+ *
+ * @param table_name Name of the table to create and append to
+ * @param filename Path to the CSV file being written
+ * @param stop Flag checked between polls
+ * @param options Parsing, schema and polling options
+ * @return bool True if stopped normally, false if a load failed
+ */
+bool follow_csv(const std::string& table_name,
+                const std::string& filename,
+                const std::atomic<bool>& stop,
+                const FollowOptions& options) {
+    if (filename.empty() || table_name.empty()) {
+        std::cerr << "Error: Empty filename or table name." << std::endl;
+        return false;
+    }
+
+    CsvFollower follower(table_name, filename, options);
+    while (true) {
+        size_t rows = follower.poll();
+        if (follower.failed()) {
+            std::cerr << "Error: Stopped following " << filename << " after "
+                      << follower.rows_loaded() << " rows." << std::endl;
+            return false;
+        }
+        if (rows > 0) {
+            std::cout << "Appended " << rows << " rows to '" << table_name << "' (offset "
+                      << follower.offset() << ")." << std::endl;
+        }
+        if (stop.load()) break;
+        follower.wait_for_change(options.poll_interval);
+    }
+
+    size_t held = follower.finish();
+    if (follower.failed()) {
+        std::cerr << "Error: Stopped following " << filename << " after "
+                  << follower.rows_loaded() << " rows." << std::endl;
+        return false;
+    }
+    if (held > 0) {
+        std::cout << "Appended " << held << " rows to '" << table_name << "' (offset "
+                  << follower.offset() << ")." << std::endl;
+    }
+    return true;
+}
@@ -1,5 +1,42 @@
 #include "inline_query.h"
 
+namespace {
+
+/**
+ * @brief Converts a raw reply from the server into a QueryResult
+ *
+ * @param result The K object returned by k()
+ * @return QueryResult false for failures, true for void results, else the K object
+ */
+QueryResult handle_result(K result) {
+    // Check if the result is null, indicating a failure in execution
+    if (!result) {
+        std::cerr << "Query execution failed: null result" << std::endl;
+        return false; // Return a QueryResult containing 'false' to indicate failure
+    }
+
+    // Handle error responses from KDB+ (type -128 indicates an error)
+    if (result->t == -128) {
+        std::string error_msg = result->s;  // Extract the error message
+        r0(result);  // Release the K object to prevent memory leaks
+        std::cerr << "Query execution error: " << error_msg << std::endl;
+        return false; // Return a QueryResult containing 'false' to indicate error
+    }
+
+    // Handle successful execution with a null result (e.g., assignments or void operations)
+    if (result->t == 101) {
+        //std::cout << "Query executed successfully (null result due to assignment or void operation)." << std::endl;
+        r0(result);  // Release the K object as there's no data to return
+        return true; // Return a QueryResult containing 'true' to indicate success without data
+    }
+
+    // If execution is successful and returns data, log the success and return the result
+    //std::cout << "Query executed successfully." << std::endl;
+    return result; // Return a QueryResult containing the K object with query data
+}
+
+}  // namespace
+
 /**
  * @brief Executes an inline KDB+ query and returns the result.
  *
@@ -24,35 +61,61 @@ QueryResult inline_query(const std::string& query) {
     try {
         // Execute the query using the KDB+ handle and retrieve the result
         K result = k(KDBConnection::getHandle(), const_cast<char*>(query.c_str()), (K)0);
+        return handle_result(result);
+    }
+    catch (const std::exception& e) {
+        // Catch and log any exceptions that occur during query execution
+        std::cerr << "Error executing query: " << e.what() << std::endl;
+        return false; // Return a QueryResult containing 'false' to indicate exception
+    }
+}
 
-        // Check if the result is null, indicating a failure in execution
-        if (!result) {
-            std::cerr << "Query execution failed: null result" << std::endl;
-            return false; // Return a QueryResult containing 'false' to indicate failure
-        }
+/**
+ * @brief Applies a q function to K arguments on the KDB+ server.
+ *
+ * The arguments are sent with the function in a single message, so large
+ * client-built objects reach the server in binary IPC form.
+ *
+ * @param function The q function or expression to apply
+ * @param args Between one and eight K arguments, released by the call
+ * @return QueryResult As for the query string overload
+ */
+QueryResult inline_query(const std::string& function, std::initializer_list<K> args) {
+    const K* a = args.begin();
+    if (args.size() == 0 || args.size() > 8) {
+        std::cerr << "Query execution error: expected 1-8 arguments, got " << args.size() << std::endl;
+        for (K arg : args) r0(arg);
+        return false;
+    }
 
-        // Handle error responses from KDB+ (type -128 indicates an error)
-        if (result->t == -128) {
-            std::string error_msg = result->s;  // Extract the error message
-            r0(result);  // Release the K object to prevent memory leaks
-            std::cerr << "Query execution error: " << error_msg << std::endl;
-            return false; // Return a QueryResult containing 'false' to indicate error
-        }
+    I handle;
+    try {
+        handle = KDBConnection::getHandle();
+    }
+    catch (const std::exception& e) {
+        // The arguments never reached k(), so they are still ours to release
+        std::cerr << "Error executing query: " << e.what() << std::endl;
+        for (K arg : args) r0(arg);
+        return false;
+    }
 
-        // Handle successful execution with a null result (e.g., assignments or void operations)
-        if (result->t == 101) {
-            //std::cout << "Query executed successfully (null result due to assignment or void operation)." << std::endl;
-            r0(result);  // Release the K object as there's no data to return
-            return true; // Return a QueryResult containing 'true' to indicate success without data
+    try {
+        S f = const_cast<S>(function.c_str());
+        K result = nullptr;
+        switch (args.size()) {
+            case 1: result = k(handle, f, a[0], (K)0); break;
+            case 2: result = k(handle, f, a[0], a[1], (K)0); break;
+            case 3: result = k(handle, f, a[0], a[1], a[2], (K)0); break;
+            case 4: result = k(handle, f, a[0], a[1], a[2], a[3], (K)0); break;
+            case 5: result = k(handle, f, a[0], a[1], a[2], a[3], a[4], (K)0); break;
+            case 6: result = k(handle, f, a[0], a[1], a[2], a[3], a[4], a[5], (K)0); break;
+            case 7: result = k(handle, f, a[0], a[1], a[2], a[3], a[4], a[5], a[6], (K)0); break;
+            default: result = k(handle, f, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], (K)0); break;
         }
-
-        // If execution is successful and returns data, log the success and return the result
-        //std::cout << "Query executed successfully." << std::endl;
-        return result; // Return a QueryResult containing the K object with query data
+        return handle_result(result);
     }
     catch (const std::exception& e) {
-        // Catch and log any exceptions that occur during query execution
         std::cerr << "Error executing query: " << e.what() << std::endl;
-        return false; // Return a QueryResult containing 'false' to indicate exception
+        return false;
     }
 }
@@ -1,8 +1,13 @@
 #include "joins.h"
 #include <iostream>
-#include <iomanip>
-#include <sstream>  
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include "inline_query.h"
+#include "local_joins.h"
+#include "table_builder.h"
 
 /**
  * @namespace joins
@@ -17,55 +22,72 @@ namespace joins {
 namespace detail {
 
 /**
- * @brief Prepares unkeyed versions of the input tables for joining.
+ * @brief Wraps a join body in one q expression over unkeyed views of both tables.
  *
- * This function creates unkeyed copies of the provided tables by prefixing them with
- * "_unkeyed". It constructs and executes a kdb+ query to perform this operation.
+ * The body is a lambda over `l` (the first table) and `r` (the second), applied
+ * to `0!` of each source. Both are locals of the lambda, so no copies are
+ * written to the root namespace and the server frees them as soon as the
+ * expression returns.
  *
- * @param table1 The name of the first table to prepare.
- * @param table2 The name of the second table to prepare.
- * @param t1_unkeyed Reference to a string that will hold the name of the unkeyed first table.
- * @param t2_unkeyed Reference to a string that will hold the name of the unkeyed second table.
- * @return true If the tables were prepared successfully.
- * @return false If the preparation query failed.
+ * @param body The q code of the lambda, e.g. "l ij `ticker xkey r".
+ * @param table1 Name (or q expression) of the first table.
+ * @param table2 Name (or q expression) of the second table.
+ * @return std::string The q expression computing the join.
+ */
+std::string join_expression(const std::string& body,
+                            const std::string& table1,
+                            const std::string& table2) {
+    return "{[l;r] " + body + "}[0!(" + table1 + ");0!(" + table2 + ")]";
+}
+
+/**
+ * @brief Builds a q symbol list from column names, e.g. "`ticker`time".
  *
- * Note: The function appends "_unkeyed" to table names. Ensure original table
- * names don't already end with this suffix to avoid conflicts.
+ * @param columns Column names, without backticks.
+ * @return std::string The symbol list, or an empty string if there are no columns.
  */
-bool prepare_tables(const std::string& table1,
-                   const std::string& table2,
-                   std::string& t1_unkeyed,
-                   std::string& t2_unkeyed) {
-    t1_unkeyed = table1 + "_unkeyed";
-    t2_unkeyed = table2 + "_unkeyed";
-
-    // Construct the preparation query to create unkeyed tables
-    std::string prep_query = t1_unkeyed + ": 0!(" + table1 + ");";
-    prep_query += t2_unkeyed + ": 0!(" + table2 + ");";
-
-    //std::cout << "\nPreparing tables with query: " << prep_query << std::endl;
-    
-    // Execute the preparation query
-    auto prep_result = inline_query(prep_query);
-    return bool(prep_result);  // Convert the result to a boolean indicating success
+std::string key_list(const std::vector<std::string>& columns) {
+    std::string keys;
+    for (const auto& column : columns) keys += "`" + column;
+    return keys;
 }
 
 /**
- * @brief Cleans up temporary unkeyed tables after join operations.
+ * @brief q code giving join keys of a lambda-local table a `g#` index.
  *
- * This function deletes the temporary unkeyed tables from the kdb+ environment to free up resources.
+ * Columns that already carry an attribute (as `meta` would show) are left
+ * alone, as are general lists, which cannot be grouped. Only the local copy
+ * is changed, never the caller's table.
  *
- * @param t1_unkeyed The name of the first unkeyed table to delete.
- * @param t2_unkeyed The name of the second unkeyed table to delete.
+ * @param table The local holding the table, e.g. "r".
+ * @param columns Columns to index.
+ * @return std::string A q statement ending in "; ", or "" if there are no columns.
  */
-void cleanup_tables(const std::string& t1_unkeyed, const std::string& t2_unkeyed) {
-    // Construct the cleanup query to delete unkeyed tables
-    std::string cleanup_query = "delete " + t1_unkeyed + " from `.; "
-                              "delete " + t2_unkeyed + " from `.;";
-    //std::cout << "\nCleaning up with query: " << cleanup_query << std::endl;
-
-    // Execute the cleanup query
-    inline_query(cleanup_query);
+std::string group_keys(const std::string& table, const std::vector<std::string>& columns) {
+    if (columns.empty()) return "";
+    return table + ":{[t;c] c:c where (null attr each t c) and 0<type each t c; @[t;c;`g#]}[" +
+           table + ";()," + key_list(columns) + "]; ";
+}
+
+/**
+ * @brief The first join column alone, the one `aj` and `wj` look up by; empty if there are none.
+ */
+std::vector<std::string> leading_key(const std::vector<std::string>& columns) {
+    return columns.empty() ? std::vector<std::string>() : std::vector<std::string>{columns.front()};
+}
+
+/**
+ * @brief q code putting a lambda-local table in order of a time column, marked `s#`.
+ *
+ * A column that is already `s#` is trusted; one that is sorted is just
+ * marked; otherwise the table is stably sorted by it, as `aj` requires.
+ *
+ * @param table The local holding the table, e.g. "r".
+ * @param column The time column.
+ * @return std::string A q statement ending in "; ".
+ */
+std::string sort_by_time(const std::string& table, const std::string& column) {
+    return table + ":{[t;c] $[`s=attr t c;t;(asc x)~x:t c;@[t;c;`s#];c xasc t]}[" + table + ";`" + column + "]; ";
 }
 
 /**
@@ -90,45 +112,110 @@ std::string build_join_by(const std::vector<std::string>& join_columns) {
 }
 
 /**
- * @brief Executes a join query and handles the cleanup of temporary tables.
+ * @brief Builds the q symbol a join result is stored under.
+ *
+ * An empty `result_name` gives a fresh name in the scratch namespace, made
+ * unique by the server's handle for this connection (`.z.w`) and a
+ * process-wide counter, so concurrent joins from other threads, connections
+ * or processes never collide.
+ *
+ * @param result_name The requested name, or empty for a scratch name.
+ * @return std::string A q expression evaluating to the name as a symbol.
+ */
+std::string result_symbol(const std::string& result_name) {
+    static std::atomic<unsigned long long> counter{0};
+    if (!result_name.empty()) return "`" + result_name;
+    return "`$\"" + std::string(SCRATCH_NAMESPACE) + ".w\",string[.z.w],\"_" +
+           std::to_string(++counter) + "\"";
+}
+
+/**
+ * @brief Executes a join query, stores its result and describes the joined table.
  *
- * This function executes the provided kdb+ join query, retrieves the result, and ensures that
- * temporary unkeyed tables are deleted regardless of the join's success.
+ * The result is only assigned once the whole join has evaluated, so a failed
+ * join leaves nothing behind. The name, row count, column names and column
+ * types are read in the same round trip; the rows themselves stay on the server.
  *
- * @param query The kdb+ join query to execute.
- * @param result_name The name under which the joined table will be stored.
- * @param t1_unkeyed The name of the first temporary unkeyed table.
- * @param t2_unkeyed The name of the second temporary unkeyed table.
- * @return K The kdb+ object representing the joined table, or nullptr if the join failed.
+ * @param query The kdb+ expression computing the joined table.
+ * @param result_name The name under which the joined table will be stored,
+ *        or empty to store it under a unique name in the scratch namespace.
+ * @return JoinResult Handle to the joined table; false if the join failed.
  */
-K execute_join(const std::string& query,
-              const std::string& result_name,
-              const std::string& t1_unkeyed,
-              const std::string& t2_unkeyed) {
+JoinResult execute_join(const std::string& query, const std::string& result_name) {
     //std::cout << "\nExecuting KDB+ Query: " << query << std::endl;
-    
-    // Execute the join operation
-    auto exec_result = inline_query(query);
-    if (!bool(exec_result)) {
-        // If the join fails, perform cleanup and return nullptr
-        cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
-    }
 
-    // Retrieve the joined table by its result name
-    auto result = inline_query(result_name);
-    cleanup_tables(t1_unkeyed, t2_unkeyed);
+    // Execute the join operation, store it and describe its result
+    auto exec_result = inline_query("{[n;t] n set t; (n;count t;cols t;type each value flip 0!t)}[" +
+                                    result_symbol(result_name) + ";" + query + "]");
+    K description = exec_result.get_result();
+    if (!description || description->t != 0 || description->n != 4 || kK(description)[0]->t != -KS ||
+        kK(description)[1]->t != -KJ || kK(description)[2]->t != KS || kK(description)[3]->t != KH) {
+        if (bool(exec_result)) std::cerr << "Unexpected description of joined table '" << result_name << "'" << std::endl;
+        if (description) r0(description);
+        return JoinResult();
+    }
 
-    if (!bool(result)) {
-        return nullptr;
+    std::vector<ColumnMeta> columns;
+    for (J i = 0; i < kK(description)[2]->n; ++i) {
+        columns.push_back({kS(kK(description)[2])[i], kH(kK(description)[3])[i]});
     }
+    std::string name = kK(description)[0]->s;
+    J rows = kK(description)[1]->j;
+    r0(description);
 
-    //std::cout << "Saved joined table as: '" << result_name << "'" << std::endl;
-    return result.get_result();
+    //std::cout << "Saved joined table as: '" << name << "'" << std::endl;
+    return JoinResult(name, rows, std::move(columns));
+}
+
+/**
+ * @brief Builds a q expression deleting a global, e.g. "delete t from `." or
+ *        "delete w5_1 from `.kdbear.join".
+ *
+ * @param name The global's name, optionally qualified by its namespace.
+ * @return std::string The delete expression.
+ */
+std::string delete_global(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos || dot == 0) return "delete " + name + " from `.";
+    return "delete " + name.substr(dot + 1) + " from `" + name.substr(0, dot);
 }
 
 } // namespace detail
 
+K JoinResult::fetch() const {
+    if (!valid_) return nullptr;
+    return inline_query(name_).get_result();
+}
+
+K JoinResult::fetch_rows(J first, J count) const {
+    if (!valid_) return nullptr;
+    return inline_query(std::to_string(first) + " " + std::to_string(count) + " sublist " + name_).get_result();
+}
+
+K JoinResult::fetch_columns(const std::vector<std::string>& columns) const {
+    if (!valid_ || columns.empty()) return nullptr;
+    return inline_query("(" + std::string(columns.size() == 1 ? "enlist" : "") + detail::key_list(columns) +
+                        ")#" + name_).get_result();
+}
+
+bool JoinResult::drop() {
+    if (!valid_) return false;
+    valid_ = false;
+    return bool(inline_query(detail::delete_global(name_)));
+}
+
+/**
+ * @brief Deletes every scratch result this connection has created.
+ *
+ * Results of other connections are left alone, so a session can clean up
+ * without disturbing joins running concurrently on the same server.
+ */
+bool clear_scratch() {
+    // The namespace may not exist yet; nothing to clear then
+    return bool(inline_query("@[{![`" + std::string(SCRATCH_NAMESPACE) + ";();0b;k where (k:key " +
+                             SCRATCH_NAMESPACE + ") like \"w\",string[.z.w],\"_*\"]};::;{}]"));
+}
+
 /**
  * @brief Performs an inner join between two kdb+ tables.
  *
@@ -137,30 +224,22 @@ K execute_join(const std::string& query,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param join_columns A vector of column names to join on. If empty, a natural join is performed.
- * @return K The kdb+ object representing the joined table, or (K)0 if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  */
-K inner_join(const std::string& table1,
-             const std::string& table2,
-             const std::string& result_name,
-             const std::vector<std::string>& join_columns) {
-    std::string t1_unkeyed, t2_unkeyed;
-    
-    if (!detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) return (K)0;
-
+JoinResult inner_join(const std::string& table1,
+                      const std::string& table2,
+                      const std::string& result_name,
+                      const std::vector<std::string>& join_columns) {
     std::string query;
     if (!join_columns.empty()) {
-        std::string key_cols = join_columns[0];
-        for (size_t i = 1; i < join_columns.size(); ++i) {
-            key_cols += "`" + join_columns[i];
-        }
-        query = result_name + ": " + t1_unkeyed + " ij `" + key_cols + " xkey " + t2_unkeyed;
+        query = detail::group_keys("r", join_columns) + "l ij " + detail::key_list(join_columns) + " xkey r";
     } else {
-        query = result_name + ": " + t1_unkeyed + " ij (enlist first cols[" + t1_unkeyed +
-                "] inter cols[" + t2_unkeyed + "]) xkey " + t2_unkeyed;
+        query = "l ij (enlist first cols[l] inter cols[r]) xkey r";
     }
-    return detail::execute_join(query, result_name, t1_unkeyed, t2_unkeyed);
+    query = detail::join_expression(query, table1, table2);
+    return detail::execute_join(query, result_name);
 }
 
 /**
@@ -171,54 +250,166 @@ K inner_join(const std::string& table1,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param time_column_left The name of the time column in the first table.
  * @param time_column_right The name of the time column in the second table.
  * @param join_columns A vector of column names to join on, excluding the time columns.
- * @return K The kdb+ object representing the joined table, or nullptr if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  */
-K asof_join(const std::string& table1,
-            const std::string& table2,
-            const std::string& result_name,
-            const std::string& time_column_left,
-            const std::string& time_column_right,
-            const std::vector<std::string>& join_columns) {
-    std::string t1_unkeyed, t2_unkeyed;
-    
-    // Prepare unkeyed versions of the input tables
-    if (!detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) return nullptr;
-
-    // Build the join columns string excluding the time columns
-    std::string join_by = join_columns.empty() ? "" : join_columns[0];
-    for (size_t i = 1; i < join_columns.size(); ++i) {
-        join_by += "`" + join_columns[i];
-    }
+JoinResult asof_join(const std::string& table1,
+                     const std::string& table2,
+                     const std::string& result_name,
+                     const std::string& time_column_left,
+                     const std::string& time_column_right,
+                     const std::vector<std::string>& join_columns) {
+    // Index the right table as aj expects: in time order and grouped on the first key.
+    // Keep the right table's match time as a second column; the rename is part of the expression
+    std::string query = detail::sort_by_time("r", time_column_right) +
+                        detail::group_keys("r", detail::leading_key(join_columns)) +
+                        "aj[" + detail::key_list(join_columns) + "`" + time_column_left + ";l;" +
+                        "update " + time_column_right + "2:" + time_column_right + " from r]";
+    query = detail::join_expression(query, table1, table2);
+    return detail::execute_join(query, result_name);
+}
 
-    // Rename the right table's time column to avoid name collision
-    std::string rename_query = "update " + time_column_right + "2:" + time_column_right + " from " + t2_unkeyed;
-    auto rename_result = inline_query(t2_unkeyed + "_adj: " + rename_query);
-    if (!bool(rename_result)) {
-        std::cerr << "Failed to rename time column in right table for asof join." << std::endl;
-        detail::cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
-    }
+/**
+ * @brief Builds the as-of sub-join of one group of partition values `g`.
+ *
+ * Only the left rows whose partition value is in `g` are joined, against
+ * the right rows with the same values. Each row keeps its position in the
+ * left table as `kdbear_row`, so the groups can be put back in order.
+ *
+ * @return std::string q code of a lambda body over `l`, `r` and `g`.
+ */
+std::string detail::partition_asof_body(const std::string& time_column_left,
+                                       const std::string& time_column_right,
+                                       const std::vector<std::string>& join_columns,
+                                       const std::string& partition_column) {
+    return "w:where l[`" + partition_column + "] in g; " +
+           "q:r where r[`" + partition_column + "] in g; " +
+           detail::sort_by_time("q", time_column_right) +
+           detail::group_keys("q", detail::leading_key(join_columns)) +
+           "aj[" + detail::key_list(join_columns) + "`" + time_column_left + ";" +
+           "update kdbear_row:w from l w;update " + time_column_right + "2:" + time_column_right + " from q]";
+}
 
-    // Build the as-of join query
-    std::string aj_query;
-    if (!join_by.empty()) {
-        aj_query = result_name + ": aj[`" + join_by + "`" + time_column_left + ";" +
-                   t1_unkeyed + ";" + t2_unkeyed + "_adj]";
-    } else {
-        aj_query = result_name + ": aj[`" + time_column_left + ";" +
-                   t1_unkeyed + ";" + t2_unkeyed + "_adj]";
+/**
+ * @brief Performs an as-of join as concurrent sub-joins over groups of a partition column.
+ *
+ * The distinct values of `options.partition_column` in the first table are
+ * split into `options.partitions` groups. Without endpoints, one server
+ * query joins every group with `peach` and concatenates the results. With
+ * endpoints, a pool of threads, each on its own connection, claims groups
+ * and fetches their sub-results, which are then appended to a staging table
+ * on the main connection. Either way the rows are put back in the first
+ * table's order before the result is stored.
+ *
+ * @param table1 The name of the first table to join.
+ * @param table2 The name of the second table to join.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
+ * @param time_column_left The name of the time column in the first table.
+ * @param time_column_right The name of the time column in the second table.
+ * @param join_columns A vector of column names to join on, including the partition column.
+ * @param options Partitioning and connection pool settings.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
+ */
+JoinResult asof_join_partitioned(const std::string& table1,
+                                 const std::string& table2,
+                                 const std::string& result_name,
+                                 const std::string& time_column_left,
+                                 const std::string& time_column_right,
+                                 const std::vector<std::string>& join_columns,
+                                 const PartitionOptions& options) {
+    // Splitting on anything but a join column would change which rows can match
+    if (std::find(join_columns.begin(), join_columns.end(), options.partition_column) == join_columns.end()) {
+        std::cerr << "Partition column '" << options.partition_column << "' must be a join column." << std::endl;
+        return JoinResult();
+    }
+    size_t partitions = std::max<size_t>(1, options.partitions);
+    std::string body = detail::partition_asof_body(time_column_left, time_column_right, join_columns,
+                                           options.partition_column);
+
+    // An empty left table has no partition values; join it whole rather than razing nothing
+    std::string query = "g:(1|ceiling count[d]%" + std::to_string(partitions) + ") cut d:distinct l`" +
+                        options.partition_column + "; f:{[l;r;g] " + body + "}[l;r]; " +
+                        "delete kdbear_row from `kdbear_row xasc $[count d;raze f peach g;f d]";
+    query = detail::join_expression(query, table1, table2);
+    if (options.endpoints.empty()) return detail::execute_join(query, result_name);
+
+    // Groups of partition values, sliced on the client and sent to the workers as K lists
+    K values = inline_query("distinct (0!(" + table1 + "))`" + options.partition_column).get_result();
+    if (!values || values->t < 0 || values->t >= 20) {
+        std::cerr << "Could not read the values of partition column '" << options.partition_column << "'." << std::endl;
+        if (values) r0(values);
+        return JoinResult();
+    }
+    if (values->n == 0) {
+        r0(values);
+        return detail::execute_join(query, result_name);
+    }
+    size_t per_group = std::max<size_t>(1, (static_cast<size_t>(values->n) + partitions - 1) / partitions);
+    std::vector<K> groups;
+    for (J first = 0; first < values->n; first += static_cast<J>(per_group)) {
+        std::vector<J> rows;
+        for (J row = first; row < std::min(values->n, first + static_cast<J>(per_group)); ++row) rows.push_back(row);
+        groups.push_back(detail::take_rows(values, rows));
+    }
+    r0(values);
+
+    std::string sub_join = "{[g] l:0!(" + table1 + "); r:0!(" + table2 + "); " + body + "}";
+    std::vector<K> results(groups.size(), nullptr);
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    unsigned connections = options.connections ? options.connections : static_cast<unsigned>(groups.size());
+
+    setm(1);  // Workers deserialize symbols concurrently
+    auto worker = [&](unsigned id) {
+        const auto& [host, port] = options.endpoints[id % options.endpoints.size()];
+        I handle = connect(host, port);
+        if (handle <= 0) {
+            failed = true;
+        } else {
+            KDBConnection::bind_thread(handle);
+            for (size_t i; !failed && (i = next++) < groups.size();) {
+                K group = groups[i];
+                groups[i] = nullptr;
+                results[i] = inline_query(sub_join, {group}).get_result();
+                if (!results[i]) failed = true;
+            }
+            KDBConnection::bind_thread(0);
+            kclose(handle);
+        }
+        m9();
+    };
+    std::vector<std::thread> pool;
+    for (unsigned id = 0; id < std::min<size_t>(connections, groups.size()); ++id) pool.emplace_back(worker, id);
+    for (auto& thread : pool) thread.join();
+    for (K group : groups) {
+        if (group) r0(group);
     }
 
-    // Execute the as-of join
-    K result = detail::execute_join(aj_query, result_name, t1_unkeyed, t2_unkeyed + "_adj");
-
-    // Clean up the adjusted right table
-    inline_query("delete " + t2_unkeyed + "_adj from `.");
+    // Stage the sub-results on the main connection, then restore the left table's order
+    K handle_k = inline_query(".z.w").get_result();
+    std::string staging = std::string(SCRATCH_NAMESPACE) + ".w" + (handle_k ? std::to_string(handle_k->i) : "0") +
+                          "_partitioned";
+    if (handle_k) r0(handle_k);
+
+    bool staged = !failed && !results.empty();
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (staged) {
+            staged = upload_table(staging, results[i], i > 0);
+        } else if (results[i]) {
+            r0(results[i]);
+        }
+    }
+    if (!staged) {
+        std::cerr << "Partitioned as-of join failed." << std::endl;
+        inline_query(detail::delete_global(staging));
+        return JoinResult();
+    }
 
+    JoinResult result = detail::execute_join("delete kdbear_row from `kdbear_row xasc " + staging, result_name);
+    inline_query(detail::delete_global(staging));
     return result;
 }
 
@@ -230,30 +421,22 @@ K asof_join(const std::string& table1,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param join_columns A vector of column names to join on. If empty, a natural join is performed.
- * @return K The kdb+ object representing the joined table, or (K)0 if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  */
-K left_join(const std::string& table1,
-            const std::string& table2,
-            const std::string& result_name,
-            const std::vector<std::string>& join_columns) {
-    std::string t1_unkeyed, t2_unkeyed;
-    
-    if (!detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) return (K)0;
-
+JoinResult left_join(const std::string& table1,
+                     const std::string& table2,
+                     const std::string& result_name,
+                     const std::vector<std::string>& join_columns) {
     std::string query;
     if (!join_columns.empty()) {
-        std::string key_cols = join_columns[0];
-        for (size_t i = 1; i < join_columns.size(); ++i) {
-            key_cols += "`" + join_columns[i];
-        }
-        query = result_name + ": " + t1_unkeyed + " lj `" + key_cols + " xkey " + t2_unkeyed;
+        query = detail::group_keys("r", join_columns) + "l lj " + detail::key_list(join_columns) + " xkey r";
     } else {
-        query = result_name + ": " + t1_unkeyed + " lj (enlist first cols[" + t1_unkeyed +
-                "] inter cols[" + t2_unkeyed + "]) xkey " + t2_unkeyed;
+        query = "l lj (enlist first cols[l] inter cols[r]) xkey r";
     }
-    return detail::execute_join(query, result_name, t1_unkeyed, t2_unkeyed);
+    query = detail::join_expression(query, table1, table2);
+    return detail::execute_join(query, result_name);
 }
 
 /**
@@ -264,30 +447,22 @@ K left_join(const std::string& table1,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param join_columns A vector of column names to join on. If empty, a natural join is performed.
- * @return K The kdb+ object representing the joined table, or (K)0 if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  */
-K right_join(const std::string& table1,
-             const std::string& table2,
-             const std::string& result_name,
-             const std::vector<std::string>& join_columns) {
-    std::string t1_unkeyed, t2_unkeyed;
-    
-    if (!detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) return (K)0;
-
+JoinResult right_join(const std::string& table1,
+                      const std::string& table2,
+                      const std::string& result_name,
+                      const std::vector<std::string>& join_columns) {
     std::string query;
     if (!join_columns.empty()) {
-        std::string key_cols = join_columns[0];
-        for (size_t i = 1; i < join_columns.size(); ++i) {
-            key_cols += "`" + join_columns[i];
-        }
-        query = result_name + ": " + t2_unkeyed + " lj `" + key_cols + " xkey " + t1_unkeyed;
+        query = detail::group_keys("l", join_columns) + "r lj " + detail::key_list(join_columns) + " xkey l";
     } else {
-        query = result_name + ": " + t2_unkeyed + " lj (enlist first cols[" + t1_unkeyed +
-                "] inter cols[" + t2_unkeyed + "]) xkey " + t1_unkeyed;
+        query = "r lj (enlist first cols[l] inter cols[r]) xkey l";
     }
-    return detail::execute_join(query, result_name, t1_unkeyed, t2_unkeyed);
+    query = detail::join_expression(query, table1, table2);
+    return detail::execute_join(query, result_name);
 }
 
 /**
@@ -298,109 +473,116 @@ K right_join(const std::string& table1,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param time_column_left The name of the time column in the first table.
  * @param time_column_right The name of the time column in the second table.
- * @param window_size_seconds The size of the window (in seconds) for matching rows.
+ * @param window_size_seconds The size of the window (in seconds) on either side of each row.
  * @param join_columns A vector of column names to join on.
- * @return K The kdb+ object representing the joined table, or nullptr if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  */
-K window_join(const std::string& table1,
-              const std::string& table2,
-              const std::string& result_name,
-              const std::string& time_column_left,
-              const std::string& time_column_right,
-              double window_size_seconds,
-              const std::vector<std::string>& join_columns) {
-    // Prepare unkeyed versions of the input tables
-    std::string t1_unkeyed, t2_unkeyed;
-    if (!joins::detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) {
-        return nullptr;
-    }
+JoinResult window_join(const std::string& table1,
+                       const std::string& table2,
+                       const std::string& result_name,
+                       const std::string& time_column_left,
+                       const std::string& time_column_right,
+                       double window_size_seconds,
+                       const std::vector<std::string>& join_columns) {
+    auto window = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(window_size_seconds));
+    return window_join(table1, table2, result_name, time_column_left, time_column_right,
+                       window, window, join_columns);
+}
 
+/**
+ * @brief Performs a window join with explicit pre/post windows and aggregations.
+ *
+ * Each left row's window runs from `pre_window` before to `post_window`
+ * after its time. The windows are sent as nanosecond timespans and cast to
+ * the type of the left time column on the server, so they keep full
+ * precision for timestamps and timespans. Every aggregation is evaluated
+ * in the same `wj` call.
+ *
+ * @param table1 The name of the first table to join.
+ * @param table2 The name of the second table to join.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
+ * @param time_column_left The name of the time column in the first table.
+ * @param time_column_right The name of the time column in the second table.
+ * @param pre_window How far before each left time the window starts.
+ * @param post_window How far after each left time the window ends.
+ * @param join_columns A vector of column names to join on.
+ * @param aggregations Aggregations over each window; empty for `last` of every right column.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
+ */
+JoinResult window_join(const std::string& table1,
+                       const std::string& table2,
+                       const std::string& result_name,
+                       const std::string& time_column_left,
+                       const std::string& time_column_right,
+                       std::chrono::nanoseconds pre_window,
+                       std::chrono::nanoseconds post_window,
+                       const std::vector<std::string>& join_columns,
+                       const std::vector<WindowAggregation>& aggregations) {
     // Ensure that join columns are specified for window joins
     if (join_columns.empty()) {
         std::cerr << "Window joins require join columns to be specified." << std::endl;
-        joins::detail::cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
-    }
-
-    // Build key columns string including the time column
-    std::string key_cols;
-    for (size_t i = 0; i < join_columns.size(); ++i) {
-        if (i > 0) key_cols += ",";
-        key_cols += "`" + join_columns[i];
+        return JoinResult();
     }
-    key_cols += ",`" + time_column_left;
-
-    // Convert window size to q time literal format
-    int total_seconds = static_cast<int>(window_size_seconds);
-    int minutes = total_seconds / 60;
-    int seconds = total_seconds % 60;
-
-    // Format the window interval as time literals
-    std::ostringstream window_interval;
-    window_interval << "(-00:"
-                    << std::setfill('0') << std::setw(2) << minutes << ":"
-                    << std::setfill('0') << std::setw(2) << seconds << ".000 "
-                    << "00:"
-                    << std::setfill('0') << std::setw(2) << minutes << ":"
-                    << std::setfill('0') << std::setw(2) << seconds << ".000)";
-
-    // Create per-row window intervals by adding the window size to the left table's time column
-    std::string window_query = "window: " + window_interval.str() + " +\\: " +
-                               t1_unkeyed + "`" + time_column_left;
-
-    // Execute the window interval creation query
-    auto window_result = inline_query(window_query);
-    if (!bool(window_result)) {
-        std::cerr << "Failed to create window intervals." << std::endl;
-        joins::detail::cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
-    }
-
-    // Determine columns to include from the right table, excluding join and time columns
-    std::string exclude_cols = "`" + time_column_right;
-    for (const auto& col : join_columns) {
-        exclude_cols += "`" + col;
+    for (const auto& aggregation : aggregations) {
+        if (aggregation.function.empty() || aggregation.column.empty()) {
+            std::cerr << "Window join aggregations need a function and a column." << std::endl;
+            return JoinResult();
+        }
     }
 
-    // Retrieve the columns to include from the right table
-    std::string include_cols_query = "(cols " + t2_unkeyed + ") except " + exclude_cols;
-    auto include_cols_result = inline_query(include_cols_query);
-    if (!bool(include_cols_result)) {
-        std::cerr << "Failed to get columns from the right table." << std::endl;
-        joins::detail::cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
+    // wj matches on the left time column's name, so give the right table one if it differs
+    std::string query;
+    if (time_column_right != time_column_left) {
+        query += "r:update " + time_column_left + ":" + time_column_right + " from r; ";
     }
-    K include_cols_k = include_cols_result.get_result();
 
-    // Build the function-column pairs using 'last' to handle multiple matches within the window
-    std::string func_col_pairs = "(" + t2_unkeyed;
-    for (J i = 0; i < include_cols_k->n; ++i) {
-        S col_name = kS(include_cols_k)[i];
-        func_col_pairs += "; (last; `" + std::string(col_name) + ")";
-    }
-    func_col_pairs += ")";
+    // Window bounds in the time column's own type (timestamps and timespans take timespans as is)
+    query += "t:l`" + time_column_left + "; c:{$[(type x) in 12 16h;y;(type x)$y]}[t]; " +
+             "w:(t-c \"n\"$" + std::to_string(pre_window.count()) + ";t+c \"n\"$" +
+             std::to_string(post_window.count()) + "); ";
+    std::string match = detail::key_list(join_columns) + "`" + time_column_left;
 
-    // Release the reference to include_cols_k to prevent memory leaks
-    r0(include_cols_k);
+    // wj needs the right table sorted by the join columns and time, parted on the first key
+    query += "r:" + match + " xasc r; if[0<type r`" + join_columns.front() + "; r:@[r;`" +
+             join_columns.front() + ";`p#]]; ";
 
-    // Construct the window join query
-    std::string query = result_name + ": wj[window; " + key_cols + "; " + t1_unkeyed + "; " +
-                        func_col_pairs + "]";
+    if (aggregations.empty()) {
+        // `last` of every right column other than the join and time columns
+        query += "wj[w;" + match + ";l;(enlist r),{(last;x)} each cols[r] except " + match + "`" +
+                 time_column_right + "]";
+    } else {
+        // Each aggregate reads private copies of its columns, so its output lands in a
+        // fresh column whatever it is called, and is then renamed by position
+        std::string copies;
+        std::string specs;
+        std::string names;
+        for (size_t i = 0; i < aggregations.size(); ++i) {
+            const auto& aggregation = aggregations[i];
+            std::string value = "kdbear_v" + std::to_string(i);
+            copies += (i ? "," : "") + value + ":" + aggregation.column;
+            specs += ";(" + aggregation.function + ";";
+            if (!aggregation.weight_column.empty()) {
+                std::string weight = "kdbear_w" + std::to_string(i);
+                copies += "," + weight + ":" + aggregation.weight_column;
+                specs += "`" + weight;
+            }
+            specs += "`" + value + ")";
+            names += "`" + (aggregation.name.empty() ? aggregation.column : aggregation.name);
+        }
+        query += "r:update " + copies + " from r; " +
+                 "(cols[l]," + names + ") xcol wj[w;" + match + ";l;(r" + specs + ")]";
+    }
+    query = detail::join_expression(query, table1, table2);
 
-    // Execute the window join
-    K result = joins::detail::execute_join(query, result_name, t1_unkeyed, t2_unkeyed);
+    JoinResult result = detail::execute_join(query, result_name);
     if (!result) {
         std::cerr << "Window join execution failed." << std::endl;
-        joins::detail::cleanup_tables(t1_unkeyed, t2_unkeyed);
-        return nullptr;
+        return JoinResult();
     }
-
-    // Clean up the window variable from the kdb+ environment
-    inline_query("delete window from `.");
-
     return result;
 }
 
@@ -412,27 +594,20 @@ K window_join(const std::string& table1,
  *
  * @param table1 The name of the first table to join.
  * @param table2 The name of the second table to join.
- * @param result_name The name under which the joined table will be stored.
+ * @param result_name The name under which the joined table will be stored, or empty for a scratch name.
  * @param join_columns A vector of column names to join on. (Note: Union join typically doesn't require join columns.)
- * @return K The kdb+ object representing the joined table, or (K)0 if the join failed.
+ * @return JoinResult Handle to the joined table on the server; false if the join failed.
  *
  * Note: Tables should have matching column structures. If columns differ,
  * null values will be used for missing columns in either table.
  */
-K union_join(const std::string& table1,
-             const std::string& table2,
-             const std::string& result_name,
-             const std::vector<std::string>& join_columns) {
-    std::string t1_unkeyed, t2_unkeyed;
-    
-    // Prepare unkeyed versions of the input tables
-    if (!detail::prepare_tables(table1, table2, t1_unkeyed, t2_unkeyed)) return (K)0;
-
+JoinResult union_join(const std::string& table1,
+                      const std::string& table2,
+                      const std::string& result_name,
+                      const std::vector<std::string>& join_columns) {
     // Construct the union join query by appending the second table to the first
-    std::string query = result_name + ": " + t1_unkeyed + " uj " + t2_unkeyed;
-
-    // Execute the union join and handle cleanup
-    return detail::execute_join(query, result_name, t1_unkeyed, t2_unkeyed);
+    std::string query = detail::join_expression("l uj r", table1, table2);
+    return detail::execute_join(query, result_name);
 }
 
 } // namespace joins
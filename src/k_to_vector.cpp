@@ -79,6 +79,18 @@ std::optional<KValue> convert_k_value(K coldata, J idx) {
             return std::nullopt;
         }
         
+        // Timestamp type conversion
+        case KP: {
+            auto nanos = kJ(coldata)[idx];
+            if (nanos != nj) {
+                // Nanoseconds since 2000.01.01, kept at full precision
+                auto tp = std::chrono::sys_time<std::chrono::nanoseconds>(
+                    std::chrono::seconds(946684800) + std::chrono::nanoseconds(nanos));
+                return KValue{KTimestamp{tp}};
+            }
+            return std::nullopt;
+        }
+
         default:
             throw std::invalid_argument("Unsupported K type for conversion");
     }
@@ -0,0 +1,562 @@
+#include "local_joins.h"
+#include "type_map.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+/**
+ * @namespace joins
+ * @brief Contains functions related to performing various types of joins on kdb+ tables.
+ */
+namespace joins {
+
+namespace {
+
+/**
+ * @brief Runs `work(first, last)` over `[0, count)` in chunks claimed by a pool of threads.
+ *
+ * Chunks are claimed from a shared counter, so skewed work (e.g. one very
+ * large key) does not leave the other threads idle. `work` must not
+ * allocate K objects.
+ */
+void parallel_chunks(size_t count, size_t chunk, unsigned threads,
+                     const std::function<void(size_t, size_t)>& work) {
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t first; (first = next.fetch_add(chunk)) < count;) {
+            work(first, std::min(count, first + chunk));
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+}
+
+/**
+ * @brief Whether a column type can be used in a join key.
+ */
+bool is_key_type(int type) {
+    return type > 0 && type < 20 && element_size(type) > 0;
+}
+
+/**
+ * @brief Looks up the join key columns in both tables and checks their types agree.
+ */
+bool key_columns(K left, K right, const std::vector<std::string>& join_columns,
+                 std::vector<K>& left_keys, std::vector<K>& right_keys) {
+    for (const auto& name : join_columns) {
+        K l = detail::find_column(left, name);
+        K r = detail::find_column(right, name);
+        if (!l || !r) {
+            std::cerr << "Error: Join column '" << name << "' not found in both tables." << std::endl;
+            return false;
+        }
+        if (l->t != r->t || !is_key_type(l->t)) {
+            std::cerr << "Error: Join column '" << name << "' must have the same simple type in both tables." << std::endl;
+            return false;
+        }
+        left_keys.push_back(l);
+        right_keys.push_back(r);
+    }
+    return true;
+}
+
+/**
+ * @brief Row numbers grouped by key, in compressed form: group `g` holds
+ *        `rows[offsets[g]]` to `rows[offsets[g + 1] - 1]`.
+ */
+struct Groups {
+    std::vector<J> offsets;
+    std::vector<J> rows;
+};
+
+/**
+ * @brief Groups row numbers by a dense group id per row (-1 rows are dropped), keeping row order.
+ */
+Groups group_rows(const std::vector<J>& group_of_row, size_t group_count) {
+    Groups groups;
+    groups.offsets.assign(group_count + 1, 0);
+    for (J g : group_of_row) {
+        if (g >= 0) groups.offsets[g + 1]++;
+    }
+    for (size_t g = 0; g < group_count; ++g) groups.offsets[g + 1] += groups.offsets[g];
+    groups.rows.resize(groups.offsets[group_count]);
+    std::vector<J> fill(groups.offsets.begin(), groups.offsets.end() - 1);
+    for (size_t row = 0; row < group_of_row.size(); ++row) {
+        J g = group_of_row[row];
+        if (g >= 0) groups.rows[fill[g]++] = static_cast<J>(row);
+    }
+    return groups;
+}
+
+/**
+ * @brief Matches every left row to the last right row of its key at or before its time.
+ *
+ * @param matches Receives, per left row, the matched right row or -1.
+ */
+template <typename T>
+void match_asof(const T* left_time, const T* right_time,
+                Groups& left_groups, Groups& right_groups,
+                std::vector<J>& matches, unsigned threads) {
+    size_t group_count = right_groups.offsets.size() - 1;
+    auto by_time = [right_time](J a, J b) { return right_time[a] < right_time[b]; };
+
+    parallel_chunks(group_count, 64, threads, [&](size_t first, size_t last) {
+        for (size_t g = first; g < last; ++g) {
+            J* right_begin = right_groups.rows.data() + right_groups.offsets[g];
+            J* right_end = right_groups.rows.data() + right_groups.offsets[g + 1];
+            // Rows in table order are usually already in time order
+            if (!std::is_sorted(right_begin, right_end, by_time)) {
+                std::stable_sort(right_begin, right_end, by_time);
+            }
+
+            J* position = right_begin;  // First right row after the current left time
+            const T* previous = nullptr;
+            for (J i = left_groups.offsets[g]; i < left_groups.offsets[g + 1]; ++i) {
+                J row = left_groups.rows[i];
+                const T& time = left_time[row];
+                if (previous && !(time < *previous)) {
+                    while (position != right_end && !(time < right_time[*position])) ++position;
+                } else {
+                    position = std::upper_bound(right_begin, right_end, time,
+                                                [right_time](const T& t, J r) { return t < right_time[r]; });
+                }
+                previous = &time;
+                matches[row] = position == right_begin ? -1 : *(position - 1);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Dispatches `match_asof` on the element type of the time columns.
+ */
+bool match_asof_typed(K left_time, K right_time, Groups& left_groups, Groups& right_groups,
+                      std::vector<J>& matches, unsigned threads) {
+    switch (left_time->t) {
+        case KH:
+            match_asof(kH(left_time), kH(right_time), left_groups, right_groups, matches, threads);
+            return true;
+        case KI: case KD: case KM: case KU: case KV: case KT:
+            match_asof(kI(left_time), kI(right_time), left_groups, right_groups, matches, threads);
+            return true;
+        case KJ: case KP: case KN:
+            match_asof(kJ(left_time), kJ(right_time), left_groups, right_groups, matches, threads);
+            return true;
+        case KE:
+            match_asof(kE(left_time), kE(right_time), left_groups, right_groups, matches, threads);
+            return true;
+        case KF: case KZ:
+            match_asof(kF(left_time), kF(right_time), left_groups, right_groups, matches, threads);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Columns of `right` other than the given key (and time) columns, by name.
+ */
+std::vector<std::pair<std::string, K>> right_columns_except(K right,
+                                                            const std::vector<std::string>& join_columns,
+                                                            const std::string& time_column = "") {
+    std::vector<std::pair<std::string, K>> columns;
+    K names = kK(right->k)[0];
+    for (J c = 0; c < names->n; ++c) {
+        std::string name = kS(names)[c];
+        if (name == time_column ||
+            std::find(join_columns.begin(), join_columns.end(), name) != join_columns.end()) continue;
+        columns.emplace_back(name, kK(kK(right->k)[1])[c]);
+    }
+    return columns;
+}
+
+/**
+ * @brief Builds a join result from the left table and the matched right columns.
+ *
+ * Left columns are shared with `left` when every left row is kept, and
+ * gathered through `kept` otherwise. Each addition takes the value of its
+ * matched right row; a column that also exists on the left keeps the left
+ * value where there is no match, others become null.
+ *
+ * @param left Left table.
+ * @param kept Left rows to keep, in order, or nullptr for all of them.
+ * @param additions Right columns to add, by name.
+ * @param matches Matched right row (or -1) for each result row.
+ * @return K The joined table, or nullptr if a shared column's types differ.
+ */
+K assemble(K left, const std::vector<J>* kept,
+           const std::vector<std::pair<std::string, K>>& additions,
+           const std::vector<J>& matches) {
+    for (const auto& [name, column] : additions) {
+        K existing = detail::find_column(left, name);
+        if (existing && existing->t != column->t) {
+            std::cerr << "Error: Column '" << name << "' has different types in the two tables." << std::endl;
+            return nullptr;
+        }
+    }
+
+    K left_names = kK(left->k)[0];
+    std::vector<std::string> names;
+    std::vector<K> columns;
+    for (J c = 0; c < left_names->n; ++c) {
+        K column = kK(kK(left->k)[1])[c];
+        names.emplace_back(kS(left_names)[c]);
+        columns.push_back(kept ? detail::take_rows(column, *kept) : r1(column));
+    }
+    for (const auto& [name, column] : additions) {
+        auto existing = std::find(names.begin(), names.end(), name);
+        if (existing == names.end()) {
+            names.push_back(name);
+            columns.push_back(detail::take_rows(column, matches));
+        } else {
+            K& slot = columns[existing - names.begin()];
+            K merged = detail::take_rows(column, matches, slot);
+            r0(slot);
+            slot = merged;
+        }
+    }
+
+    K name_list = ktn(KS, static_cast<J>(names.size()));
+    K value_list = ktn(0, static_cast<J>(columns.size()));
+    for (size_t c = 0; c < names.size(); ++c) {
+        kS(name_list)[c] = ss(const_cast<S>(names[c].c_str()));
+        kK(value_list)[c] = columns[c];
+    }
+    return xT(xD(name_list, value_list));
+}
+
+inline uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+}  // namespace
+
+/**
+ * @namespace detail
+ * @brief Provides internal helper functions for join operations.
+ */
+namespace detail {
+
+/**
+ * @brief Hashes the key of one row across several columns.
+ *
+ * Symbols are hashed by content, other types by their element bytes.
+ */
+uint64_t hash_row(const std::vector<K>& columns, J row) {
+    uint64_t h = 0;
+    for (K column : columns) {
+        if (column->t == KS) {
+            h = mix(h, std::hash<std::string_view>()(kS(column)[row]));
+            continue;
+        }
+        size_t width = element_size(column->t);
+        const unsigned char* element = kG(column) + row * width;
+        for (size_t offset = 0; offset < width; offset += sizeof(uint64_t)) {
+            uint64_t bits = 0;
+            std::memcpy(&bits, element + offset, std::min(width - offset, sizeof(uint64_t)));
+            h = mix(h, bits);
+        }
+    }
+    // Final avalanche so the low bits used for slot selection depend on every input bit
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Compares the keys of two rows, column by column.
+ */
+bool rows_equal(const std::vector<K>& a, J row_a, const std::vector<K>& b, J row_b) {
+    for (size_t c = 0; c < a.size(); ++c) {
+        if (a[c]->t == KS) {
+            S x = kS(a[c])[row_a];
+            S y = kS(b[c])[row_b];
+            if (x != y && std::strcmp(x, y) != 0) return false;
+            continue;
+        }
+        size_t width = element_size(a[c]->t);
+        if (std::memcmp(kG(a[c]) + row_a * width, kG(b[c]) + row_b * width, width) != 0) return false;
+    }
+    return true;
+}
+
+RowIndex::RowIndex(std::vector<K> columns, size_t expected_rows) : columns_(std::move(columns)) {
+    size_t capacity = 16;
+    while (capacity < expected_rows * 2) capacity <<= 1;
+    slots_.assign(capacity, Slot{0, -1});
+    mask_ = capacity - 1;
+}
+
+J RowIndex::insert(J row) {
+    return insert(row, hash_row(columns_, row));
+}
+
+J RowIndex::insert(J row, uint64_t hash) {
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+        Slot& slot = slots_[i];
+        if (slot.row < 0) {
+            slot = Slot{hash, row};
+            return row;
+        }
+        if (slot.hash == hash && rows_equal(columns_, slot.row, columns_, row)) return slot.row;
+    }
+}
+
+J RowIndex::find(const std::vector<K>& probe_columns, J row) const {
+    return find(probe_columns, row, hash_row(probe_columns, row));
+}
+
+J RowIndex::find(const std::vector<K>& probe_columns, J row, uint64_t hash) const {
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+        const Slot& slot = slots_[i];
+        if (slot.row < 0) return -1;
+        if (slot.hash == hash && rows_equal(columns_, slot.row, probe_columns, row)) return slot.row;
+    }
+}
+
+/**
+ * @brief Finds a column of an unkeyed table by name.
+ *
+ * @return K The column vector (not a new reference), or nullptr if absent.
+ */
+K find_column(K table, const std::string& name) {
+    K names = kK(table->k)[0];
+    for (J i = 0; i < names->n; ++i) {
+        if (name == kS(names)[i]) return kK(kK(table->k)[1])[i];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Gathers rows of a column into a new column.
+ *
+ * Row `i` of the result is `column[rows[i]]`, or for `rows[i] < 0` the
+ * value of `fallback` at `i` if given, else the type's null.
+ *
+ * @param column Source column.
+ * @param rows Row of `column` for each result row, or -1.
+ * @param fallback Column of the same type with one value per result row, or nullptr.
+ * @return K The new column, owned by the caller.
+ */
+K take_rows(K column, const std::vector<J>& rows, K fallback) {
+    J count = static_cast<J>(rows.size());
+    if (column->t == 0) {
+        K out = ktn(0, count);
+        for (J i = 0; i < count; ++i) {
+            K item = rows[i] >= 0 ? kK(column)[rows[i]] : fallback ? kK(fallback)[i] : nullptr;
+            kK(out)[i] = item ? r1(item) : ktn(KC, 0);  // Null of a string column
+        }
+        return out;
+    }
+
+    size_t width = element_size(column->t);
+    bool has_null = find_type_info(column->t) != nullptr;
+    K out = ktn(column->t, count);
+    for (J i = 0; i < count; ++i) {
+        unsigned char* target = kG(out) + i * width;
+        if (rows[i] >= 0) {
+            std::memcpy(target, kG(column) + rows[i] * width, width);
+        } else if (fallback) {
+            std::memcpy(target, kG(fallback) + i * width, width);
+        } else if (has_null) {
+            assign_null_value(out, i);
+        } else {
+            std::memset(target, 0, width);  // e.g. the null guid
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Number of threads to use for `work_items` independent pieces of work.
+ */
+unsigned worker_count(unsigned requested, size_t work_items) {
+    unsigned threads = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, work_items)));
+}
+
+}  // namespace detail
+
+namespace {
+
+/**
+ * @brief Matches every left row to the first right row with the same key.
+ *
+ * Right row hashes are computed in parallel and the rows split by the top
+ * bits of their hash into one partition per thread, each indexed by its own
+ * thread in an open-addressing table. Left rows are then hashed and probed
+ * in parallel chunks against the partition their hash selects.
+ *
+ * @return std::vector<J> The matched right row, or -1, for each left row.
+ */
+std::vector<J> match_keys(const std::vector<K>& left_keys, const std::vector<K>& right_keys,
+                          J left_rows, J right_rows, unsigned requested_threads) {
+    const size_t chunk = 4096;
+    unsigned threads = detail::worker_count(requested_threads, static_cast<size_t>(right_rows) / chunk + 1);
+    int bits = 0;
+    while ((1u << bits) < threads) ++bits;
+    size_t partition_count = size_t(1) << bits;
+    auto partition_of = [bits](uint64_t hash) { return bits ? static_cast<size_t>(hash >> (64 - bits)) : 0; };
+
+    std::vector<uint64_t> right_hashes(right_rows);
+    parallel_chunks(static_cast<size_t>(right_rows), chunk, threads, [&](size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) right_hashes[row] = detail::hash_row(right_keys, static_cast<J>(row));
+    });
+
+    // Rows of each partition in table order, so the first of a repeated key wins as with xkey
+    std::vector<J> partition_of_row(right_rows);
+    for (J row = 0; row < right_rows; ++row) partition_of_row[row] = static_cast<J>(partition_of(right_hashes[row]));
+    Groups partitions = group_rows(partition_of_row, partition_count);
+
+    std::vector<detail::RowIndex> indexes;
+    indexes.reserve(partition_count);
+    for (size_t p = 0; p < partition_count; ++p) {
+        indexes.emplace_back(right_keys, static_cast<size_t>(partitions.offsets[p + 1] - partitions.offsets[p]));
+    }
+    parallel_chunks(partition_count, 1, threads, [&](size_t first, size_t last) {
+        for (size_t p = first; p < last; ++p) {
+            for (J i = partitions.offsets[p]; i < partitions.offsets[p + 1]; ++i) {
+                J row = partitions.rows[i];
+                indexes[p].insert(row, right_hashes[row]);
+            }
+        }
+    });
+
+    std::vector<J> matches(left_rows);
+    threads = detail::worker_count(requested_threads, static_cast<size_t>(left_rows) / chunk + 1);
+    parallel_chunks(static_cast<size_t>(left_rows), chunk, threads, [&](size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            uint64_t hash = detail::hash_row(left_keys, static_cast<J>(row));
+            matches[row] = indexes[partition_of(hash)].find(left_keys, static_cast<J>(row), hash);
+        }
+    });
+    return matches;
+}
+
+/**
+ * @brief Key-matching join of `left` against `right`, keeping unmatched left rows or not.
+ */
+K hash_join(K left, K right, const std::vector<std::string>& join_columns, bool keep_unmatched,
+            const LocalJoinOptions& options) {
+    if (!left || !right || left->t != XT || right->t != XT) {
+        std::cerr << "Error: Local joins need two unkeyed tables." << std::endl;
+        return nullptr;
+    }
+
+    // As on the server, a natural join uses the first column the tables share
+    std::vector<std::string> keys = join_columns;
+    if (keys.empty()) {
+        K left_names = kK(left->k)[0];
+        for (J c = 0; c < left_names->n && keys.empty(); ++c) {
+            if (detail::find_column(right, kS(left_names)[c])) keys.emplace_back(kS(left_names)[c]);
+        }
+        if (keys.empty()) {
+            std::cerr << "Error: The tables have no column in common to join on." << std::endl;
+            return nullptr;
+        }
+    }
+
+    std::vector<K> left_keys, right_keys;
+    if (!key_columns(left, right, keys, left_keys, right_keys)) return nullptr;
+
+    J left_rows = left_keys[0]->n;
+    J right_rows = right_keys[0]->n;
+    std::vector<J> matches = match_keys(left_keys, right_keys, left_rows, right_rows, options.threads);
+
+    auto additions = right_columns_except(right, keys);
+    if (keep_unmatched) return assemble(left, nullptr, additions, matches);
+
+    std::vector<J> kept;
+    std::vector<J> kept_matches;
+    for (J row = 0; row < left_rows; ++row) {
+        if (matches[row] < 0) continue;
+        kept.push_back(row);
+        kept_matches.push_back(matches[row]);
+    }
+    return assemble(left, &kept, additions, kept_matches);
+}
+
+}  // namespace
+
+K local_inner_join(K left, K right, const std::vector<std::string>& join_columns, const LocalJoinOptions& options) {
+    return hash_join(left, right, join_columns, false, options);
+}
+
+K local_left_join(K left, K right, const std::vector<std::string>& join_columns, const LocalJoinOptions& options) {
+    return hash_join(left, right, join_columns, true, options);
+}
+
+K local_right_join(K left, K right, const std::vector<std::string>& join_columns, const LocalJoinOptions& options) {
+    return hash_join(right, left, join_columns, true, options);
+}
+
+K local_asof_join(K left,
+                  K right,
+                  const std::string& time_column_left,
+                  const std::string& time_column_right,
+                  const std::vector<std::string>& join_columns,
+                  const LocalJoinOptions& options) {
+    if (!left || !right || left->t != XT || right->t != XT) {
+        std::cerr << "Error: Local joins need two unkeyed tables." << std::endl;
+        return nullptr;
+    }
+
+    std::vector<K> left_keys, right_keys;
+    if (!key_columns(left, right, join_columns, left_keys, right_keys)) return nullptr;
+
+    K left_time = detail::find_column(left, time_column_left);
+    K right_time = detail::find_column(right, time_column_right);
+    if (!left_time || !right_time || left_time->t != right_time->t) {
+        std::cerr << "Error: Time columns '" << time_column_left << "' and '" << time_column_right
+                  << "' must exist and have the same type." << std::endl;
+        return nullptr;
+    }
+
+    J left_rows = left_time->n;
+    J right_rows = right_time->n;
+
+    // Partition right rows by key: each distinct key gets a dense group id
+    detail::RowIndex index(right_keys, static_cast<size_t>(right_rows));
+    std::vector<J> dense_of_first(right_rows, -1);
+    std::vector<J> right_group(right_rows);
+    size_t group_count = 0;
+    for (J row = 0; row < right_rows; ++row) {
+        J first = index.insert(row);
+        if (dense_of_first[first] < 0) dense_of_first[first] = static_cast<J>(group_count++);
+        right_group[row] = dense_of_first[first];
+    }
+
+    // Probe left rows in parallel; rows whose key is absent from the right side never match
+    unsigned threads = detail::worker_count(options.threads, static_cast<size_t>(left_rows) / 4096 + 1);
+    std::vector<J> left_group(left_rows);
+    parallel_chunks(static_cast<size_t>(left_rows), 4096, threads, [&](size_t first, size_t last) {
+        for (size_t row = first; row < last; ++row) {
+            J match = index.find(left_keys, static_cast<J>(row));
+            left_group[row] = match < 0 ? -1 : dense_of_first[match];
+        }
+    });
+
+    Groups right_groups = group_rows(right_group, group_count);
+    Groups left_groups = group_rows(left_group, group_count);
+    std::vector<J> matches(left_rows, -1);
+    threads = detail::worker_count(options.threads, group_count);
+    if (!match_asof_typed(left_time, right_time, left_groups, right_groups, matches, threads)) {
+        std::cerr << "Error: Time column '" << time_column_left << "' must be numeric or temporal." << std::endl;
+        return nullptr;
+    }
+
+    // Right columns to add: everything but the keys and time, plus the matched time
+    auto additions = right_columns_except(right, join_columns, time_column_right);
+    additions.emplace_back(time_column_right + "2", right_time);
+    return assemble(left, nullptr, additions, matches);
+}
+
+}  // namespace joins
@@ -1,8 +1,9 @@
 #include "make_table.h"
+#include "symbol_cache.h"
+#include <cstring>
 #include <iostream>
-#include <sstream>
-#include <iomanip>
-#include "inline_query.h"
+#include <type_traits>
+#include "table_builder.h"
 
 /**
  * @brief Creates a KDB+ table with the specified name, columns, and data
@@ -13,9 +14,8 @@
  * @return bool True if table creation succeeds, false otherwise
  * @throws Does not throw exceptions, failures are returned as false
  *
- * @note Column names should not contain spaces or special characters
- * @note String values containing backticks (`) are automatically escaped
- * @note Numeric values maintain precision up to 15 decimal places
+ * @note The table is built on the client with build_table and sent in a single
+ *       `set` call, so no q source is generated and values are never reparsed
  */
 bool make_table(const std::string& table_name,
                const std::vector<std::string>& column_names,
@@ -26,74 +26,261 @@ bool make_table(const std::string& table_name,
         return false;
     }
 
-    size_t num_columns = column_names.size(); ///< Number of columns in the table
-    size_t num_rows = data.size();            ///< Number of rows in the table
+    K table = build_table(column_names, data);
+    if (!table) return false;
+    return upload_table(table_name, table, false);
+}
+
+namespace {
+
+constexpr I KDB_EPOCH_DAYS = 10957;                        ///< Days from 1970.01.01 to 2000.01.01
+constexpr J KDB_EPOCH_NANOS = 946684800000000000LL;        ///< Nanoseconds from 1970.01.01 to 2000.01.01
+
+using Timestamp = std::chrono::sys_time<std::chrono::nanoseconds>;
+
+/**
+ * @brief Index of alternative `T` in KDBType
+ */
+template <typename T, size_t Index = 0>
+constexpr size_t alternative() {
+    if constexpr (std::is_same_v<std::variant_alternative_t<Index, KDBType>, T>) return Index;
+    else return alternative<T, Index + 1>();
+}
+
+template <typename T>
+constexpr size_t BIT = size_t(1) << alternative<T>();
+
+constexpr size_t INTEGERS = BIT<int> | BIT<int64_t>;
+constexpr size_t NUMBERS = INTEGERS | BIT<float> | BIT<double>;
+
+/**
+ * @brief Vector type for a column holding the alternatives flagged in `seen`
+ *
+ * @param seen Bit per variant index of the non-null values
+ * @return I Type code, 0 for a general list
+ */
+I column_type(size_t seen) {
+    if (seen == 0) return KF;  // All-null columns default to float
+    if (seen == BIT<bool>) return KB;
+    if ((seen & ~INTEGERS) == 0) return KJ;
+    if (seen == BIT<float>) return KE;
+    if ((seen & ~NUMBERS) == 0) return KF;
+    if (seen == BIT<std::string>) return KS;
+    if (seen == BIT<Timestamp>) return KP;
+    if (seen == BIT<std::chrono::sys_days>) return KD;
+    if (seen == BIT<std::chrono::nanoseconds>) return KN;
+    if (seen == BIT<Guid>) return UU;
+    return 0;  // Char strings, or alternatives that do not share a vector type
+}
+
+/**
+ * @brief The held arithmetic alternative converted to `Result`
+ */
+template <typename Result>
+Result number(const KDBType& value) {
+    return std::visit([](const auto& held) -> Result {
+        if constexpr (std::is_arithmetic_v<std::decay_t<decltype(held)>>) return static_cast<Result>(held);
+        else return Result();
+    }, value);
+}
+
+/**
+ * @brief Converts one variant to a K atom (or char vector), `::` for std::monostate
+ */
+K make_atom(const KDBType& value) {
+    return std::visit([](const auto& held) -> K {
+        using T = std::decay_t<decltype(held)>;
+        if constexpr (std::is_same_v<T, bool>) return kb(held);
+        else if constexpr (std::is_same_v<T, int> || std::is_same_v<T, int64_t>) return kj(held);
+        else if constexpr (std::is_same_v<T, float>) return ke(held);
+        else if constexpr (std::is_same_v<T, double>) return kf(held);
+        else if constexpr (std::is_same_v<T, std::string>) return ks(intern_symbol(held));
+        else if constexpr (std::is_same_v<T, Timestamp>) {
+            return ktj(-KP, held.time_since_epoch().count() - KDB_EPOCH_NANOS);
+        } else if constexpr (std::is_same_v<T, std::chrono::sys_days>) {
+            return kd(static_cast<I>(held.time_since_epoch().count() - KDB_EPOCH_DAYS));
+        } else if constexpr (std::is_same_v<T, std::chrono::nanoseconds>) return ktj(-KN, held.count());
+        else if constexpr (std::is_same_v<T, CharString>) {
+            return kpn(const_cast<S>(held.text.data()), static_cast<J>(held.text.size()));
+        } else if constexpr (std::is_same_v<T, Guid>) {
+            U guid;
+            std::memcpy(guid.g, held.bytes.data(), sizeof(guid.g));
+            return ku(guid);
+        } else {
+            K null = ka(101);
+            null->g = 0;
+            return null;
+        }
+    }, value);
+}
+
+/**
+ * @brief kdb+ type of a column element stored with the same bytes
+ */
+template <typename T>
+constexpr I plain_type() {
+    if constexpr (std::is_same_v<T, uint8_t>) return KG;
+    else if constexpr (std::is_same_v<T, int16_t>) return KH;
+    else if constexpr (std::is_same_v<T, int32_t>) return KI;
+    else if constexpr (std::is_same_v<T, int64_t>) return KJ;
+    else if constexpr (std::is_same_v<T, float>) return KE;
+    else {
+        static_assert(std::is_same_v<T, double>, "Unhandled column element type");
+        return KF;
+    }
+}
 
-    // Ensure that each row has the correct number of columns
+/**
+ * @brief Copies a column into a new K vector and frees the source
+ */
+K make_vector(ColumnValues& values) {
+    return std::visit([](auto& source) -> K {
+        using Vector = std::decay_t<decltype(source)>;
+        using T = typename Vector::value_type;
+        J count = static_cast<J>(source.size());
+        K vec;
+        if constexpr (std::is_same_v<T, bool>) {
+            vec = ktn(KB, count);
+            for (J i = 0; i < count; ++i) kG(vec)[i] = source[i];
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            vec = ktn(KS, count);
+            intern_symbols(source, kS(vec));
+        } else if constexpr (std::is_same_v<T, std::chrono::sys_days>) {
+            vec = ktn(KD, count);
+            for (J i = 0; i < count; ++i) {
+                kI(vec)[i] = static_cast<I>(source[i].time_since_epoch().count() - KDB_EPOCH_DAYS);
+            }
+        } else if constexpr (std::is_same_v<T, Timestamp>) {
+            vec = ktn(KP, count);
+            for (J i = 0; i < count; ++i) kJ(vec)[i] = source[i].time_since_epoch().count() - KDB_EPOCH_NANOS;
+        } else {
+            vec = ktn(plain_type<T>(), count);
+            if (count) std::memcpy(kG(vec), source.data(), count * sizeof(T));
+        }
+        Vector().swap(source);
+        return vec;
+    }, values);
+}
+
+}  // namespace
+
+/**
+ * @brief Builds a typed kdb+ table from row-oriented variant data
+ *
+ * @param column_names Vector of column names
+ * @param data 2D vector where data[i][j] is the value for row i, column j
+ * @return K Table owned by the caller, or nullptr on invalid input
+ */
+K build_table(const std::vector<std::string>& column_names,
+              const std::vector<std::vector<KDBType>>& data) {
+    size_t num_columns = column_names.size();
+    size_t num_rows = data.size();
+    if (num_columns == 0) {
+        std::cerr << "Column names are empty" << std::endl;
+        return nullptr;
+    }
     for (size_t row = 0; row < num_rows; ++row) {
         if (data[row].size() != num_columns) {
             std::cerr << "Row " << row << " does not have the correct number of columns" << std::endl;
-            return false;
+            return nullptr;
         }
     }
 
-    // Build the q-sql command string to create the table
-    std::ostringstream q_command;
-    q_command << table_name << ": ([] "; ///< Start constructing the table with column definitions
-
-    // Iterate over each column to define its data
+    // Pick each column's type from the alternatives it holds
+    std::vector<I> types(num_columns);
+    std::vector<bool> char_strings(num_columns);
     for (size_t col = 0; col < num_columns; ++col) {
-        if (col > 0) q_command << "; "; ///< Separate columns with a semicolon
-        q_command << column_names[col] << ":"; ///< Define the column name
-
-        // Handle single-row data with special formatting
-        if (num_rows == 1) {
-            const KDBType& value = data[0][col]; ///< Retrieve the value for the single row
-            if (std::holds_alternative<std::monostate>(value)) {
-                q_command << "enlist ::"; ///< Represent null values
-            } else if (std::holds_alternative<bool>(value)) {
-                q_command << "enlist " << (std::get<bool>(value) ? "1b" : "0b"); ///< Represent boolean values
-            } else if (std::holds_alternative<int>(value)) {
-                q_command << "enlist " << std::get<int>(value); ///< Represent integer values
-            } else if (std::holds_alternative<double>(value)) {
-                q_command << "enlist " << std::setprecision(15) << std::get<double>(value); ///< Represent double values with high precision
-            } else if (std::holds_alternative<std::string>(value)) {
-                std::string str = std::get<std::string>(value);
-                q_command << "enlist `" << str; ///< Represent string values as symbols
+        size_t seen = 0;  // Bit per alternative index
+        for (size_t row = 0; row < num_rows; ++row) {
+            if (!std::holds_alternative<std::monostate>(data[row][col])) {
+                seen |= size_t(1) << data[row][col].index();
             }
-        } else {
-            // Handle multiple rows by constructing a list of values for the column
-            q_command << "(";
-            for (size_t row = 0; row < num_rows; ++row) {
-                if (row > 0) q_command << ";"; ///< Separate values with a semicolon
-                const KDBType& value = data[row][col]; ///< Retrieve the value for the current row
-
-                if (std::holds_alternative<std::monostate>(value)) {
-                    q_command << "::"; ///< Represent null values
-                } else if (std::holds_alternative<bool>(value)) {
-                    q_command << (std::get<bool>(value) ? "1b" : "0b"); ///< Represent boolean values
-                } else if (std::holds_alternative<int>(value)) {
-                    q_command << std::get<int>(value); ///< Represent integer values
-                } else if (std::holds_alternative<double>(value)) {
-                    q_command << std::setprecision(15) << std::get<double>(value); ///< Represent double values with high precision
-                } else if (std::holds_alternative<std::string>(value)) {
-                    std::string str = std::get<std::string>(value);
-                    // Escape backticks in strings to prevent syntax errors in q-sql
-                    size_t pos = 0;
-                    while ((pos = str.find('`', pos)) != std::string::npos) {
-                        str.insert(pos, "`");
-                        pos += 2; ///< Move past the escaped backtick
-                    }
-                    q_command << "`" << str; ///< Represent string values as escaped symbols
-                }
+        }
+        types[col] = column_type(seen);
+        char_strings[col] = seen == BIT<CharString>;
+    }
+
+    K names = ktn(KS, static_cast<J>(num_columns));
+    K columns = ktn(0, static_cast<J>(num_columns));
+    for (size_t col = 0; col < num_columns; ++col) {
+        kS(names)[col] = ss(const_cast<S>(column_names[col].c_str()));
+        K vec = ktn(types[col], static_cast<J>(num_rows));
+        for (size_t row = 0; row < num_rows; ++row) {
+            const KDBType& value = data[row][col];
+            bool null = std::holds_alternative<std::monostate>(value);
+            switch (types[col]) {
+                case KB: kG(vec)[row] = !null && std::get<bool>(value); break;
+                case KJ: kJ(vec)[row] = null ? nj : number<J>(value); break;
+                case KE: kE(vec)[row] = null ? static_cast<E>(nf) : std::get<float>(value); break;
+                case KF: kF(vec)[row] = null ? nf : number<F>(value); break;
+                case KS:
+                    kS(vec)[row] = intern_symbol(null ? std::string_view() : std::get<std::string>(value));
+                    break;
+                case KP:
+                    kJ(vec)[row] = null ? nj : std::get<Timestamp>(value).time_since_epoch().count() - KDB_EPOCH_NANOS;
+                    break;
+                case KD:
+                    kI(vec)[row] = null ? ni : static_cast<I>(
+                        std::get<std::chrono::sys_days>(value).time_since_epoch().count() - KDB_EPOCH_DAYS);
+                    break;
+                case KN: kJ(vec)[row] = null ? nj : std::get<std::chrono::nanoseconds>(value).count(); break;
+                case UU:
+                    kU(vec)[row] = U{};  // The null GUID is all zeros
+                    if (!null) std::memcpy(kU(vec)[row].g, std::get<Guid>(value).bytes.data(), 16);
+                    break;
+                case 0:
+                    // A string column keeps nulls as empty strings so every item is a char vector
+                    kK(vec)[row] = null && char_strings[col] ? kpn(const_cast<S>(""), 0) : make_atom(value);
+                    break;
             }
-            q_command << ")"; ///< Close the list of values for the column
         }
+        kK(columns)[col] = vec;
     }
+    return xT(xD(names, columns));
+}
 
-    q_command << ")"; ///< Close the table definition
+/**
+ * @brief Creates a KDB+ table from whole columns
+ *
+ * @param table_name Name of the table to create
+ * @param columns Named columns of equal length, moved in
+ * @return bool True if table creation succeeds, false otherwise
+ */
+bool make_table(const std::string& table_name, std::vector<TableColumn>&& columns) {
+    K table = build_table(std::move(columns));
+    if (!table) return false;
+    return upload_table(table_name, table, false);
+}
 
-    // Execute the constructed q-sql command using the inline_query function
-    auto result = inline_query(q_command.str());
-    return bool(result); ///< Return the success status of the table creation
+/**
+ * @brief Builds a typed kdb+ table from whole columns
+ *
+ * @param columns Named columns of equal length, released as they are copied
+ * @return K Table owned by the caller, or nullptr on invalid input
+ */
+K build_table(std::vector<TableColumn>&& columns) {
+    if (columns.empty()) {
+        std::cerr << "Column names are empty" << std::endl;
+        return nullptr;
+    }
+    auto length = [](const TableColumn& column) {
+        return std::visit([](const auto& values) { return values.size(); }, column.values);
+    };
+    size_t num_rows = length(columns[0]);
+    for (const auto& column : columns) {
+        if (length(column) != num_rows) {
+            std::cerr << "Column " << column.name << " has " << length(column)
+                      << " rows, expected " << num_rows << std::endl;
+            return nullptr;
+        }
+    }
+
+    K names = ktn(KS, static_cast<J>(columns.size()));
+    K values = ktn(0, static_cast<J>(columns.size()));
+    for (size_t col = 0; col < columns.size(); ++col) {
+        kS(names)[col] = ss(const_cast<S>(columns[col].name.c_str()));
+        kK(values)[col] = make_vector(columns[col].values);
+    }
+    columns.clear();
+    return xT(xD(names, values));
 }
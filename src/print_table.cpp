@@ -5,6 +5,7 @@
 #include <string>
 #include <iomanip>
 #include <numeric>
+#include "splayed_reader.h"
 #include "type_map.h"
 
 namespace {  // Anonymous namespace for internal helper functions
@@ -134,6 +135,28 @@ void print_row(K table, J row_idx, const std::vector<size_t>& widths) {
     }
 }
 
+/**
+ * @brief Prints the metadata line, header and `count` rows starting at `first`
+ *
+ * Column widths are measured over the whole of `table`; the splayed overloads
+ * pass a slice holding only the rows to show.
+ */
+void print_rows(K table, J first, J count, const std::string& title) {
+    auto widths = calculate_widths(table);
+    K colvalues = kK(table->k)[1];
+
+    std::cout << title << " rows × " << colvalues->n << " columns]:" << std::endl;
+
+    print_separator_table(widths);
+    print_table_header(table, widths);
+    print_separator_table(widths);
+
+    for (J row = first; row < first + count; ++row) {
+        print_row(table, row, widths);
+    }
+    print_separator_table(widths);
+}
+
 } // end anonymous namespace
 
 /**
@@ -149,25 +172,10 @@ void print_head(K table, int n) {
     if (!table || table->t == -128) return;
 
     if (table->t == XT) {
-        auto widths = calculate_widths(table);
-        K dict = table->k;
-        K colvalues = kK(dict)[1];
-        J row_count = kK(colvalues)[0]->n;
+        J row_count = kK(kK(table->k)[1])[0]->n;
         n = std::min((J)n, row_count);
-
-        // Print table metadata
-        std::cout << "Table Head [" << n << " of " << row_count << " rows × "
-                 << colvalues->n << " columns]:" << std::endl;
-        
-        // Print formatted table
-        print_separator_table(widths);
-        print_table_header(table, widths);
-        print_separator_table(widths);
-
-        for (J row = 0; row < n; ++row) {
-            print_row(table, row, widths);
-        }
-        print_separator_table(widths);
+        print_rows(table, 0, n,
+                   "Table Head [" + std::to_string(n) + " of " + std::to_string(row_count));
     }
 }
 
@@ -184,24 +192,43 @@ void print_tail(K table, int n) {
     if (!table || table->t == -128) return;
 
     if (table->t == XT) {
-        auto widths = calculate_widths(table);
-        K dict = table->k;
-        K colvalues = kK(dict)[1];
-        J row_count = kK(colvalues)[0]->n;
+        J row_count = kK(kK(table->k)[1])[0]->n;
         n = std::min((J)n, row_count);
+        print_rows(table, row_count - n, n,
+                   "Table Tail [last " + std::to_string(n) + " of " + std::to_string(row_count));
+    }
+}
 
-        // Print table metadata
-        std::cout << "Table Tail [last " << n << " of " << row_count << " rows × "
-                 << colvalues->n << " columns]:" << std::endl;
-        
-        // Print formatted table
-        print_separator_table(widths);
-        print_table_header(table, widths);
-        print_separator_table(widths);
+/**
+ * @brief Prints the first n rows of a splayed table on disk
+ *
+ * Only those rows are copied out of the mapped column files.
+ *
+ * @param table Open splayed table
+ * @param n Number of rows to print (default: 5)
+ */
+void print_head(const SplayedTable& table, int n) {
+    J row_count = static_cast<J>(table.rows());
+    n = std::min((J)std::max(n, 0), row_count);
+    K rows = table.slice(0, n);
+    if (!rows) return;
+    print_rows(rows, 0, n,
+               "Table Head [" + std::to_string(n) + " of " + std::to_string(row_count));
+    r0(rows);
+}
 
-        for (J row = row_count - n; row < row_count; ++row) {
-            print_row(table, row, widths);
-        }
-        print_separator_table(widths);
-    }
+/**
+ * @brief Prints the last n rows of a splayed table on disk
+ *
+ * @param table Open splayed table
+ * @param n Number of rows to print (default: 5)
+ */
+void print_tail(const SplayedTable& table, int n) {
+    J row_count = static_cast<J>(table.rows());
+    n = std::min((J)std::max(n, 0), row_count);
+    K rows = table.slice(row_count - n, n);
+    if (!rows) return;
+    print_rows(rows, 0, n,
+               "Table Tail [last " + std::to_string(n) + " of " + std::to_string(row_count));
+    r0(rows);
 }
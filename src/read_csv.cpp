@@ -12,6 +12,16 @@
 #include "read_csv.h"
 #include <ctime>
 #include <iomanip>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <map>
+#include <set>
+#include <cmath>
+#include <memory>
+#include "mapped_file.h"
+#include "decompress.h"
+#include "table_builder.h"
 
 /**
  * @brief Splits a string into tokens based on a delimiter
@@ -30,97 +40,465 @@ std::vector<std::string> split(const std::string& line, char delimiter) {
     return result;
 }
 
+namespace detail {
+
+/**
+ * @brief Finds the end of the CSV record starting at `p`
+ *
+ * Newlines inside quoted fields do not end the record. Records without
+ * any quote character are located with a single memchr.
+ *
+ * @param p Start of the record
+ * @param end End of the buffer
+ * @return const char* Pointer to the terminating newline, or `end`
+ */
+const char* find_record_end(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (!nl) nl = end;
+    if (!std::memchr(p, '"', nl - p)) return nl;
+
+    bool in_quotes = false;
+    for (; p < end; ++p) {
+        if (*p == '"') {
+            in_quotes = !in_quotes;
+        } else if (*p == '\n' && !in_quotes) {
+            return p;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Splits one CSV record into fields, handling quoted fields
+ *
+ * A trailing carriage return is dropped so CRLF files infer the same
+ * types as LF files.
+ *
+ * @param begin Start of the record
+ * @param end One past the last character of the record (excluding newline)
+ * @param delimiter Field separator character
+ * @param row Vector that receives the fields (cleared first)
+ */
+void tokenize_record(const char* begin, const char* end, char delimiter,
+                     std::vector<std::string>& row) {
+    if (end > begin && end[-1] == '\r') --end;
+
+    row.clear();
+    bool in_quotes = false;
+    std::string current_field;
+
+    for (const char* p = begin; p < end; ++p) {
+        char c = *p;
+        if (c == '"') {
+            in_quotes = !in_quotes;
+        } else if (c == delimiter && !in_quotes) {
+            row.push_back(current_field);
+            current_field.clear();
+        } else {
+            current_field += c;
+        }
+    }
+    row.push_back(current_field);  // Add final field
+}
+
+/**
+ * @brief Returns true for records that are empty once the line ending is removed
+ */
+bool is_blank_record(const char* begin, const char* end) {
+    return end == begin || (end - begin == 1 && *begin == '\r');
+}
+
+}  // namespace detail
+
+namespace {
+
+using detail::find_record_end;
+using detail::tokenize_record;
+using detail::is_blank_record;
+
+/**
+ * @brief Feeds the fields of one row into the per-column type accumulators
+ */
+void observe_row(const std::vector<std::string>& row,
+                 std::vector<ColumnTypeAccumulator>& columns) {
+    size_t n = std::min(row.size(), columns.size());
+    for (size_t col = 0; col < n; ++col) {
+        columns[col].observe(row[col]);
+    }
+}
+
+/**
+ * @brief Observes every record in [begin, end) on the calling thread
+ *
+ * @return size_t Number of non-blank records observed
+ */
+size_t scan_range(const char* begin, const char* end, char delimiter,
+                  std::vector<ColumnTypeAccumulator>& columns) {
+    std::vector<std::string> row;
+    size_t rows = 0;
+    for (const char* p = begin; p < end; ) {
+        const char* rec_end = find_record_end(p, end);
+        if (!is_blank_record(p, rec_end)) {
+            tokenize_record(p, rec_end, delimiter, row);
+            observe_row(row, columns);
+            rows++;
+        }
+        p = rec_end + 1;
+    }
+    return rows;
+}
+
+/**
+ * @brief Observes every record of the data section using several threads
+ *
+ * The data section is cut into roughly equal chunks that start just after a
+ * newline. Each worker fills its own accumulators, which are merged at the end.
+ *
+ * @return size_t Number of records observed
+ */
+size_t full_scan(const char* data_start, const char* end, char delimiter,
+                 unsigned threads, std::vector<ColumnTypeAccumulator>& columns) {
+    constexpr size_t min_chunk_bytes = 1 << 20;
+    size_t bytes = end - data_start;
+    unsigned workers = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::min<size_t>(workers, std::max<size_t>(1, bytes / min_chunk_bytes)));
+
+    // Chunk boundaries, each moved forward to the start of a line
+    std::vector<const char*> bounds{data_start};
+    for (unsigned i = 1; i < workers; ++i) {
+        const char* p = data_start + bytes * i / workers;
+        p = std::max(p, bounds.back());
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        bounds.push_back(nl ? nl + 1 : end);
+    }
+    bounds.push_back(end);
+
+    std::vector<std::vector<ColumnTypeAccumulator>> partials(workers, columns);
+    std::vector<size_t> counts(workers, 0);
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workers; ++i) {
+        pool.emplace_back([&, i] {
+            counts[i] = scan_range(bounds[i], bounds[i + 1], delimiter, partials[i]);
+        });
+    }
+    counts[0] = scan_range(bounds[0], bounds[1], delimiter, partials[0]);
+    for (auto& t : pool) t.join();
+
+    size_t rows = 0;
+    for (unsigned i = 0; i < workers; ++i) {
+        for (size_t col = 0; col < columns.size(); ++col) {
+            columns[col].merge(partials[i][col]);
+        }
+        rows += counts[i];
+    }
+    return rows;
+}
+
+/**
+ * @brief Observes `sample_rows` records taken at even offsets across [begin, end)
+ *
+ * Each probe skips to the next newline and reads one record. Since a probe
+ * may land inside a quoted multi-line field, records whose field count does
+ * not match the header are discarded.
+ *
+ * @return size_t Number of records observed
+ */
+size_t stride_sample(const char* begin, const char* end, char delimiter, size_t sample_rows,
+                     std::vector<ColumnTypeAccumulator>& columns) {
+    if (begin >= end || sample_rows == 0) return 0;
+
+    std::vector<std::string> row;
+    size_t bytes = end - begin;
+    size_t rows = 0;
+    const char* last = begin;
+    for (size_t i = 0; i < sample_rows; ++i) {
+        const char* p = begin + bytes * i / sample_rows;
+        if (p < last) continue;  // Previous record already covered this offset
+        if (p > begin && p[-1] != '\n') {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!nl) break;
+            p = nl + 1;
+        }
+        if (p >= end) break;
+
+        const char* rec_end = find_record_end(p, end);
+        last = rec_end + 1;
+        if (is_blank_record(p, rec_end)) continue;
+
+        tokenize_record(p, rec_end, delimiter, row);
+        if (row.size() != columns.size()) continue;
+        observe_row(row, columns);
+        rows++;
+    }
+    return rows;
+}
+
+/**
+ * @brief Observes a uniform random sample of `sample_rows` records from [begin, end)
+ *
+ * Runs reservoir sampling (Algorithm R) over record boundaries and only
+ * tokenizes the records that survive.
+ *
+ * @return size_t Number of records observed
+ */
+size_t reservoir_sample(const char* begin, const char* end, char delimiter,
+                        size_t sample_rows, unsigned seed,
+                        std::vector<ColumnTypeAccumulator>& columns) {
+    if (begin >= end || sample_rows == 0) return 0;
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::pair<const char*, const char*>> reservoir;
+    reservoir.reserve(sample_rows);
+    size_t seen = 0;
+
+    for (const char* p = begin; p < end; ) {
+        const char* rec_end = find_record_end(p, end);
+        if (!is_blank_record(p, rec_end)) {
+            if (reservoir.size() < sample_rows) {
+                reservoir.emplace_back(p, rec_end);
+            } else {
+                std::uniform_int_distribution<size_t> pick(0, seen);
+                size_t slot = pick(rng);
+                if (slot < sample_rows) reservoir[slot] = {p, rec_end};
+            }
+            seen++;
+        }
+        p = rec_end + 1;
+    }
+
+    std::vector<std::string> row;
+    for (const auto& [rec_begin, rec_end] : reservoir) {
+        tokenize_record(rec_begin, rec_end, delimiter, row);
+        observe_row(row, columns);
+    }
+    return reservoir.size();
+}
+
 /**
- * @brief Parses a CSV file and extracts headers and data
+ * @class StreamRecordReader
+ * @brief Splits a stream of decompressed blocks into CSV records
  *
- * Handles quoted fields and validates key column if specified.
- * Only reads up to sample_rows for type inference.
+ * Records may span block boundaries; the unfinished tail of one block is
+ * carried over and completed with the next.
+ */
+class StreamRecordReader {
+public:
+    explicit StreamRecordReader(DecompressingReader& source) : source_(source) {}
+
+    /**
+     * @brief Tokenizes the next non-blank record into `row`
+     * @return bool False at the end of the stream
+     */
+    bool next(char delimiter, std::vector<std::string>& row) {
+        while (true) {
+            const char* begin = buffer_.data() + pos_;
+            const char* end = buffer_.data() + buffer_.size();
+            if (begin < end) {
+                const char* rec_end = find_record_end(begin, end);
+                if (rec_end < end || eof_) {
+                    pos_ = std::min<size_t>(rec_end - buffer_.data() + 1, buffer_.size());
+                    record_line_ = next_line_;
+                    next_line_ += 1 + std::count(begin, rec_end, '\n');  // Quoted fields may span lines
+                    if (is_blank_record(begin, rec_end)) continue;
+                    record_ = std::string_view(begin, rec_end - begin);
+                    tokenize_record(begin, rec_end, delimiter, row);
+                    return true;
+                }
+            } else if (eof_) {
+                return false;
+            }
+
+            // Record is incomplete: keep its start and append the next block
+            buffer_.erase(0, pos_);
+            pos_ = 0;
+            if (source_.next(block_)) {
+                buffer_ += block_;
+            } else {
+                eof_ = true;
+            }
+        }
+    }
+
+    /**
+     * @brief 1-based line number where the last returned record starts
+     */
+    size_t line() const { return record_line_; }
+
+    /**
+     * @brief Raw text of the last returned record, valid until the next call
+     */
+    std::string_view record() const { return record_; }
+
+private:
+    DecompressingReader& source_;
+    std::string buffer_;  ///< Unconsumed bytes, starting at a record boundary once trimmed
+    std::string block_;
+    size_t pos_ = 0;      ///< Start of the next record in buffer_
+    bool eof_ = false;
+    size_t next_line_ = 1;
+    size_t record_line_ = 0;
+    std::string_view record_;
+};
+
+}  // namespace
+
+/**
+ * @brief Takes the column names from the first record
+ *
+ * With a header row the record itself supplies the names and the key column
+ * is validated; otherwise names col1..colN are generated.
+ *
+ * @param row First record of the file
+ * @param header Whether the record is a header row
+ * @param key_column Name of key column (if any)
+ * @param headers Vector to store column headers
+ * @return bool False if the key column is not among the headers
+ */
+bool detail::resolve_headers(const std::vector<std::string>& row,
+                     bool header,
+                     const std::string& key_column,
+                     std::vector<std::string>& headers) {
+    headers.clear();
+    if (!header) {
+        // Generate default headers for headerless CSV
+        for (size_t i = 0; i < row.size(); ++i) {
+            headers.push_back("col" + std::to_string(i + 1));
+        }
+        return true;
+    }
+
+    // Process header row
+    headers = row;
+    if (!key_column.empty()) {
+        // Validate key column exists
+        auto it = std::find(headers.begin(), headers.end(), key_column);
+        if (it == headers.end()) {
+            std::cerr << "Error: Key column '" << key_column
+                      << "' not found in CSV headers." << std::endl;
+            return false;
+        }
+    }
+
+    // Display headers
+    for (const auto& h : headers) {
+        std::cout << "[" << h << "] ";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+/**
+ * @brief Parses a CSV file and samples its rows for type inference
+ *
+ * Maps the file and hands it to `sample_csv_buffer`.
  *
  * @param filename Path to CSV file
  * @param delimiter Field separator character
  * @param header Whether first row contains headers
  * @param headers Vector to store column headers
- * @param data Vector to store data rows
+ * @param columns Vector to store one type accumulator per column
  * @param key_column Name of key column (if any)
- * @param sample_rows Number of rows to read for sampling
+ * @param sampling Which rows to sample for type inference
  * @return bool True if parsing successful, false otherwise
  */
-bool parse_csv(const std::string& filename,
-               char delimiter,
-               bool header,
-               std::vector<std::string>& headers,
-               std::vector<std::vector<std::string>>& data,
-               const std::string& key_column,
-               size_t sample_rows = 5) {
-    // Open file
-    std::ifstream file(filename);
+bool detail::parse_csv(const std::string& filename,
+                       char delimiter,
+                       bool header,
+                       std::vector<std::string>& headers,
+                       std::vector<ColumnTypeAccumulator>& columns,
+                       const std::string& key_column,
+                       const SampleOptions& sampling) {
+    // Map file
+    MappedFile file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Unable to open file " << filename << std::endl;
         return false;
     }
+    return sample_csv_buffer(file.begin(), file.end(), delimiter, header, headers,
+                             columns, key_column, sampling);
+}
+
+/**
+ * @brief Samples the rows of an in-memory CSV buffer for type inference
+ *
+ * Reads the header (validating the key column if specified) and feeds the
+ * rows selected by `sampling` into one type accumulator per column.
+ *
+ * @param begin Start of the CSV text
+ * @param end End of the CSV text
+ * @param delimiter Field separator character
+ * @param header Whether first row contains headers
+ * @param headers Vector to store column headers
+ * @param columns Vector to store one type accumulator per column
+ * @param key_column Name of key column (if any)
+ * @param sampling Which rows to sample for type inference
+ * @return bool True if sampling successful, false otherwise
+ */
+bool detail::sample_csv_buffer(const char* begin,
+                               const char* end,
+                               char delimiter,
+                               bool header,
+                               std::vector<std::string>& headers,
+                               std::vector<ColumnTypeAccumulator>& columns,
+                               const std::string& key_column,
+                               const SampleOptions& sampling) {
+    const char* p = begin;
+
+    // Locate the first non-empty record
+    const char* rec_end = p;
+    while (p < end) {
+        rec_end = find_record_end(p, end);
+        if (!is_blank_record(p, rec_end)) break;
+        p = rec_end + 1;
+    }
+    if (p >= end) {
+        std::cerr << "Error: No data rows found in CSV file for type inference." << std::endl;
+        return false;
+    }
 
-    std::string line;
-    bool first_line = true;
+    std::vector<std::string> row;
+    tokenize_record(p, rec_end, delimiter, row);
+    const char* data_start = std::min(rec_end + 1, end);
     size_t rows_read = 0;
 
-    // Process file line by line
-    while (std::getline(file, line) && (rows_read < sample_rows || first_line)) {
-        if (line.empty()) continue;
-        
-        // Parse CSV line handling quoted fields
-        std::vector<std::string> row;
-        bool in_quotes = false;
-        std::string current_field;
-        
-        for (char c : line) {
-            if (c == '"') {
-                in_quotes = !in_quotes;
-            } else if (c == delimiter && !in_quotes) {
-                row.push_back(current_field);
-                current_field.clear();
-            } else {
-                current_field += c;
-            }
+    if (!detail::resolve_headers(row, header, key_column, headers)) {
+        return false;
+    }
+    columns.assign(headers.size(), ColumnTypeAccumulator());
+    if (!header) {
+        if (sampling.mode != SampleMode::FullScan) {
+            observe_row(row, columns);
+            rows_read++;
+        } else {
+            data_start = p;  // The full scan covers the first row itself
         }
-        row.push_back(current_field);  // Add final field
-
-        if (first_line) {
-            if (header) {
-                // Process header row
-                headers = row;
-                if (!key_column.empty()) {
-                    // Validate key column exists
-                    auto it = std::find(headers.begin(), headers.end(), key_column);
-                    if (it == headers.end()) {
-                        std::cerr << "Error: Key column '" << key_column
-                                  << "' not found in CSV headers." << std::endl;
-                        return false;
-                    }
-                }
-                
-                // Display headers
-                for (const auto& h : headers) {
-                    std::cout << "[" << h << "] ";
-                }
-                std::cout << std::endl;
-            } else {
-                // Generate default headers for headerless CSV
-                headers.clear();
-                for (size_t i = 0; i < row.size(); ++i) {
-                    headers.push_back("col" + std::to_string(i + 1));
-                }
-                data.push_back(row);
+    }
+
+    if (sampling.mode == SampleMode::FullScan) {
+        rows_read += full_scan(data_start, end, delimiter, sampling.threads, columns);
+    } else {
+        // Head rows
+        p = data_start;
+        while (p < end && rows_read < sampling.head_rows) {
+            rec_end = find_record_end(p, end);
+            if (!is_blank_record(p, rec_end)) {
+                tokenize_record(p, rec_end, delimiter, row);
+                observe_row(row, columns);
                 rows_read++;
             }
-            first_line = false;
-        } else {
-            data.push_back(row);
-            rows_read++;
+            p = rec_end + 1;
+        }
+
+        // Rows from the rest of the file
+        if (sampling.mode == SampleMode::Stride) {
+            rows_read += stride_sample(p, end, delimiter, sampling.sample_rows, columns);
+        } else if (sampling.mode == SampleMode::Reservoir) {
+            rows_read += reservoir_sample(p, end, delimiter, sampling.sample_rows,
+                                          sampling.seed, columns);
         }
     }
-    file.close();
 
-    if (data.empty()) {
+    if (rows_read == 0) {
         std::cerr << "Error: No data rows found in CSV file for type inference." << std::endl;
         return false;
     }
@@ -129,37 +507,48 @@ bool parse_csv(const std::string& filename,
 }
 
 /**
- * @brief Infers data types for all columns based on sample data
+ * @brief Resolves the data type of every column from its sampled values
  *
- * @param headers Vector of column headers
- * @param sample_data Vector of sample data rows
+ * @param columns One type accumulator per column
  * @return std::vector<I> Vector of inferred KDB+ type codes
  */
-std::vector<I> infer_column_types(const std::vector<std::string>& headers,
-                                  const std::vector<std::vector<std::string>>& sample_data) {
+std::vector<I> detail::infer_column_types(const std::vector<ColumnTypeAccumulator>& columns) {
     std::vector<I> col_types;
-    const auto& type_map = getExtendedTypeMap();
-
-    for (size_t col = 0; col < headers.size(); ++col) {
-        std::vector<std::string> column_data;
-        for (const auto& row : sample_data) {
-            if (col < row.size()) {
-                column_data.push_back(row[col]);
-            }
-        }
+    col_types.reserve(columns.size());
+    for (const auto& column : columns) {
+        col_types.push_back(column.resolve());
+    }
+    return col_types;
+}
 
-        I inferred_type = infer_column_type(column_data);
-        col_types.push_back(inferred_type);
+/**
+ * @brief Maps user supplied type keys (e.g. "j", "s") to KDB+ type codes
+ *
+ * @param column_types Type key for each column
+ * @param column_count Number of columns in the file
+ * @param col_types Vector to store the KDB+ type codes
+ * @return bool False if the count does not match or a key is unknown
+ */
+bool detail::resolve_column_types(const std::vector<std::string>& column_types,
+                          size_t column_count,
+                          std::vector<I>& col_types) {
+    const auto& type_map = getExtendedTypeMap();
+    if (column_types.size() != column_count) {
+        std::cerr << "Error: Number of provided types (" << column_types.size()
+                  << ") doesn't match number of columns (" << column_count << ")" << std::endl;
+        return false;
+    }
 
-        // Print inferred type
-        for (const auto& [key, info] : type_map) {
-            if (info.kdb_type == inferred_type) {
-                break;
-            }
+    col_types.clear();
+    for (const auto& type_key : column_types) {
+        auto it = type_map.find(type_key);
+        if (it == type_map.end()) {
+            std::cerr << "Invalid type specified: " << type_key << std::endl;
+            return false;
         }
+        col_types.push_back(it->second.kdb_type);
     }
-
-    return col_types;
+    return true;
 }
 
 /**
@@ -235,11 +624,216 @@ std::string create_table_cmd(const std::string& table_name,
     return cmd.str();
 }
 
+/**
+ * @brief Reads the header and resolves column types from the head of a stream
+ *
+ * Rows consumed for inference are returned in `buffered` so the caller can
+ * load them before continuing with the stream.
+ *
+ * @return bool False if the stream is empty or the schema is invalid
+ */
+bool read_stream_schema(StreamRecordReader& records,
+                        DecompressingReader& source,
+                        bool header,
+                        char delimiter,
+                        const std::string& key_column,
+                        const std::vector<std::string>& column_types,
+                        const SampleOptions& sampling,
+                        std::vector<std::string>& headers,
+                        std::vector<I>& col_types,
+                        std::vector<std::vector<std::string>>& buffered) {
+    std::vector<std::string> row;
+    if (!records.next(delimiter, row)) {
+        if (source.failed()) {
+            std::cerr << "Error: " << source.error() << std::endl;
+        } else {
+            std::cerr << "Error: No data rows found in CSV file for type inference." << std::endl;
+        }
+        return false;
+    }
+
+    if (!detail::resolve_headers(row, header, key_column, headers)) {
+        return false;
+    }
+
+    // Rows read for inference are kept and loaded once the types are known
+    buffered.clear();
+    if (!header) buffered.push_back(row);
+
+    if (!column_types.empty()) {
+        return detail::resolve_column_types(column_types, headers.size(), col_types);
+    }
+
+    size_t window = std::max<size_t>(1, sampling.head_rows + sampling.sample_rows);
+    while (buffered.size() < window && records.next(delimiter, row)) {
+        buffered.push_back(row);
+    }
+    if (buffered.empty()) {
+        std::cerr << "Error: No data rows found in CSV file for type inference." << std::endl;
+        return false;
+    }
+
+    std::vector<ColumnTypeAccumulator> columns(headers.size());
+    for (const auto& r : buffered) {
+        observe_row(r, columns);
+    }
+    col_types = detail::infer_column_types(columns);
+    return true;
+}
+
+/**
+ * @brief Keys a table loaded batch by batch the same way as the `0:` load
+ *
+ * @param table_name Name of the loaded table
+ * @param key_column Column to key on; empty adds and keys on an `idx` row number
+ * @return bool True if the server keyed the table
+ */
+bool detail::apply_key(const std::string& table_name, const std::string& key_column) {
+    std::string key_cmd = key_column.empty()
+        ? "`idx xkey update idx:til count i from `" + table_name
+        : "(`" + key_column + ") xkey `" + table_name;
+    auto result = inline_query(key_cmd);
+    if (K data = result.get_result()) r0(data);
+    return bool(result);
+}
+
+/**
+ * @brief Loads a compressed CSV file by streaming it through the client
+ *
+ * The server cannot read compressed text with `0:`, so the file is inflated
+ * on a background thread, tokenized as blocks arrive and shipped as typed
+ * column batches of `batch_rows` rows (`set` for the first, `upsert` after).
+ * Only the leading `head_rows + sample_rows` rows can be used for type
+ * inference, since a stream cannot be sampled ahead of the read position.
+ *
+ * @return bool True if successful, false otherwise
+ */
+bool load_compressed_csv(const std::string& table_name,
+                         const std::string& filename,
+                         Compression compression,
+                         bool header,
+                         char delimiter,
+                         const std::string& key_column,
+                         const std::vector<std::string>& column_types,
+                         const SampleOptions& sampling) {
+    constexpr size_t batch_rows = 100000;
+
+    DecompressingReader source(filename, compression);
+    StreamRecordReader records(source);
+
+    std::vector<std::string> headers;
+    std::vector<I> col_types;
+    std::vector<std::vector<std::string>> buffered;
+    if (!read_stream_schema(records, source, header, delimiter, key_column, column_types,
+                            sampling, headers, col_types, buffered)) {
+        return false;
+    }
+
+    TableBuilder builder(headers, col_types, batch_rows);
+    if (!builder.is_valid()) {
+        std::cerr << "Error: Unsupported column type for streamed load." << std::endl;
+        return false;
+    }
+
+    size_t batches = 0;
+    auto flush = [&]() {
+        return upload_table(table_name, builder.take_table(), batches++ > 0);
+    };
+
+    for (const auto& r : buffered) {
+        builder.append_row(r);
+        if (builder.full() && !flush()) return false;
+    }
+    buffered.clear();
+    std::vector<std::string> row;
+    while (records.next(delimiter, row)) {
+        builder.append_row(row);
+        if (builder.full() && !flush()) return false;
+    }
+    if (builder.rows() > 0 && !flush()) return false;
+
+    if (source.failed()) {
+        std::cerr << "Error: " << source.error() << std::endl;
+        inline_query("delete " + table_name + " from `.");
+        return false;
+    }
+    if (batches == 0) {
+        std::cerr << "Error: No data rows found in CSV file." << std::endl;
+        return false;
+    }
+
+    if (!detail::apply_key(table_name, key_column)) {
+        std::cerr << "Error: Failed to load CSV." << std::endl;
+        return false;
+    }
+
+    std::cout << "Table '" << table_name << "' successfully created and populated." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Parses a CSV file into a client-side kdb+ table
+ *
+ * @param filename Path to CSV file (may be gzip or zstd compressed)
+ * @param header Whether first row contains headers
+ * @param delimiter Field separator character
+ * @param column_types Vector of type strings (optional)
+ * @param sampling Rows used for type inference when no types are given
+ * @return K Table owned by the caller, or nullptr on failure
+ */
+K read_csv_table(const std::string& filename,
+                 bool header,
+                 char delimiter,
+                 const std::vector<std::string>& column_types,
+                 const SampleOptions& sampling) {
+    Compression compression = detect_compression(filename);
+    DecompressingReader source(filename, compression);
+    StreamRecordReader records(source);
+
+    std::vector<std::string> headers;
+    std::vector<I> col_types;
+    std::vector<std::vector<std::string>> buffered;
+    if (compression == Compression::None && column_types.empty()) {
+        std::vector<ColumnTypeAccumulator> sampled_columns;
+        if (!detail::parse_csv(filename, delimiter, header, headers, sampled_columns, "", sampling)) {
+            return nullptr;
+        }
+        col_types = detail::infer_column_types(sampled_columns);
+        std::vector<std::string> header_row;
+        if (header) records.next(delimiter, header_row);
+    } else if (!read_stream_schema(records, source, header, delimiter, "", column_types,
+                                   sampling, headers, col_types, buffered)) {
+        return nullptr;
+    }
+
+    // One batch for the whole file; columns grow as rows arrive
+    TableBuilder builder(headers, col_types, static_cast<size_t>(-1));
+    if (!builder.is_valid()) {
+        std::cerr << "Error: Unsupported column type in " << filename << std::endl;
+        return nullptr;
+    }
+    for (const auto& r : buffered) builder.append_row(r);
+    buffered.clear();
+    std::vector<std::string> row;
+    while (records.next(delimiter, row)) builder.append_row(row);
+
+    if (source.failed()) {
+        std::cerr << "Error: " << source.error() << std::endl;
+        return nullptr;
+    }
+    if (builder.rows() == 0) {
+        std::cerr << "Error: No data rows found in CSV file." << std::endl;
+        return nullptr;
+    }
+    return builder.take_table();
+}
+
 /**
  * @brief Main function to read CSV file and load it into KDB+
  *
  * Reads CSV file, infers or uses provided column types,
- * creates KDB+ table, and loads data.
+ * creates KDB+ table, and loads data. gzip and zstd compressed files are
+ * detected by their magic bytes and streamed through the client.
  *
  * @param table_name Name of table to create in KDB+
  * @param filename Path to CSV file
@@ -247,6 +841,7 @@ std::string create_table_cmd(const std::string& table_name,
  * @param delimiter Field separator character
  * @param key_column Name of key column (if any)
  * @param column_types Vector of type strings (optional)
+ * @param sampling Rows used for type inference when no types are given
  * @return bool True if successful, false otherwise
  */
 bool read_csv(const std::string& table_name,
@@ -254,45 +849,37 @@ bool read_csv(const std::string& table_name,
               bool header,
               char delimiter,
               const std::string& key_column,
-              const std::vector<std::string>& column_types) {
-    const auto& type_map = getExtendedTypeMap();
-
+              const std::vector<std::string>& column_types,
+              const SampleOptions& sampling) {
     // Validate inputs
     if (filename.empty() || table_name.empty()) {
         std::cerr << "Error: Empty filename or table name." << std::endl;
         return false;
     }
 
+    // Compressed input is decompressed and loaded by the client
+    Compression compression = detect_compression(filename);
+    if (compression != Compression::None) {
+        return load_compressed_csv(table_name, filename, compression, header, delimiter,
+                                   key_column, column_types, sampling);
+    }
+
     // Parse CSV structure
     std::vector<std::string> headers;
-    std::vector<std::vector<std::string>> sample_data;
-    if (!parse_csv(filename, delimiter, header, headers, sample_data, key_column, 5)) {
+    std::vector<ColumnTypeAccumulator> sampled_columns;
+    if (!detail::parse_csv(filename, delimiter, header, headers, sampled_columns, key_column, sampling)) {
         return false;
     }
 
     std::vector<I> col_types;
-
     if (!column_types.empty()) {
         // Use provided type specifications
-        if (column_types.size() != headers.size()) {
-            std::cerr << "Error: Number of provided types (" << column_types.size()
-                      << ") doesn't match number of columns (" << headers.size() << ")" << std::endl;
+        if (!detail::resolve_column_types(column_types, headers.size(), col_types)) {
             return false;
         }
-        
-        for (size_t i = 0; i < column_types.size(); ++i) {
-            const auto& type_key = column_types[i];
-            if (type_map.find(type_key) == type_map.end()) {
-                std::cerr << "Invalid type specified: " << type_key << std::endl;
-                return false;
-            }
-            
-            const auto& info = type_map.at(type_key);
-            col_types.push_back(info.kdb_type);
-        }
     } else {
-        // Infer types from sample data
-        col_types = infer_column_types(headers, sample_data);
+        // Infer types from sampled rows
+        col_types = detail::infer_column_types(sampled_columns);
     }
 
     // Build the KDB+ command
@@ -308,3 +895,438 @@ bool read_csv(const std::string& table_name,
     std::cout << "Table '" << table_name << "' successfully created and populated." << std::endl;
     return true;
 }
+
+namespace {
+
+/**
+ * @brief q function that writes one batch of partitions
+ *
+ * Enumerates the symbol columns against the database's sym file on the main
+ * thread, then writes each partition's splayed table with peach. A partition
+ * seen for the first time in this load is replaced (`set`), later batches
+ * for it are appended (`upsert`).
+ */
+const char* const WRITE_PARTITIONS =
+    "{[db;tab;parts;fresh;data]"
+    " data:.Q.en[db] each data;"
+    " {[db;tab;parts;fresh;data;i]"
+    "  path:` sv db,(`$string parts i),tab,`;"
+    "  $[fresh i;path set data i;path upsert data i]}[db;tab;parts;fresh;data] peach til count parts;"
+    " count parts}";
+
+/**
+ * @brief Computes the partition date (days since 2000.01.01) of a field
+ *
+ * @return bool False for empty or unparseable values
+ */
+bool partition_date(const std::string& field, I type, I& date) {
+    if (field.empty()) return false;
+    try {
+        if (type == KD) {
+            date = detail::parse_date(field);
+            return date != ni;
+        }
+        if (type == KP) {
+            constexpr J nanos_per_day = 86400000000000LL;
+            J nanos = detail::parse_timestamp(field);
+            if (nanos == nj) return false;
+            J days = nanos / nanos_per_day;
+            if (nanos % nanos_per_day < 0) days--;  // Floor for times before 2000
+            date = static_cast<I>(days);
+            return true;
+        }
+        if (type == KZ) {
+            F days = detail::parse_datetime(field);
+            if (std::isnan(days)) return false;
+            date = static_cast<I>(std::floor(days));
+            return true;
+        }
+    } catch (...) {
+    }
+    return false;
+}
+
+}  // namespace
+
+/**
+ * @brief Reads a CSV file and writes it as a date-partitioned, splayed database
+ *
+ * Rows are tokenized on the client and routed by the date of the partition
+ * column into one typed batch per date. Every `batch_rows` rows the batches
+ * are sent in one call that enumerates symbols and writes the partitions
+ * (`db/2024.12.02/table/`) in parallel on the server. Neither side ever holds
+ * more than one batch, so files larger than memory can be loaded. A date
+ * partition column is dropped from the written table since it becomes the
+ * virtual `date` column; timestamp and datetime columns are kept.
+ *
+ * @param table_name Name of the table inside each partition
+ * @param filename Path to CSV file (may be gzip or zstd compressed)
+ * @param hdb Database root, partition column and batch size
+ * @param header Whether first row contains headers
+ * @param delimiter Field separator character
+ * @param column_types Vector of type strings (optional)
+ * @param sampling Rows used for type inference when no types are given
+ * @return bool True if every partition was written, false otherwise
+ */
+bool read_csv(const std::string& table_name,
+              const std::string& filename,
+              const HdbOptions& hdb,
+              bool header,
+              char delimiter,
+              const std::vector<std::string>& column_types,
+              const SampleOptions& sampling) {
+    if (filename.empty() || table_name.empty() || hdb.db_root.empty() || hdb.partition_column.empty()) {
+        std::cerr << "Error: Empty filename, table name, database root or partition column." << std::endl;
+        return false;
+    }
+
+    Compression compression = detect_compression(filename);
+    DecompressingReader source(filename, compression);
+    StreamRecordReader records(source);
+
+    std::vector<std::string> headers;
+    std::vector<I> col_types;
+    std::vector<std::vector<std::string>> buffered;
+    if (compression == Compression::None && column_types.empty()) {
+        // Plain files can be sampled across their whole length first
+        std::vector<ColumnTypeAccumulator> sampled_columns;
+        if (!detail::parse_csv(filename, delimiter, header, headers, sampled_columns, "", sampling)) {
+            return false;
+        }
+        col_types = detail::infer_column_types(sampled_columns);
+        std::vector<std::string> header_row;
+        if (header) records.next(delimiter, header_row);
+    } else if (!read_stream_schema(records, source, header, delimiter, "", column_types,
+                                   sampling, headers, col_types, buffered)) {
+        return false;
+    }
+
+    auto part_it = std::find(headers.begin(), headers.end(), hdb.partition_column);
+    if (part_it == headers.end()) {
+        std::cerr << "Error: Partition column '" << hdb.partition_column
+                  << "' not found in CSV headers." << std::endl;
+        return false;
+    }
+    size_t part_col = part_it - headers.begin();
+    I part_type = col_types[part_col];
+    if (part_type != KD && part_type != KP && part_type != KZ) {
+        std::cerr << "Error: Partition column '" << hdb.partition_column
+                  << "' must hold dates, timestamps or datetimes." << std::endl;
+        return false;
+    }
+
+    // A date column becomes the virtual partition column, so it is not stored
+    bool drop_partition_column = part_type == KD;
+    std::vector<std::string> out_headers = headers;
+    std::vector<I> out_types = col_types;
+    if (drop_partition_column) {
+        out_headers.erase(out_headers.begin() + part_col);
+        out_types.erase(out_types.begin() + part_col);
+    }
+
+    std::string db = ":" + hdb.db_root;
+    size_t batch_rows = std::max<size_t>(1, hdb.batch_rows);
+    std::map<I, std::unique_ptr<TableBuilder>> partitions;
+    std::set<I> written;
+    size_t held = 0;
+    size_t rows_written = 0;
+    size_t skipped = 0;
+
+    auto flush = [&]() -> bool {
+        if (held == 0) return true;
+        K dates = ktn(KD, static_cast<J>(partitions.size()));
+        K fresh = ktn(KB, static_cast<J>(partitions.size()));
+        K tables = ktn(0, static_cast<J>(partitions.size()));
+        J n = 0;
+        for (auto& [date, builder] : partitions) {
+            if (builder->rows() == 0) continue;
+            kI(dates)[n] = date;
+            kG(fresh)[n] = written.insert(date).second;
+            kK(tables)[n] = builder->take_table();
+            n++;
+        }
+        dates->n = fresh->n = tables->n = n;
+
+        auto result = inline_query(WRITE_PARTITIONS, {ks(const_cast<S>(db.c_str())),
+                                                      ks(const_cast<S>(table_name.c_str())),
+                                                      dates, fresh, tables});
+        if (K data = result.get_result()) r0(data);
+        if (!bool(result)) {
+            std::cerr << "Error: Failed to write partitions under " << hdb.db_root << std::endl;
+            return false;
+        }
+        rows_written += held;
+        held = 0;
+        return true;
+    };
+
+    std::vector<std::string> out_row;
+    auto route = [&](const std::vector<std::string>& row) -> bool {
+        I date;
+        if (part_col >= row.size() || !partition_date(row[part_col], part_type, date)) {
+            skipped++;
+            return true;
+        }
+
+        auto& builder = partitions[date];
+        if (!builder) builder = std::make_unique<TableBuilder>(out_headers, out_types, batch_rows);
+        if (drop_partition_column) {
+            out_row = row;
+            out_row.erase(out_row.begin() + part_col);
+            builder->append_row(out_row);
+        } else {
+            builder->append_row(row);
+        }
+        return ++held < batch_rows || flush();
+    };
+
+    for (const auto& r : buffered) {
+        if (!route(r)) return false;
+    }
+    buffered.clear();
+    std::vector<std::string> row;
+    while (records.next(delimiter, row)) {
+        if (!route(row)) return false;
+    }
+    if (!flush()) return false;
+
+    if (source.failed()) {
+        std::cerr << "Error: " << source.error() << std::endl;
+        return false;
+    }
+    if (rows_written == 0) {
+        std::cerr << "Error: No rows with a valid partition date found in CSV file." << std::endl;
+        return false;
+    }
+
+    std::cout << "Table '" << table_name << "' written to " << written.size() << " partitions under "
+              << hdb.db_root << " (" << rows_written << " rows";
+    if (skipped > 0) std::cout << ", " << skipped << " rows without a partition date skipped";
+    std::cout << ")." << std::endl;
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief Quotes a field for the quarantine file, doubling embedded quotes
+ */
+std::string csv_quote(std::string_view text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    quoted += '"';
+    return quoted;
+}
+
+/**
+ * @class QuarantineSink
+ * @brief Receives the rows a tolerant load rejects
+ *
+ * Rows are appended to the side file as they arrive and held for the side
+ * table until the next `flush`, which the loader calls with every batch.
+ */
+class QuarantineSink {
+public:
+    explicit QuarantineSink(const QuarantineOptions& options) : options_(options) {
+        if (options_.file.empty()) return;
+        file_.open(options_.file, std::ios::out | std::ios::trunc);
+        if (file_) file_ << "line,reason,record\n";
+    }
+
+    bool is_open() const { return options_.file.empty() || file_.good(); }
+    size_t count() const { return count_; }
+
+    void add(size_t line, const std::string& reason, std::string_view record) {
+        count_++;
+        if (!record.empty() && record.back() == '\r') record.remove_suffix(1);
+        if (file_.is_open()) {
+            file_ << line << ',' << csv_quote(reason) << ',' << csv_quote(record) << '\n';
+        }
+        if (!options_.table.empty()) {
+            lines_.push_back(static_cast<J>(line));
+            reasons_.push_back(reason);
+            records_.emplace_back(record);
+        }
+    }
+
+    /**
+     * @brief Sends held rows to the side table; the first call creates it even when empty
+     */
+    bool flush() {
+        if (options_.table.empty() || (lines_.empty() && batches_ > 0)) return true;
+
+        J n = static_cast<J>(lines_.size());
+        K names = ktn(KS, 3);
+        kS(names)[0] = ss((S)"line");
+        kS(names)[1] = ss((S)"reason");
+        kS(names)[2] = ss((S)"record");
+        K line = ktn(KJ, n);
+        K reason = ktn(0, n);
+        K record = ktn(0, n);
+        for (J i = 0; i < n; ++i) {
+            kJ(line)[i] = lines_[i];
+            kK(reason)[i] = kpn(const_cast<S>(reasons_[i].data()), static_cast<J>(reasons_[i].size()));
+            kK(record)[i] = kpn(const_cast<S>(records_[i].data()), static_cast<J>(records_[i].size()));
+        }
+        lines_.clear();
+        reasons_.clear();
+        records_.clear();
+        return upload_table(options_.table, xT(xD(names, knk(3, line, reason, record))), batches_++ > 0);
+    }
+
+    bool close() {
+        if (!file_.is_open()) return true;
+        file_.close();
+        return !file_.fail();
+    }
+
+private:
+    const QuarantineOptions& options_;
+    std::ofstream file_;
+    std::vector<J> lines_;            ///< Held for the side table until the next flush
+    std::vector<std::string> reasons_;
+    std::vector<std::string> records_;
+    size_t count_ = 0;
+    size_t batches_ = 0;
+};
+
+}  // namespace
+
+/**
+ * @brief Loads a CSV file, diverting rows that do not parse instead of failing
+ *
+ * The file is parsed on the client (decompressing it if needed) and every
+ * record is checked against the column types: a wrong field count or a field
+ * the type's validator rejects sends the record to the quarantine sinks with
+ * its line number and the reason. Valid rows are sent in typed batches of
+ * `quarantine.batch_rows` (`set`, then `upsert`) and keyed as in the plain
+ * load once the file is done.
+ *
+ * @param table_name Name of table to create in KDB+
+ * @param filename Path to CSV file (may be gzip or zstd compressed)
+ * @param quarantine Side file and/or table for rejected rows, and the bad-row limit
+ * @param header Whether first row contains headers
+ * @param delimiter Field separator character
+ * @param key_column Name of key column (if any)
+ * @param column_types Vector of type strings (optional)
+ * @param sampling Rows used for type inference when no types are given
+ * @param report Receives the loaded and quarantined row counts (optional)
+ * @return bool True if the load completed, false on I/O errors or when more
+ *         than `max_bad_rows` rows were rejected
+ */
+bool read_csv(const std::string& table_name,
+              const std::string& filename,
+              const QuarantineOptions& quarantine,
+              bool header,
+              char delimiter,
+              const std::string& key_column,
+              const std::vector<std::string>& column_types,
+              const SampleOptions& sampling,
+              QuarantineReport* report) {
+    if (filename.empty() || table_name.empty()) {
+        std::cerr << "Error: Empty filename or table name." << std::endl;
+        return false;
+    }
+
+    Compression compression = detect_compression(filename);
+    std::vector<std::string> headers;
+    std::vector<I> col_types;
+    if (compression == Compression::None && column_types.empty()) {
+        std::vector<ColumnTypeAccumulator> sampled_columns;
+        if (!detail::parse_csv(filename, delimiter, header, headers, sampled_columns, key_column, sampling)) {
+            return false;
+        }
+        col_types = detail::infer_column_types(sampled_columns);
+    } else {
+        // Read the schema from a separate pass over the head so that the main
+        // pass sees every record in order and reports exact line numbers
+        DecompressingReader probe(filename, compression);
+        StreamRecordReader probe_records(probe);
+        std::vector<std::vector<std::string>> buffered;
+        if (!read_stream_schema(probe_records, probe, header, delimiter, key_column, column_types,
+                                sampling, headers, col_types, buffered)) {
+            return false;
+        }
+    }
+
+    TableBuilder builder(headers, col_types, std::max<size_t>(1, quarantine.batch_rows));
+    if (!builder.is_valid()) {
+        std::cerr << "Error: Unsupported column type for tolerant load." << std::endl;
+        return false;
+    }
+    QuarantineSink sink(quarantine);
+    if (!sink.is_open()) {
+        std::cerr << "Error: Unable to create quarantine file " << quarantine.file << std::endl;
+        return false;
+    }
+
+    DecompressingReader source(filename, compression);
+    StreamRecordReader records(source);
+    std::vector<std::string> row;
+    if (header) records.next(delimiter, row);
+
+    size_t loaded = 0;
+    size_t batches = 0;
+    auto flush = [&]() {
+        size_t rows = builder.rows();
+        if (!upload_table(table_name, builder.take_table(), batches++ > 0)) return false;
+        loaded += rows;
+        return sink.flush();
+    };
+    auto abandon = [&]() {
+        if (batches > 0) inline_query("delete " + table_name + " from `.");
+        sink.close();
+        return false;
+    };
+
+    std::string reason;
+    while (records.next(delimiter, row)) {
+        if (!builder.validate_row(row, reason)) {
+            sink.add(records.line(), reason, records.record());
+            if (sink.count() > quarantine.max_bad_rows) {
+                std::cerr << "Error: More than " << quarantine.max_bad_rows << " bad rows in " << filename
+                          << " (latest at line " << records.line() << ": " << reason << "); load abandoned." << std::endl;
+                return abandon();
+            }
+            continue;
+        }
+        builder.append_row(row);
+        if (builder.full() && !flush()) return abandon();
+    }
+    if (builder.rows() > 0 && !flush()) return abandon();
+    if (!sink.flush()) return abandon();
+
+    if (source.failed()) {
+        std::cerr << "Error: " << source.error() << std::endl;
+        return abandon();
+    }
+    if (!sink.close()) {
+        std::cerr << "Error: Failed writing quarantine file " << quarantine.file << std::endl;
+        return abandon();
+    }
+    if (report) {
+        report->rows_loaded = loaded;
+        report->rows_quarantined = sink.count();
+    }
+    if (batches == 0) {
+        std::cerr << "Error: No valid data rows found in CSV file (" << sink.count()
+                  << " rows quarantined)." << std::endl;
+        return false;
+    }
+    if (!detail::apply_key(table_name, key_column)) {
+        std::cerr << "Error: Failed to load CSV." << std::endl;
+        return false;
+    }
+
+    std::cout << "Table '" << table_name << "' successfully created and populated (" << loaded
+              << " rows loaded, " << sink.count() << " rows quarantined";
+    if (sink.count() > 0) {
+        if (!quarantine.file.empty()) std::cout << " to " << quarantine.file;
+        if (!quarantine.table.empty()) std::cout << (quarantine.file.empty() ? " to " : " and ") << quarantine.table;
+    }
+    std::cout << ")." << std::endl;
+    return true;
+}
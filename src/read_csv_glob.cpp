@@ -0,0 +1,380 @@
+#include "read_csv_glob.h"
+#include "decompress.h"
+#include "inline_query.h"
+#include "table_builder.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Matches a file name against a pattern with `*` and `?` wildcards
+ */
+bool wildcard_match(const char* pattern, const char* name) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*name) {
+        if (*pattern == '?' || *pattern == *name) {
+            ++pattern;
+            ++name;
+        } else if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (star) {
+            pattern = star + 1;
+            name = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') ++pattern;
+    return *pattern == '\0';
+}
+
+/**
+ * @brief Parses a whole file into a single typed table batch
+ */
+void parse_file(const std::string& filename,
+                const std::vector<std::string>& headers,
+                const std::vector<I>& col_types,
+                const GlobOptions& options,
+                detail::IngestBatch& batch) {
+    detail::FileText text;
+    if (!detail::load_text(filename, text, batch.error)) return;
+    batch.bytes = text.end - text.begin;
+
+    // One allocation per column: size the batch from the line count
+    size_t lines = 1;
+    for (const char* p = text.begin; p < text.end; ++lines) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', text.end - p));
+        if (!nl) break;
+        p = nl + 1;
+    }
+
+    TableBuilder builder(headers, col_types, lines);
+    builder.reserve(lines);
+    std::vector<std::string> row;
+    bool header_pending = options.header;
+    for (const char* p = text.begin; p < text.end; ) {
+        const char* rec_end = detail::find_record_end(p, text.end);
+        if (!detail::is_blank_record(p, rec_end)) {
+            detail::tokenize_record(p, rec_end, options.delimiter, row);
+            if (header_pending) {
+                header_pending = false;
+                if (row != headers) {
+                    batch.error = "header of " + filename + " does not match the first file";
+                    return;
+                }
+            } else {
+                builder.append_row(row);
+            }
+        }
+        p = rec_end + 1;
+    }
+
+    batch.rows = builder.rows();
+    batch.table = builder.take_table();
+}
+
+}  // namespace
+
+/**
+ * @brief Maps a plain file, or decompresses a compressed one
+ *
+ * @param max_bytes Stop decompressing after this many bytes (for sampling)
+ * @return bool False if the file could not be read
+ */
+bool detail::load_text(const std::string& filename, FileText& text, std::string& error, size_t max_bytes) {
+    Compression compression = detect_compression(filename);
+    if (compression == Compression::None) {
+        text.mapped = MappedFile(filename);
+        if (!text.mapped.is_open()) {
+            error = "unable to open " + filename;
+            return false;
+        }
+        text.begin = text.mapped.begin();
+        text.end = text.mapped.end();
+        return true;
+    }
+
+    DecompressingReader reader(filename, compression);
+    std::string block;
+    while (text.inflated.size() < max_bytes && reader.next(block)) {
+        text.inflated += block;
+    }
+    if (reader.failed()) {
+        error = reader.error();
+        return false;
+    }
+    if (text.inflated.size() >= max_bytes) {
+        // Cut a partial read back to a whole number of lines
+        size_t last_newline = text.inflated.rfind('\n');
+        text.inflated.resize(last_newline == std::string::npos ? 0 : last_newline + 1);
+    }
+    text.begin = text.inflated.data();
+    text.end = text.begin + text.inflated.size();
+    return true;
+}
+
+/**
+ * @brief Parses pieces on a pool of workers and uploads them strictly in order
+ *
+ * @param table_name Name of the table to create
+ * @param source File or pattern named in error messages
+ * @param pieces Number of pieces to parse
+ * @param threads Parser threads
+ * @param parse Fills the batch for one piece, called on the worker threads
+ * @param totals Receives the rows and bytes uploaded
+ * @return bool True if every piece was parsed and uploaded
+ */
+bool detail::upload_in_order(const std::string& table_name,
+                             const std::string& source,
+                             size_t pieces,
+                             unsigned threads,
+                             const std::function<void(size_t, IngestBatch&)>& parse,
+                             IngestStats& totals) {
+    threads = static_cast<unsigned>(std::clamp<size_t>(threads, 1, std::max<size_t>(1, pieces)));
+
+    std::vector<IngestBatch> batches(pieces);
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t claimed = 0;
+    size_t uploaded = 0;
+    bool abort = false;
+    const size_t max_ahead = threads + 1;
+
+    setm(1);  // Workers intern symbols concurrently
+    auto parse_worker = [&] {
+        while (true) {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return abort || claimed >= pieces || claimed < uploaded + max_ahead; });
+                if (abort || claimed >= pieces) break;
+                i = claimed++;
+            }
+            IngestBatch batch;
+            parse(i, batch);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batches[i] = std::move(batch);
+                batches[i].ready = true;
+            }
+            changed.notify_all();
+        }
+        m9();
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) pool.emplace_back(parse_worker);
+
+    size_t lines_before = 0;
+    bool ok = true;
+    for (size_t i = 0; i < pieces; ++i) {
+        IngestBatch batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return batches[i].ready; });
+            batch = std::move(batches[i]);
+            batches[i] = IngestBatch();
+        }
+
+        if (!batch.error.empty()) {
+            std::cerr << "Error: " << batch.error;
+            if (batch.error_line > 0) std::cerr << " at line " << lines_before + batch.error_line << " of " << source;
+            std::cerr << std::endl;
+            ok = false;
+        } else if (batch.table) {
+            ok = upload_table(table_name, batch.table, totals.rows > 0);
+            totals.rows += batch.rows;
+        }
+        totals.bytes += batch.bytes;
+        lines_before += batch.lines;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uploaded = i + 1;
+            abort = !ok;
+        }
+        changed.notify_all();
+        if (!ok) break;
+    }
+
+    for (auto& t : pool) t.join();
+    for (auto& batch : batches) {
+        if (batch.table) r0(batch.table);
+    }
+    if (!ok && totals.rows > 0) inline_query("delete " + table_name + " from `.");
+    return ok;
+}
+
+/**
+ * @brief Prints the rows, size and throughput of a finished load
+ */
+void detail::report_ingest(const std::string& table_name, const std::string& source, const IngestStats& totals) {
+    std::cout << "Table '" << table_name << "' loaded " << totals.rows << " rows from "
+              << source << " (" << totals.bytes / (1 << 20) << " MB) in "
+              << totals.seconds << "s: " << static_cast<uint64_t>(totals.rows_per_second())
+              << " rows/s, " << totals.megabytes_per_second() << " MB/s" << std::endl;
+}
+
+/**
+ * @brief Expands a file pattern into the sorted list of matching files
+ *
+ * @param pattern Path whose file name part may contain `*` and `?`
+ * @return std::vector<std::string> Matching regular files, sorted by name
+ */
+std::vector<std::string> expand_glob(const std::string& pattern) {
+    namespace fs = std::filesystem;
+    fs::path path(pattern);
+    fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+    std::string name_pattern = path.filename().string();
+
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        std::string name = entry.path().filename().string();
+        if (wildcard_match(name_pattern.c_str(), name.c_str())) {
+            files.push_back((path.has_parent_path() ? entry.path() : fs::path(name)).string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * @brief Loads all files matching a pattern into one table
+ *
+ * Schema inference samples every file with a share of the sampling budget
+ * and merges the results. Parsing then runs on a pool of worker threads
+ * while the calling thread uploads the finished files strictly in order;
+ * workers stay at most a few files ahead of the upload to bound memory.
+ *
+ * @param table_name Name of the table to create
+ * @param pattern File pattern to expand
+ * @param options Parsing, schema, ordering and threading options
+ * @param stats Receives row, byte and timing totals (optional)
+ * @return bool True if every file was loaded, false otherwise
+ */
+bool read_csv_glob(const std::string& table_name,
+                   const std::string& pattern,
+                   const GlobOptions& options,
+                   IngestStats* stats) {
+    auto started = std::chrono::steady_clock::now();
+
+    if (pattern.empty() || table_name.empty()) {
+        std::cerr << "Error: Empty pattern or table name." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> files = expand_glob(pattern);
+    if (files.empty()) {
+        std::cerr << "Error: No files match " << pattern << std::endl;
+        return false;
+    }
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, files.size()));
+
+    // Infer one schema from a sample spread across all the files
+    std::vector<std::string> headers;
+    std::vector<I> col_types;
+    {
+        SampleOptions per_file = options.sampling;
+        per_file.sample_rows = std::max<size_t>(1, options.sampling.sample_rows / files.size());
+        constexpr size_t compressed_sample_bytes = 4 << 20;
+
+        std::vector<std::vector<std::string>> file_headers(files.size());
+        std::vector<std::vector<ColumnTypeAccumulator>> file_columns(files.size());
+        std::vector<char> sampled(files.size(), 0);
+        std::atomic<size_t> next{0};
+
+        auto sample_worker = [&] {
+            for (size_t i = next++; i < files.size(); i = next++) {
+                detail::FileText text;
+                std::string error;
+                if (!detail::load_text(files[i], text, error, compressed_sample_bytes)) {
+                    std::cerr << "Error: " << error << std::endl;
+                    continue;
+                }
+                sampled[i] = detail::sample_csv_buffer(text.begin, text.end, options.delimiter,
+                                                       options.header, file_headers[i], file_columns[i],
+                                                       options.key_column, per_file);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(sample_worker);
+        sample_worker();
+        for (auto& t : pool) t.join();
+
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!sampled[i]) {
+                std::cerr << "Error: Failed to read " << files[i] << std::endl;
+                return false;
+            }
+            if (i == 0) continue;
+            if (file_headers[i] != file_headers[0]) {
+                std::cerr << "Error: Columns of " << files[i] << " do not match " << files[0] << std::endl;
+                return false;
+            }
+            for (size_t col = 0; col < file_columns[0].size(); ++col) {
+                file_columns[0][col].merge(file_columns[i][col]);
+            }
+        }
+
+        headers = file_headers[0];
+        if (!options.column_types.empty()) {
+            if (!detail::resolve_column_types(options.column_types, headers.size(), col_types)) {
+                return false;
+            }
+        } else {
+            col_types = detail::infer_column_types(file_columns[0]);
+        }
+    }
+
+    if (!options.sort_column.empty() &&
+        std::find(headers.begin(), headers.end(), options.sort_column) == headers.end()) {
+        std::cerr << "Error: Sort column '" << options.sort_column << "' not found in CSV headers." << std::endl;
+        return false;
+    }
+
+    // Parse on the pool, upload in file order from this thread
+    IngestStats totals;
+    totals.files = files.size();
+    bool ok = detail::upload_in_order(table_name, pattern, files.size(), threads,
+                                      [&](size_t i, detail::IngestBatch& batch) {
+                                          parse_file(files[i], headers, col_types, options, batch);
+                                      },
+                                      totals);
+    if (!ok) return false;
+
+    if (totals.rows == 0) {
+        std::cerr << "Error: No data rows found in " << pattern << std::endl;
+        return false;
+    }
+
+    if (!options.sort_column.empty()) {
+        auto sorted = inline_query("`" + options.sort_column + " xasc `" + table_name);
+        if (K data = sorted.get_result()) r0(data);
+        if (!bool(sorted)) {
+            std::cerr << "Error: Failed to sort " << table_name << " by " << options.sort_column << std::endl;
+            return false;
+        }
+    }
+    if (!detail::apply_key(table_name, options.key_column)) {
+        std::cerr << "Error: Failed to finish loading " << pattern << std::endl;
+        return false;
+    }
+
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    detail::report_ingest(table_name, std::to_string(totals.files) + " files", totals);
+    if (stats) *stats = totals;
+    return true;
+}
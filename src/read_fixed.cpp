@@ -0,0 +1,330 @@
+#include "read_fixed.h"
+#include "inline_query.h"
+#include "mapped_file.h"
+#include "symbol_cache.h"
+#include "table_builder.h"
+#include "type_map.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <utility>
+
+namespace {
+
+constexpr size_t BLOCK_ROWS = 4096;  ///< Records transposed together while they are in cache
+
+/**
+ * @brief A field resolved against the type map
+ */
+struct FieldPlan {
+    size_t offset;
+    size_t width;
+    I type;
+    const TypeInfo* info;
+};
+
+/**
+ * @brief Where each record of the current batch starts and how long it is
+ *
+ * Fixed-length records are addressed arithmetically; line-delimited text
+ * records use the start and length of each line collected for the batch.
+ */
+struct RecordSource {
+    const char* base = nullptr;
+    size_t length = 0;                                 ///< Record stride, 0 for line-delimited text
+    std::vector<std::pair<const char*, size_t>> lines; ///< Line start and length without the line ending
+
+    const char* at(size_t row) const { return length ? base + row * length : lines[row].first; }
+    size_t size(size_t row) const { return length ? length : lines[row].second; }
+};
+
+/**
+ * @brief Checks the schema and resolves each field's type
+ *
+ * @param binary Whether field widths must match the type's element size
+ * @return bool False (with an error printed) if the schema is unusable
+ */
+bool plan_fields(const std::vector<FixedField>& fields, const FixedRecordOptions& options, bool binary,
+                 std::vector<std::string>& names, std::vector<I>& types, std::vector<FieldPlan>& plans) {
+    if (fields.empty()) {
+        std::cerr << "Error: Record layout has no fields." << std::endl;
+        return false;
+    }
+    std::vector<std::string> type_keys;
+    for (const auto& field : fields) type_keys.push_back(field.type);
+    if (!detail::resolve_column_types(type_keys, fields.size(), types)) return false;
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+        const FixedField& field = fields[i];
+        const TypeInfo* info = find_type_info(types[i]);
+        if (field.name.empty() || field.width == 0 || !info) {
+            std::cerr << "Error: Field " << i << " needs a name, a width and a supported type." << std::endl;
+            return false;
+        }
+        if (options.record_length && field.offset + field.width > options.record_length) {
+            std::cerr << "Error: Field '" << field.name << "' extends past the " << options.record_length
+                      << "-byte record." << std::endl;
+            return false;
+        }
+        if (binary && types[i] != KS && field.width != element_size(types[i])) {
+            std::cerr << "Error: Binary field '" << field.name << "' is " << field.width << " bytes, but type "
+                      << field.type << " is stored in " << element_size(types[i]) << "." << std::endl;
+            return false;
+        }
+        names.push_back(field.name);
+        plans.push_back({field.offset, field.width, types[i], info});
+    }
+    return true;
+}
+
+/**
+ * @brief Copies a `W`-byte field out of `rows` records spaced `stride` bytes apart
+ *
+ * The fixed-size memcpy compiles to one load and one store per record.
+ */
+template <size_t W>
+void gather(char* dst, const char* src, size_t stride, size_t rows) {
+    for (size_t row = 0; row < rows; ++row) {
+        std::memcpy(dst + row * W, src + row * stride, W);
+    }
+}
+
+void gather_field(char* dst, const char* src, size_t stride, size_t width, size_t rows) {
+    switch (width) {
+        case 1: gather<1>(dst, src, stride, rows); break;
+        case 2: gather<2>(dst, src, stride, rows); break;
+        case 4: gather<4>(dst, src, stride, rows); break;
+        case 8: gather<8>(dst, src, stride, rows); break;
+        case 16: gather<16>(dst, src, stride, rows); break;
+        default:
+            for (size_t row = 0; row < rows; ++row) std::memcpy(dst + row * width, src + row * stride, width);
+    }
+}
+
+/**
+ * @brief Fills rows `[first, last)` of the batch columns from binary records
+ */
+void convert_binary(const RecordSource& records, const std::vector<FieldPlan>& plans,
+                    const std::vector<K>& columns, size_t first, size_t last) {
+    for (size_t block = first; block < last; block += BLOCK_ROWS) {
+        size_t rows = std::min(BLOCK_ROWS, last - block);
+        const char* base = records.at(block);
+        for (size_t col = 0; col < plans.size(); ++col) {
+            const FieldPlan& plan = plans[col];
+            K column = columns[col];
+            if (plan.type == KS) {
+                for (size_t row = 0; row < rows; ++row) {
+                    const char* p = base + row * records.length + plan.offset;
+                    size_t n = plan.width;
+                    while (n > 0 && (p[n - 1] == '\0' || p[n - 1] == ' ')) n--;
+                    kS(column)[block + row] = intern_symbol(std::string_view(p, n));
+                }
+            } else {
+                gather_field(reinterpret_cast<char*>(kG(column)) + block * plan.width,
+                             base + plan.offset, records.length, plan.width, rows);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fills rows `[first, last)` of the batch columns from fixed-width text
+ */
+void convert_text(const RecordSource& records, const std::vector<FieldPlan>& plans,
+                  const std::vector<K>& columns, size_t first, size_t last) {
+    std::string field;
+    for (size_t block = first; block < last; block += BLOCK_ROWS) {
+        size_t block_end = std::min(last, block + BLOCK_ROWS);
+        for (size_t col = 0; col < plans.size(); ++col) {
+            const FieldPlan& plan = plans[col];
+            K column = columns[col];
+            for (size_t row = block; row < block_end; ++row) {
+                size_t length = records.size(row);
+                const char* p = records.at(row) + std::min(plan.offset, length);
+                const char* end = records.at(row) + std::min(plan.offset + plan.width, length);
+                while (p < end && *p == ' ') ++p;
+                while (end > p && end[-1] == ' ') --end;
+                if (p == end) {
+                    plan.info->null_assigner(column, row);
+                    continue;
+                }
+                field.assign(p, end - p);
+                try {
+                    plan.info->value_assigner(column, field, row);
+                } catch (...) {
+                    plan.info->null_assigner(column, row);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Loads a fixed-layout file in batches converted on a thread pool
+ */
+bool load_fixed(const std::string& table_name,
+                const std::string& filename,
+                const std::vector<FixedField>& fields,
+                const FixedRecordOptions& options,
+                IngestStats* stats,
+                bool binary) {
+    auto started = std::chrono::steady_clock::now();
+
+    if (filename.empty() || table_name.empty()) {
+        std::cerr << "Error: Empty filename or table name." << std::endl;
+        return false;
+    }
+    if (binary && options.record_length == 0) {
+        std::cerr << "Error: Binary records need a record_length." << std::endl;
+        return false;
+    }
+    if (binary && std::endian::native != std::endian::little) {
+        std::cerr << "Error: Binary records are little-endian; this host is not." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> names;
+    std::vector<I> types;
+    std::vector<FieldPlan> plans;
+    if (!plan_fields(fields, options, binary, names, types, plans)) return false;
+    if (!options.key_column.empty() && std::find(names.begin(), names.end(), options.key_column) == names.end()) {
+        std::cerr << "Error: Key column '" << options.key_column << "' is not in the record layout." << std::endl;
+        return false;
+    }
+
+    MappedFile file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open file: " << filename << std::endl;
+        return false;
+    }
+    const char* begin = file.begin() + std::min(options.skip_bytes, file.size());
+    const char* end = file.end();
+    if (options.record_length && (end - begin) % options.record_length != 0) {
+        std::cerr << "Warning: " << (end - begin) % options.record_length
+                  << " trailing bytes of " << filename << " do not form a whole record and are ignored." << std::endl;
+        end -= (end - begin) % options.record_length;
+    }
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    size_t batch_rows = std::max<size_t>(1, options.batch_rows);
+    bool has_symbols = std::find(types.begin(), types.end(), KS) != types.end();
+    if (has_symbols && threads > 1) setm(1);  // Workers intern symbols concurrently
+
+    IngestStats totals;
+    totals.files = 1;
+    totals.bytes = end - begin;
+    RecordSource records;
+    records.length = options.record_length;
+    for (const char* p = begin; p < end; ) {
+        // Locate the batch's records
+        size_t rows;
+        const char* next;
+        records.base = p;
+        if (records.length) {
+            rows = std::min<size_t>(batch_rows, (end - p) / records.length);
+            next = p + rows * records.length;
+        } else {
+            records.lines.clear();
+            for (next = p; next < end && records.lines.size() < batch_rows; ) {
+                const char* nl = static_cast<const char*>(std::memchr(next, '\n', end - next));
+                const char* line_end = nl ? nl : end;  // The last line may be unterminated
+                size_t n = line_end - next;
+                if (n > 0 && next[n - 1] == '\r') n--;
+                if (n > 0) records.lines.emplace_back(next, n);  // Blank lines are not records
+                next = nl ? nl + 1 : end;
+            }
+            rows = records.lines.size();
+        }
+        if (rows == 0) {
+            p = next;
+            continue;
+        }
+
+        std::vector<K> columns;
+        for (I type : types) columns.push_back(ktn(type, static_cast<J>(rows)));
+
+        // Each thread converts a contiguous share of the batch in place
+        unsigned workers = static_cast<unsigned>(std::min<size_t>(threads, (rows + BLOCK_ROWS - 1) / BLOCK_ROWS));
+        size_t share = (rows + workers - 1) / workers;
+        auto convert = [&](size_t first, size_t last, bool worker) {
+            if (binary) convert_binary(records, plans, columns, first, last);
+            else convert_text(records, plans, columns, first, last);
+            if (worker && has_symbols) m9();
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < workers; ++t) {
+            pool.emplace_back(convert, t * share, std::min(rows, (t + 1) * share), true);
+        }
+        convert(0, std::min(rows, share), false);
+        for (auto& t : pool) t.join();
+
+        K names_vector = ktn(KS, static_cast<J>(names.size()));
+        K values = ktn(0, static_cast<J>(columns.size()));
+        for (size_t col = 0; col < columns.size(); ++col) {
+            kS(names_vector)[col] = ss(const_cast<S>(names[col].c_str()));
+            kK(values)[col] = columns[col];
+        }
+        if (!upload_table(table_name, xT(xD(names_vector, values)), totals.rows > 0)) {
+            if (totals.rows > 0) inline_query("delete " + table_name + " from `.");
+            return false;
+        }
+        totals.rows += rows;
+        p = next;
+    }
+
+    if (totals.rows == 0) {
+        std::cerr << "Error: No records found in " << filename << std::endl;
+        return false;
+    }
+
+    if (!detail::apply_key(table_name, options.key_column)) {
+        std::cerr << "Error: Failed to finish loading " << filename << std::endl;
+        return false;
+    }
+
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    detail::report_ingest(table_name, filename, totals);
+    if (stats) *stats = totals;
+    return true;
+}
+
+}  // namespace
+
+/**
+ * @brief Loads a fixed-width text file into a table
+ *
+ * @param table_name Name of the table to create
+ * @param filename Path to the file
+ * @param fields Column layout
+ * @param options Record length, header size, key and threading options
+ * @param stats Receives row, byte and timing totals (optional)
+ * @return bool True if the file was loaded, false otherwise
+ */
+bool read_fixed_width(const std::string& table_name,
+                      const std::string& filename,
+                      const std::vector<FixedField>& fields,
+                      const FixedRecordOptions& options,
+                      IngestStats* stats) {
+    return load_fixed(table_name, filename, fields, options, stats, false);
+}
+
+/**
+ * @brief Loads a file of packed little-endian binary records into a table
+ *
+ * @param table_name Name of the table to create
+ * @param filename Path to the file
+ * @param fields Column layout; widths must match the kdb+ element sizes
+ * @param options Record length (required), header size, key and threading options
+ * @param stats Receives row, byte and timing totals (optional)
+ * @return bool True if the file was loaded, false otherwise
+ */
+bool read_binary_records(const std::string& table_name,
+                         const std::string& filename,
+                         const std::vector<FixedField>& fields,
+                         const FixedRecordOptions& options,
+                         IngestStats* stats) {
+    return load_fixed(table_name, filename, fields, options, stats, true);
+}
@@ -0,0 +1,523 @@
+#include "read_jsonl.h"
+#include "inline_query.h"
+#include "table_builder.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+void skip_whitespace(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+}
+
+/**
+ * @brief Appends a code point to `out` as UTF-8
+ */
+void append_utf8(unsigned code, std::string& out) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xc0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xe0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+}
+
+bool parse_hex4(const char* p, const char* end, unsigned& code) {
+    if (end - p < 4) return false;
+    code = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= c - '0';
+        else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes the JSON string starting at the opening quote `*p`
+ *
+ * Unescaped runs are copied in one append, so strings without escapes cost
+ * a single scan.
+ */
+bool parse_string(const char*& p, const char* end, std::string& out, std::string& error) {
+    out.clear();
+    ++p;  // Opening quote
+    while (p < end) {
+        const char* run = p;
+        while (p < end && *p != '"' && *p != '\\') ++p;
+        out.append(run, p - run);
+        if (p == end) break;
+        if (*p == '"') {
+            ++p;
+            return true;
+        }
+
+        if (++p == end) break;  // Backslash
+        switch (*p++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                unsigned code;
+                if (!parse_hex4(p, end, code)) {
+                    error = "invalid \\u escape";
+                    return false;
+                }
+                p += 4;
+                // A high surrogate combines with the following low surrogate
+                unsigned low;
+                if (code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    parse_hex4(p + 2, end, low) && low >= 0xdc00 && low < 0xe000) {
+                    code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                    p += 6;
+                }
+                append_utf8(code, out);
+                break;
+            }
+            default:
+                error = "invalid escape in string";
+                return false;
+        }
+    }
+    error = "unterminated string";
+    return false;
+}
+
+/**
+ * @brief Skips a nested object or array starting at `*p`, leaving `p` after it
+ */
+bool skip_nested(const char*& p, const char* end, std::string& error) {
+    int depth = 0;
+    while (p < end) {
+        char c = *p;
+        if (c == '"') {
+            for (++p; p < end && *p != '"'; ++p) {
+                if (*p == '\\') ++p;
+            }
+            if (p >= end) break;
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                ++p;
+                return true;
+            }
+        }
+        ++p;
+    }
+    error = "unterminated object or array";
+    return false;
+}
+
+/**
+ * @brief Reads `literal` at `p`, e.g. `true`
+ */
+bool match_literal(const char*& p, const char* end, const char* literal) {
+    size_t n = std::strlen(literal);
+    if (static_cast<size_t>(end - p) < n || std::memcmp(p, literal, n) != 0) return false;
+    p += n;
+    return true;
+}
+
+/**
+ * @brief Reads one JSON value as the text a CSV field would hold
+ */
+bool parse_value(const char*& p, const char* end, std::string& out, std::string& error) {
+    if (p == end) {
+        error = "missing value";
+        return false;
+    }
+    char c = *p;
+    if (c == '"') return parse_string(p, end, out, error);
+    if (c == '{' || c == '[') {
+        const char* start = p;
+        if (!skip_nested(p, end, error)) return false;
+        out.assign(start, p - start);
+        return true;
+    }
+    if (match_literal(p, end, "true")) {
+        out = "true";
+        return true;
+    }
+    if (match_literal(p, end, "false")) {
+        out = "false";
+        return true;
+    }
+    if (match_literal(p, end, "null")) {
+        out.clear();
+        return true;
+    }
+
+    const char* start = p;
+    while (p < end && (std::isdigit(static_cast<unsigned char>(*p)) || *p == '-' || *p == '+' ||
+                       *p == '.' || *p == 'e' || *p == 'E')) {
+        ++p;
+    }
+    if (p == start) {
+        error = std::string("unexpected character '") + c + "'";
+        return false;
+    }
+    out.assign(start, p - start);
+    return true;
+}
+
+/**
+ * @brief Hash that lets a column lookup take a string_view without a copy
+ */
+struct NameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+/**
+ * @brief Field names in first-seen order with a type accumulator for each
+ */
+struct JsonSchema {
+    std::vector<std::string> names;
+    std::unordered_map<std::string, size_t, NameHash, std::equal_to<>> index;
+    std::vector<ColumnTypeAccumulator> columns;
+
+    size_t add(const std::string& name) {
+        auto [it, added] = index.emplace(name, names.size());
+        if (added) {
+            names.push_back(name);
+            columns.emplace_back();
+        }
+        return it->second;
+    }
+
+    void observe(const std::vector<std::pair<std::string, std::string>>& fields) {
+        for (const auto& [name, value] : fields) columns[add(name)].observe(value);
+    }
+
+    void merge(const JsonSchema& other) {
+        for (size_t i = 0; i < other.names.size(); ++i) {
+            columns[add(other.names[i])].merge(other.columns[i]);
+        }
+    }
+};
+
+/**
+ * @brief Splits text into chunks of about `target` bytes that end at line boundaries
+ */
+std::vector<std::pair<const char*, const char*>> split_lines(const char* begin, const char* end, size_t target) {
+    std::vector<std::pair<const char*, const char*>> chunks;
+    const char* p = begin;
+    while (p < end) {
+        const char* cut = end;
+        if (static_cast<size_t>(end - p) > target) {
+            const char* nl = static_cast<const char*>(std::memchr(p + target, '\n', end - (p + target)));
+            if (nl) cut = nl + 1;
+        }
+        chunks.emplace_back(p, cut);
+        p = cut;
+    }
+    return chunks;
+}
+
+const char* line_end(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return nl ? nl : end;
+}
+
+bool is_blank(const char* begin, const char* end) {
+    skip_whitespace(begin, end);
+    return begin == end;
+}
+
+/**
+ * @brief Observes up to `limit` non-blank lines starting at `p`
+ *
+ * @return const char* Start of the line after the last one read, or nullptr on a syntax error
+ */
+const char* sample_lines(const char* p, const char* end, size_t limit, JsonSchema& schema, std::string& error) {
+    std::vector<std::pair<std::string, std::string>> fields;
+    for (size_t taken = 0; p < end && taken < limit; ) {
+        const char* eol = line_end(p, end);
+        if (!is_blank(p, eol)) {
+            if (!detail::parse_json_record(p, eol, fields, error)) return nullptr;
+            schema.observe(fields);
+            taken++;
+        }
+        p = eol + 1;
+    }
+    return std::min(p, end);
+}
+
+/**
+ * @brief Discovers the fields and their types from the lines chosen by `sampling`
+ */
+bool sample_jsonl(const char* begin, const char* end, const SampleOptions& sampling, unsigned threads,
+                  JsonSchema& schema, std::string& error) {
+    if (sampling.mode == SampleMode::FullScan) {
+        auto chunks = split_lines(begin, end, std::max<size_t>(1 << 20, (end - begin) / threads + 1));
+        std::vector<JsonSchema> partial(chunks.size());
+        std::vector<std::string> errors(chunks.size());
+        std::vector<std::thread> pool;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            pool.emplace_back([&, i] {
+                sample_lines(chunks[i].first, chunks[i].second, static_cast<size_t>(-1), partial[i], errors[i]);
+            });
+        }
+        for (auto& t : pool) t.join();
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            if (!errors[i].empty()) {
+                error = errors[i];
+                return false;
+            }
+            schema.merge(partial[i]);  // Chunk order keeps the first-seen field order
+        }
+        return true;
+    }
+
+    const char* after_head = sample_lines(begin, end, std::max<size_t>(1, sampling.head_rows), schema, error);
+    if (!after_head) return false;
+    if (sampling.mode == SampleMode::Head || after_head >= end || sampling.sample_rows == 0) return true;
+
+    // One line at each of `sample_rows` offsets past the head, even or random
+    size_t span = end - after_head;
+    std::mt19937_64 rng(sampling.seed);
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < sampling.sample_rows; ++i) {
+        offsets.push_back(sampling.mode == SampleMode::Reservoir ? rng() % span : i * span / sampling.sample_rows);
+    }
+    std::sort(offsets.begin(), offsets.end());
+    const char* done = after_head;
+    for (size_t offset : offsets) {
+        const char* p = after_head + offset;
+        if (p > after_head && p[-1] != '\n') p = line_end(p, end) + 1;
+        if (p < done || p >= end) continue;
+        done = sample_lines(p, end, 1, schema, error);
+        if (!done) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses the lines of one chunk into a typed table batch
+ */
+void parse_chunk(const char* begin, const char* end, const JsonSchema& schema,
+                 const std::vector<I>& col_types, detail::IngestBatch& batch, size_t& ignored) {
+    size_t lines = static_cast<size_t>(std::count(begin, end, '\n'));
+    if (end > begin && end[-1] != '\n') lines++;
+    batch.bytes = end - begin;
+
+    TableBuilder builder(schema.names, col_types, std::max<size_t>(1, lines));
+    builder.reserve(lines);
+    std::vector<std::pair<std::string, std::string>> fields;
+    std::vector<std::string> row(schema.names.size());
+    for (const char* p = begin; p < end; ) {
+        const char* eol = line_end(p, end);
+        batch.lines++;
+        if (!is_blank(p, eol)) {
+            std::string error;
+            if (!detail::parse_json_record(p, eol, fields, error)) {
+                batch.error = "Malformed JSON: " + error;
+                batch.error_line = batch.lines;
+                return;
+            }
+            for (auto& field : row) field.clear();
+            for (auto& [name, value] : fields) {
+                auto it = schema.index.find(std::string_view(name));
+                if (it == schema.index.end()) {
+                    ignored++;
+                } else {
+                    row[it->second] = std::move(value);
+                }
+            }
+            builder.append_row(row);
+        }
+        p = eol + 1;
+    }
+
+    batch.rows = builder.rows();
+    batch.table = builder.take_table();
+}
+
+}  // namespace
+
+/**
+ * @brief Splits one JSON object into its fields
+ *
+ * Strings are unescaped, numbers and booleans are kept as written, `null`
+ * becomes an empty (null) field and nested objects or arrays are returned as
+ * their raw JSON text.
+ *
+ * @param begin Start of the line
+ * @param end End of the line (excluding newline)
+ * @param fields Receives name/value pairs in the order they appear (cleared first)
+ * @param error Receives a description of a syntax error
+ * @return bool False if the line is not a single JSON object
+ */
+bool detail::parse_json_record(const char* begin, const char* end,
+                               std::vector<std::pair<std::string, std::string>>& fields,
+                               std::string& error) {
+    fields.clear();
+    const char* p = begin;
+    skip_whitespace(p, end);
+    if (p == end || *p != '{') {
+        error = "expected '{' at start of record";
+        return false;
+    }
+    ++p;
+    skip_whitespace(p, end);
+    if (p < end && *p == '}') {
+        ++p;
+    } else {
+        std::string name;
+        std::string value;
+        while (true) {
+            skip_whitespace(p, end);
+            if (p == end || *p != '"') {
+                error = "expected field name";
+                return false;
+            }
+            if (!parse_string(p, end, name, error)) return false;
+            skip_whitespace(p, end);
+            if (p == end || *p != ':') {
+                error = "expected ':' after \"" + name + "\"";
+                return false;
+            }
+            ++p;
+            skip_whitespace(p, end);
+            if (!parse_value(p, end, value, error)) return false;
+            fields.emplace_back(name, value);
+
+            skip_whitespace(p, end);
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            if (p < end && *p == '}') {
+                ++p;
+                break;
+            }
+            error = "expected ',' or '}' after \"" + name + "\"";
+            return false;
+        }
+    }
+
+    skip_whitespace(p, end);
+    if (p != end) {
+        error = "unexpected text after the closing '}'";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Loads a JSON Lines file into a table
+ *
+ * The fields and their types come from the lines chosen by the sampling
+ * options (explicit types override the inferred ones). The text is then cut
+ * into chunks at line boundaries, parsed on a pool of worker threads and
+ * uploaded strictly in order from the calling thread, with workers kept at
+ * most a few chunks ahead to bound memory.
+ *
+ * @param table_name Name of the table to create
+ * @param filename Path to the JSON Lines file (may be gzip or zstd compressed)
+ * @param options Schema, sampling and threading options
+ * @param stats Receives row, byte and timing totals (optional)
+ * @return bool True if every line was loaded, false otherwise
+ */
+bool read_jsonl(const std::string& table_name,
+                const std::string& filename,
+                const JsonlOptions& options,
+                IngestStats* stats) {
+    auto started = std::chrono::steady_clock::now();
+
+    if (filename.empty() || table_name.empty()) {
+        std::cerr << "Error: Empty filename or table name." << std::endl;
+        return false;
+    }
+
+    detail::FileText text;
+    std::string error;
+    if (!detail::load_text(filename, text, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+
+    unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    JsonSchema schema;
+    if (!sample_jsonl(text.begin, text.end, options.sampling, threads, schema, error)) {
+        std::cerr << "Error: Malformed JSON in " << filename << " while sampling: " << error << std::endl;
+        return false;
+    }
+    for (const auto& [name, type] : options.column_types) schema.add(name);
+    if (schema.names.empty()) {
+        std::cerr << "Error: No records found in " << filename << std::endl;
+        return false;
+    }
+    if (!options.key_column.empty() && !schema.index.count(options.key_column)) {
+        std::cerr << "Error: Key column '" << options.key_column << "' not found in JSON fields." << std::endl;
+        return false;
+    }
+
+    std::vector<I> col_types = detail::infer_column_types(schema.columns);
+    for (const auto& [name, type] : options.column_types) {
+        std::vector<I> resolved;
+        if (!detail::resolve_column_types({type}, 1, resolved)) return false;
+        col_types[schema.index.at(name)] = resolved[0];
+    }
+
+    auto chunks = split_lines(text.begin, text.end, std::max<size_t>(1, options.chunk_bytes));
+
+    // Parse on the pool, upload in chunk order from this thread
+    IngestStats totals;
+    totals.files = 1;
+    std::vector<size_t> ignored(chunks.size(), 0);
+    bool ok = detail::upload_in_order(table_name, filename, chunks.size(), threads,
+                                      [&](size_t i, detail::IngestBatch& batch) {
+                                          parse_chunk(chunks[i].first, chunks[i].second, schema, col_types,
+                                                      batch, ignored[i]);
+                                      },
+                                      totals);
+    if (!ok) return false;
+
+    if (totals.rows == 0) {
+        std::cerr << "Error: No records found in " << filename << std::endl;
+        return false;
+    }
+
+    if (!detail::apply_key(table_name, options.key_column)) {
+        std::cerr << "Error: Failed to finish loading " << filename << std::endl;
+        return false;
+    }
+
+    size_t ignored_total = std::accumulate(ignored.begin(), ignored.end(), size_t{0});
+    if (ignored_total > 0) {
+        std::cerr << "Warning: " << ignored_total << " values of fields missing from the sampled lines were ignored;"
+                  << " use SampleMode::FullScan or column_types to include them." << std::endl;
+    }
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    detail::report_ingest(table_name, filename, totals);
+    if (stats) *stats = totals;
+    return true;
+}
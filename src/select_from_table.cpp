@@ -88,6 +88,7 @@ private:
             case -KT: return KDBValue::create_time(data->i);                         // Time
             case -KZ: return KDBValue::create_datetime(data->f);                     // DateTime
             case -KN: return KDBValue::create_timespan(data->j);                     // Timespan
+            case -KP: return KDBValue::create_timestamp(data->j);                    // Timestamp
             default:
                 std::cout << "Unknown atom type: " << static_cast<int>(data->t) << std::endl;
                 return KDBValue();
@@ -136,6 +137,7 @@ private:
             case KT: return KDBValue::create_time(kI(data)[idx]);                    // Time vector
             case KZ: return KDBValue::create_datetime(kF(data)[idx]);                // DateTime vector
             case KN: return KDBValue::create_timespan(kJ(data)[idx]);                // Timespan vector
+            case KP: return KDBValue::create_timestamp(kJ(data)[idx]);               // Timestamp vector
             default:
                 std::cout << "Unknown vector type: " << static_cast<int>(data->t) << std::endl;
                 return KDBValue();
@@ -836,4 +838,55 @@ KDBResult loc(const std::string& table_name, const std::string& conditions) {
     }
 }
 
-	
+/**
+ * @brief Reads the attribute of every column of a table via `meta`.
+ *
+ * @param table_name Name of the table in KDB+.
+ * @return std::vector<std::pair<std::string, Attribute>> Column names and attributes.
+ */
+std::vector<std::pair<std::string, Attribute>> get_attributes(const std::string& table_name) {
+    auto query_result = inline_query("exec c!a from meta `" + table_name);
+    K result = query_result.get_result();
+    if (!result || result->t != XD || kK(result)[0]->t != KS || kK(result)[1]->t != KS) {
+        std::cerr << "Failed to read the attributes of table '" << table_name << "'." << std::endl;
+        if (result) r0(result);
+        return {};
+    }
+
+    std::vector<std::pair<std::string, Attribute>> attributes;
+    K names = kK(result)[0];
+    K codes = kK(result)[1];
+    for (J i = 0; i < names->n; ++i) {
+        Attribute attribute = Attribute::None;
+        switch (kS(codes)[i][0]) {
+            case 's': attribute = Attribute::Sorted; break;
+            case 'u': attribute = Attribute::Unique; break;
+            case 'p': attribute = Attribute::Parted; break;
+            case 'g': attribute = Attribute::Grouped; break;
+            default: break;
+        }
+        attributes.emplace_back(kS(names)[i], attribute);
+    }
+    r0(result);
+    return attributes;
+}
+
+/**
+ * @brief Applies or removes an attribute on a column of a global table.
+ *
+ * @param table_name Name of the table in KDB+.
+ * @param column Column to change.
+ * @param attribute Attribute to set, or `Attribute::None` to remove it.
+ * @return bool True if the server applied it, false otherwise.
+ */
+bool set_attribute(const std::string& table_name, const std::string& column, Attribute attribute) {
+    static const char* const codes[] = {"", "s", "u", "p", "g"};
+    std::string code = codes[static_cast<int>(attribute)];
+    auto result = inline_query("update " + column + ":`" + code + "#" + column + " from `" + table_name);
+    if (K data = result.get_result()) r0(data);
+    if (!bool(result)) {
+        std::cerr << "Failed to set attribute on '" << table_name << "." << column << "'." << std::endl;
+        return false;
+    }
+    return true;
+}
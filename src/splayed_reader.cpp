@@ -0,0 +1,257 @@
+#include "splayed_reader.h"
+#include "symbol_cache.h"
+#include "type_map.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char COMPRESSED_MAGIC[] = "kxzipped";
+
+/**
+ * @brief Reads a vector header, checking the magic bytes and that `count` elements fit
+ *
+ * @param file Mapped vector file
+ * @param path Path used in error messages
+ * @param header Receives the header
+ * @return bool True if the header is valid
+ */
+bool read_header(const MappedFile& file, const std::string& path, splayed::VectorHeader& header) {
+    if (!file.is_open()) {
+        std::cerr << "Error: Unable to open " << path << std::endl;
+        return false;
+    }
+    if (file.size() >= sizeof(COMPRESSED_MAGIC) - 1 &&
+        std::memcmp(file.data(), COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC) - 1) == 0) {
+        std::cerr << "Error: " << path << " is compressed; only uncompressed columns can be mapped" << std::endl;
+        return false;
+    }
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Error: " << path << " is too short for a vector header" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != splayed::MAGIC || header.version != splayed::VERSION || header.count < 0) {
+        std::cerr << "Error: " << path << " does not have a kdb+ vector header" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Splits the null-terminated strings of a mapped symbol vector
+ *
+ * @return bool False if the file is not a symbol vector or holds fewer strings than its count
+ */
+bool read_symbols(const MappedFile& file, const std::string& path, std::vector<std::string_view>& symbols) {
+    splayed::VectorHeader header{};
+    if (!read_header(file, path, header)) return false;
+    if (header.type != KS) {
+        std::cerr << "Error: " << path << " is not a symbol vector" << std::endl;
+        return false;
+    }
+
+    symbols.clear();
+    symbols.reserve(static_cast<size_t>(header.count));
+    const char* p = file.data() + sizeof(header);
+    while (static_cast<int64_t>(symbols.size()) < header.count && p < file.end()) {
+        const char* nul = static_cast<const char*>(std::memchr(p, '\0', file.end() - p));
+        if (!nul) break;
+        symbols.emplace_back(p, nul - p);
+        p = nul + 1;
+    }
+    if (static_cast<int64_t>(symbols.size()) != header.count) {
+        std::cerr << "Error: Truncated symbol vector " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+namespace detail {
+
+/**
+ * @brief The strings of a `sym` file, mapped and split the first time they are needed
+ */
+class SymDomain {
+public:
+    explicit SymDomain(std::string path) : path_(std::move(path)) {}
+
+    /**
+     * @brief Symbol at `index`, or "" if the file is missing or the index is out of range
+     */
+    std::string_view at(splayed::EnumIndex index) {
+        std::call_once(loaded_, [this] { load(); });
+        if (index < 0 || static_cast<size_t>(index) >= symbols_.size()) return {};
+        return symbols_[static_cast<size_t>(index)];
+    }
+
+private:
+    void load() {
+        file_ = std::make_unique<MappedFile>(path_);
+        if (!read_symbols(*file_, path_, symbols_)) symbols_.clear();
+    }
+
+    std::string path_;
+    std::once_flag loaded_;
+    std::unique_ptr<MappedFile> file_;
+    std::vector<std::string_view> symbols_;
+};
+
+}  // namespace detail
+
+SymbolColumn::SymbolColumn(std::span<const splayed::EnumIndex> indices,
+                           std::shared_ptr<detail::SymDomain> domain)
+    : indices_(indices), domain_(std::move(domain)) {
+}
+
+std::string_view SymbolColumn::operator[](size_t row) const {
+    return domain_ ? domain_->at(indices_[row]) : std::string_view();
+}
+
+SplayedTable::SplayedTable(const std::string& table_dir, const std::string& sym_file) {
+    fs::path dir(table_dir);
+    std::string columns_path = (dir / splayed::COLUMNS_FILE).string();
+    MappedFile columns_file(columns_path);
+    std::vector<std::string_view> names;
+    if (!read_symbols(columns_file, columns_path, names)) return;
+
+    bool first = true;
+    for (std::string_view name : names) {
+        std::string path = (dir / name).string();
+        Column& column = columns_.emplace_back(path);
+        if (!validate_column(path, column)) return;
+
+        size_t count = reinterpret_cast<const splayed::VectorHeader*>(column.file.data())->count;
+        if (first) {
+            rows_ = count;
+            first = false;
+        } else if (count != rows_) {
+            std::cerr << "Error: Column " << name << " has " << count << " rows, expected " << rows_ << std::endl;
+            return;
+        }
+        names_.emplace_back(name);
+    }
+
+    // The domain is not opened here; tables without symbol columns never touch it
+    fs::path sym_path = sym_file;
+    if (sym_path.empty()) {
+        fs::path parent = fs::absolute(dir).lexically_normal();
+        if (!parent.has_filename()) parent = parent.parent_path();
+        parent = parent.parent_path();
+        sym_path = parent / splayed::SYM_FILE;
+        if (!fs::exists(sym_path) && parent.has_parent_path()) {
+            sym_path = parent.parent_path() / splayed::SYM_FILE;
+        }
+    }
+    domain_ = std::make_shared<detail::SymDomain>(sym_path.string());
+    open_ = true;
+}
+
+/**
+ * @brief Checks a mapped column's header, type and length
+ *
+ * @param path Path used in error messages
+ * @param column Column whose file is already mapped; type, attribute and data are filled in
+ * @return bool True if the column can be viewed in place
+ */
+bool SplayedTable::validate_column(const std::string& path, Column& column) {
+    splayed::VectorHeader header{};
+    if (!read_header(column.file, path, header)) return false;
+
+    size_t width = header.type == splayed::SYM_ENUM ? sizeof(splayed::EnumIndex)
+                 : header.type == KS ? 0 : element_size(header.type);
+    if (header.type <= 0 || width == 0) {
+        std::cerr << "Error: " << path << " has type " << static_cast<int>(header.type)
+                  << "; only simple and symbol-enumerated columns can be mapped" << std::endl;
+        return false;
+    }
+    if (column.file.size() < sizeof(header) + static_cast<size_t>(header.count) * width) {
+        std::cerr << "Error: " << path << " is shorter than its " << header.count << " elements" << std::endl;
+        return false;
+    }
+
+    column.type = header.type;
+    column.attribute = header.attribute;
+    column.data = column.file.data() + sizeof(header);
+    return true;
+}
+
+const SplayedTable::Column* SplayedTable::find(const std::string& name) const {
+    auto it = std::find(names_.begin(), names_.end(), name);
+    if (!open_ || it == names_.end()) return nullptr;
+    return &columns_[it - names_.begin()];
+}
+
+int SplayedTable::column_type(const std::string& name) const {
+    const Column* column = find(name);
+    if (!column) return 0;
+    return column->type == splayed::SYM_ENUM ? KS : column->type;
+}
+
+/**
+ * @brief Start of a column's elements if `T`'s size and kind match its storage
+ */
+const void* SplayedTable::typed_data(const std::string& name, size_t element_bytes, StorageKind kind) const {
+    const Column* column = find(name);
+    if (!column) {
+        std::cerr << "Error: No column '" << name << "' in splayed table" << std::endl;
+        return nullptr;
+    }
+
+    StorageKind stored = column->type == KB ? StorageKind::Boolean
+                       : column->type == KC ? StorageKind::Char
+                       : (column->type == KE || column->type == KF || column->type == KZ) ? StorageKind::Floating
+                       : StorageKind::Integer;
+    size_t width = column->type == splayed::SYM_ENUM ? sizeof(splayed::EnumIndex) : element_size(column->type);
+    if (stored != kind || width != element_bytes) {
+        std::cerr << "Error: Column '" << name << "' of type " << static_cast<int>(column->type)
+                  << " cannot be viewed with a " << element_bytes << "-byte element type" << std::endl;
+        return nullptr;
+    }
+    return column->data;
+}
+
+SymbolColumn SplayedTable::symbols(const std::string& name) const {
+    const Column* column = find(name);
+    if (!column || column->type != splayed::SYM_ENUM) {
+        std::cerr << "Error: Column '" << name << "' is not an enumerated symbol column" << std::endl;
+        return {};
+    }
+    return SymbolColumn({reinterpret_cast<const splayed::EnumIndex*>(column->data), rows_}, domain_);
+}
+
+K SplayedTable::slice(size_t first, size_t count) const {
+    if (!open_) return nullptr;
+    first = std::min(first, rows_);
+    count = std::min(count, rows_ - first);
+
+    K names = ktn(KS, static_cast<J>(names_.size()));
+    K values = ktn(0, static_cast<J>(columns_.size()));
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        const Column& column = columns_[col];
+        kS(names)[col] = ss(const_cast<S>(names_[col].c_str()));
+
+        K out;
+        if (column.type == splayed::SYM_ENUM) {
+            SymbolColumn syms = symbols(names_[col]);
+            out = ktn(KS, static_cast<J>(count));
+            for (size_t row = 0; row < count; ++row) {
+                kS(out)[row] = intern_symbol(syms[first + row]);
+            }
+        } else {
+            size_t width = element_size(column.type);
+            out = ktn(column.type, static_cast<J>(count));
+            out->u = column.attribute;  // Any contiguous run of a s#/u#/p#/g# column keeps the property
+            if (count) std::memcpy(kG(out), column.data + first * width, count * width);
+        }
+        kK(values)[col] = out;
+    }
+    return xT(xD(names, values));
+}
@@ -0,0 +1,256 @@
+#include "splayed_writer.h"
+#include "mapped_file.h"
+#include "read_csv.h"
+#include "type_map.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using FilePtr = std::unique_ptr<FILE, int (*)(FILE*)>;
+
+splayed::VectorHeader make_header(int8_t type, int64_t count) {
+    splayed::VectorHeader header{};
+    header.magic = splayed::MAGIC;
+    header.version = splayed::VERSION;
+    header.type = type;
+    header.count = count;
+    return header;
+}
+
+/**
+ * @brief Writes a vector file through a temporary name, then renames it into place
+ *
+ * Readers never see a half-written column, and a failed write leaves the
+ * previous file intact.
+ *
+ * @param path Destination file
+ * @param header Vector header
+ * @param data Element bytes following the header
+ * @param bytes Length of `data`
+ * @return bool True if the file was written and renamed
+ */
+bool write_vector_file(const fs::path& path, const splayed::VectorHeader& header,
+                       const void* data, size_t bytes) {
+    fs::path tmp = path;
+    tmp += ".tmp";
+
+    FilePtr file(std::fopen(tmp.string().c_str(), "wb"), &std::fclose);
+    if (!file) {
+        std::cerr << "Error: Unable to create " << tmp.string() << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&header, sizeof(header), 1, file.get()) == 1 &&
+              (bytes == 0 || std::fwrite(data, 1, bytes, file.get()) == bytes);
+    ok = std::fclose(file.release()) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Error: Failed writing " << tmp.string() << std::endl;
+        fs::remove(tmp);
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to rename " << tmp.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a list of strings as a kdb+ symbol vector file
+ */
+bool write_symbol_file(const fs::path& path, const std::vector<std::string>& symbols) {
+    std::string body;
+    for (const auto& s : symbols) {
+        body += s;
+        body += '\0';
+    }
+    return write_vector_file(path, make_header(KS, static_cast<int64_t>(symbols.size())),
+                             body.data(), body.size());
+}
+
+}  // namespace
+
+SplayedWriter::SplayedWriter(const std::string& db_root) : root_(db_root) {
+}
+
+/**
+ * @brief Reads the existing sym file, if any, so new symbols extend it
+ *
+ * @return bool False if a sym file exists but is not a symbol vector
+ */
+bool SplayedWriter::load_sym() {
+    if (sym_loaded_) return true;
+
+    std::error_code ec;
+    fs::create_directories(root_, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to create " << root_.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    fs::path path = root_ / splayed::SYM_FILE;
+    if (fs::exists(path)) {
+        MappedFile file(path.string());
+        splayed::VectorHeader header{};
+        if (!file.is_open() || file.size() < sizeof(header)) {
+            std::cerr << "Error: Unreadable sym file " << path.string() << std::endl;
+            return false;
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != splayed::MAGIC || header.type != KS) {
+            std::cerr << "Error: " << path.string() << " is not a symbol vector" << std::endl;
+            return false;
+        }
+
+        const char* p = file.data() + sizeof(header);
+        for (int64_t i = 0; i < header.count && p < file.end(); ++i) {
+            const char* nul = static_cast<const char*>(std::memchr(p, '\0', file.end() - p));
+            if (!nul) break;
+            sym_index_.emplace(std::string(p, nul), static_cast<J>(syms_.size()));
+            syms_.emplace_back(p, nul);
+            p = nul + 1;
+        }
+        if (static_cast<int64_t>(syms_.size()) != header.count) {
+            std::cerr << "Error: Truncated sym file " << path.string() << std::endl;
+            return false;
+        }
+    }
+
+    saved_syms_ = syms_.size();
+    sym_loaded_ = true;
+    return true;
+}
+
+/**
+ * @brief Rewrites the sym file if symbols were added since it was last saved
+ */
+bool SplayedWriter::save_sym() {
+    if (syms_.size() == saved_syms_) return true;
+    if (!write_symbol_file(root_ / splayed::SYM_FILE, syms_)) return false;
+    saved_syms_ = syms_.size();
+    return true;
+}
+
+/**
+ * @brief Maps a symbol vector to indices into the sym file, adding new symbols
+ *
+ * Symbols are interned, so lookups are cached by pointer and each distinct
+ * symbol is hashed as a string only once per column.
+ */
+std::vector<splayed::EnumIndex> SplayedWriter::enumerate(K symbols) {
+    std::vector<splayed::EnumIndex> indices(static_cast<size_t>(symbols->n));
+    std::unordered_map<S, J> seen;
+    for (J i = 0; i < symbols->n; ++i) {
+        S sym = kS(symbols)[i];
+        auto cached = seen.find(sym);
+        if (cached != seen.end()) {
+            indices[i] = cached->second;
+            continue;
+        }
+
+        std::string text = sym ? sym : "";
+        auto [it, added] = sym_index_.emplace(text, static_cast<J>(syms_.size()));
+        if (added) syms_.push_back(text);
+        seen.emplace(sym, it->second);
+        indices[i] = it->second;
+    }
+    return indices;
+}
+
+/**
+ * @brief Writes every column of a table, then its `.d` file and the sym file
+ *
+ * @param table_name Name of the table directory
+ * @param table Unkeyed table of simple columns (not released)
+ * @param partition Partition directory, or empty
+ * @return bool True if every file was written
+ */
+bool SplayedWriter::write_table(const std::string& table_name, K table, const std::string& partition) {
+    if (!table || table->t != XT) {
+        std::cerr << "Error: write_table expects an unkeyed table (use 0! on keyed tables)" << std::endl;
+        return false;
+    }
+    if (table_name.empty()) {
+        std::cerr << "Error: Empty table name." << std::endl;
+        return false;
+    }
+    if (!load_sym()) return false;
+
+    K names = kK(table->k)[0];
+    K columns = kK(table->k)[1];
+
+    fs::path dir = partition.empty() ? root_ / table_name : root_ / partition / table_name;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Error: Unable to create " << dir.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> column_names;
+    for (J col = 0; col < names->n; ++col) {
+        K column = kK(columns)[col];
+        std::string name = kS(names)[col];
+        column_names.push_back(name);
+
+        bool ok;
+        if (column->t == KS) {
+            auto indices = enumerate(column);
+            ok = write_vector_file(dir / name, make_header(splayed::SYM_ENUM, column->n),
+                                   indices.data(), indices.size() * sizeof(splayed::EnumIndex));
+        } else if (column->t > 0 && column->t < 20 && element_size(column->t) > 0) {
+            splayed::VectorHeader header = make_header(column->t, column->n);
+            header.attribute = column->u;
+            ok = write_vector_file(dir / name, header, kG(column), column->n * element_size(column->t));
+        } else {
+            std::cerr << "Error: Column " << name << " has type " << static_cast<int>(column->t)
+                      << ", only simple vectors can be splayed" << std::endl;
+            ok = false;
+        }
+        if (!ok) return false;
+    }
+
+    // The sym file must cover every index before the table becomes visible via .d
+    return save_sym() && write_symbol_file(dir / splayed::COLUMNS_FILE, column_names);
+}
+
+/**
+ * @brief Converts make_table-style rows with build_table and writes them
+ */
+bool SplayedWriter::write_table(const std::string& table_name,
+                                const std::vector<std::string>& column_names,
+                                const std::vector<std::vector<KDBType>>& data,
+                                const std::string& partition) {
+    K table = build_table(column_names, data);
+    if (!table) return false;
+    bool ok = write_table(table_name, table, partition);
+    r0(table);
+    return ok;
+}
+
+/**
+ * @brief Parses a CSV file on the client and writes it as a splayed table
+ */
+bool SplayedWriter::write_csv(const std::string& table_name,
+                              const std::string& filename,
+                              const std::string& partition,
+                              bool header,
+                              char delimiter,
+                              const std::vector<std::string>& column_types) {
+    K table = read_csv_table(filename, header, delimiter, column_types);
+    if (!table) return false;
+    bool ok = write_table(table_name, table, partition);
+    r0(table);
+    if (ok) {
+        std::cout << "Table '" << table_name << "' written to "
+                  << (partition.empty() ? root_ : root_ / partition).string() << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,115 @@
+#include "symbol_cache.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 1024;
+
+/**
+ * @brief Hashes 8 bytes at a time; symbols are short, so this is a handful of multiplies
+ */
+uint64_t hash_bytes(const char* p, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ n;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+        p += 8;
+        n -= 8;
+    }
+    if (n > 0) {
+        // Fixed-size loads for the tail: two overlapping words, or three bytes
+        uint64_t word;
+        if (n >= 4) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, p, 4);
+            std::memcpy(&hi, p + n - 4, 4);
+            word = lo | (uint64_t(hi) << 32);
+        } else {
+            word = uint8_t(p[0]) | (uint64_t(uint8_t(p[n / 2])) << 8) | (uint64_t(uint8_t(p[n - 1])) << 16);
+        }
+        h = (h ^ word) * 0xc4ceb9fe1a85ec53ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    return h ^ (h >> 29);
+}
+
+SymbolCache& thread_cache() {
+    thread_local SymbolCache cache;
+    return cache;
+}
+
+}  // namespace
+
+SymbolCache::SymbolCache(size_t max_entries)
+    : max_entries_(std::max<size_t>(1, max_entries)) {
+}
+
+S SymbolCache::intern(std::string_view text) {
+    if (slots_.empty()) rehash(INITIAL_SLOTS);
+
+    uint64_t hash = hash_bytes(text.data(), text.size());
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+        const Slot& entry = slots_[slot];
+        if (!entry.symbol) return insert(text, hash, slot);
+        if (entry.hash == hash && entry.length == text.size() &&
+            (text.empty() || std::memcmp(entry.symbol, text.data(), text.size()) == 0)) {
+            hits_++;
+            return entry.symbol;
+        }
+    }
+}
+
+/**
+ * @brief Interns a string that is not cached and stores it in the empty `slot`
+ */
+S SymbolCache::insert(std::string_view text, uint64_t hash, size_t slot) {
+    misses_++;
+    S symbol = text.empty() ? ss(const_cast<S>("")) : sn(const_cast<S>(text.data()), static_cast<I>(text.size()));
+    if (size_ >= max_entries_) {
+        clear();
+        rehash(INITIAL_SLOTS);
+        slot = hash & (slots_.size() - 1);
+    } else if ((size_ + 1) * 2 > slots_.size()) {
+        rehash(slots_.size() * 2);
+        for (slot = hash & (slots_.size() - 1); slots_[slot].symbol; slot = (slot + 1) & (slots_.size() - 1)) {}
+    }
+    slots_[slot] = {hash, symbol, text.size()};
+    size_++;
+    return symbol;
+}
+
+void SymbolCache::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{0, nullptr, 0});
+    old.swap(slots_);
+    size_t mask = capacity - 1;
+    for (const Slot& entry : old) {
+        if (!entry.symbol) continue;
+        size_t slot = entry.hash & mask;
+        while (slots_[slot].symbol) slot = (slot + 1) & mask;
+        slots_[slot] = entry;
+    }
+}
+
+void SymbolCache::intern_all(std::span<const std::string> values, S* out) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        out[i] = i > 0 && values[i] == values[i - 1] ? out[i - 1] : intern(values[i]);
+    }
+}
+
+void SymbolCache::clear() {
+    slots_.clear();
+    size_ = 0;
+}
+
+S intern_symbol(std::string_view text) {
+    return thread_cache().intern(text);
+}
+
+void intern_symbols(std::span<const std::string> values, S* out) {
+    thread_cache().intern_all(values, out);
+}
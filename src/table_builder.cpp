@@ -0,0 +1,131 @@
+#include "table_builder.h"
+#include "inline_query.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+constexpr size_t INITIAL_ROWS = 1024;
+
+}  // namespace
+
+TableBuilder::TableBuilder(std::vector<std::string> column_names,
+                           const std::vector<I>& column_types,
+                           size_t batch_rows)
+    : names_(std::move(column_names)),
+      columns_(names_.size(), nullptr),
+      batch_rows_(batch_rows == 0 ? 1 : batch_rows) {
+    valid_ = names_.size() == column_types.size() && !names_.empty();
+    for (I type : column_types) {
+        const TypeInfo* info = find_type_info(type);
+        if (!info) valid_ = false;
+        types_.push_back(info);
+    }
+}
+
+TableBuilder::~TableBuilder() {
+    for (K column : columns_) {
+        if (column) r0(column);
+    }
+}
+
+/**
+ * @brief Resizes the current batch to `capacity` rows, keeping the rows filled so far
+ */
+void TableBuilder::allocate(size_t capacity) {
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        K grown = ktn(types_[col]->kdb_type, static_cast<J>(capacity));
+        if (K old = columns_[col]) {
+            std::memcpy(kG(grown), kG(old), rows_ * element_size(old->t));
+            r0(old);
+        }
+        columns_[col] = grown;
+    }
+    capacity_ = capacity;
+}
+
+void TableBuilder::reserve(size_t rows) {
+    rows = std::min(rows, batch_rows_);
+    if (valid_ && rows > capacity_) allocate(rows);
+}
+
+void TableBuilder::append_row(const std::vector<std::string>& fields) {
+    if (!valid_ || rows_ == batch_rows_) return;
+    if (rows_ == capacity_) {
+        allocate(std::min(batch_rows_, std::max(INITIAL_ROWS, capacity_ * 2)));
+    }
+
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        const TypeInfo* info = types_[col];
+        K column = columns_[col];
+        if (col >= fields.size() || fields[col].empty()) {
+            info->null_assigner(column, rows_);
+            continue;
+        }
+        try {
+            info->value_assigner(column, fields[col], rows_);
+        } catch (...) {
+            info->null_assigner(column, rows_);
+        }
+    }
+    rows_++;
+}
+
+bool TableBuilder::validate_row(const std::vector<std::string>& fields, std::string& reason) const {
+    if (fields.size() != types_.size()) {
+        reason = "expected " + std::to_string(types_.size()) + " fields, found " + std::to_string(fields.size());
+        return false;
+    }
+    for (size_t col = 0; col < fields.size(); ++col) {
+        const TypeInfo* info = types_[col];
+        if (fields[col].empty() || !info || !info->validator || info->validator(fields[col])) continue;
+        reason = "column '" + names_[col] + "': cannot parse '" + fields[col] + "' as " + info->name;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Trims the batch to the rows filled and wraps it in a table
+ *
+ * The vectors keep their allocation; only the length field is reduced, which
+ * is what gets serialised.
+ */
+K TableBuilder::take_table() {
+    if (rows_ == 0 || !valid_) return nullptr;
+
+    K names = ktn(KS, static_cast<J>(names_.size()));
+    K values = ktn(0, static_cast<J>(columns_.size()));
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        kS(names)[col] = ss(const_cast<S>(names_[col].c_str()));
+        columns_[col]->n = static_cast<J>(rows_);
+        kK(values)[col] = columns_[col];
+        columns_[col] = nullptr;
+    }
+    rows_ = 0;
+    capacity_ = 0;
+    return xT(xD(names, values));
+}
+
+/**
+ * @brief Sends a client-built table to the server with `set` or `upsert`
+ *
+ * @param table_name Name of the global to write
+ * @param table Table to send, released by the call
+ * @param append Upsert into the existing table instead of replacing it
+ * @return bool True if the server accepted the table
+ */
+bool upload_table(const std::string& table_name, K table, bool append) {
+    if (!table) return false;
+
+    auto result = inline_query(append ? "upsert" : "set",
+                               {ks(const_cast<S>(table_name.c_str())), table});
+    if (K data = result.get_result()) r0(data);  // Both return the table name
+    if (!bool(result)) {
+        std::cerr << "Error: Failed to upload rows to table '" << table_name << "'." << std::endl;
+        return false;
+    }
+    return true;
+}
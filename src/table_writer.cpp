@@ -0,0 +1,310 @@
+#include "table_writer.h"
+#include "inline_query.h"
+#include "read_csv.h"
+#include "symbol_cache.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+constexpr size_t INITIAL_ROWS = 1024;
+constexpr I KDB_EPOCH_DAYS = 10957;                    ///< Days from 1970.01.01 to 2000.01.01
+constexpr J KDB_EPOCH_NANOS = 946684800000000000LL;    ///< Nanoseconds from 1970.01.01 to 2000.01.01
+
+/**
+ * @brief Stores one variant in row `row` of a typed column
+ *
+ * @return bool False if the alternative cannot represent the column's type
+ */
+bool store_value(K column, const TypeInfo* info, const KDBType& value, size_t row) {
+    I type = info->kdb_type;
+    if (std::holds_alternative<std::monostate>(value)) {
+        info->null_assigner(column, row);
+        return true;
+    }
+    if (const bool* b = std::get_if<bool>(&value)) {
+        if (type != KB) return false;
+        kG(column)[row] = *b;
+        return true;
+    }
+    if (std::holds_alternative<int>(value) || std::holds_alternative<int64_t>(value)) {
+        J i = std::holds_alternative<int>(value) ? std::get<int>(value) : std::get<int64_t>(value);
+        switch (type) {
+            case KG: kG(column)[row] = static_cast<G>(i); return true;
+            case KH: kH(column)[row] = static_cast<H>(i); return true;
+            case KI: kI(column)[row] = static_cast<I>(i); return true;
+            case KJ: kJ(column)[row] = i; return true;
+            case KE: kE(column)[row] = static_cast<E>(i); return true;
+            case KF: kF(column)[row] = static_cast<F>(i); return true;
+            default: return false;
+        }
+    }
+    if (std::holds_alternative<double>(value) || std::holds_alternative<float>(value)) {
+        F d = std::holds_alternative<double>(value) ? std::get<double>(value) : std::get<float>(value);
+        switch (type) {
+            case KE: kE(column)[row] = static_cast<E>(d); return true;
+            case KF: kF(column)[row] = d; return true;
+            default: return false;
+        }
+    }
+    if (const auto* ts = std::get_if<std::chrono::sys_time<std::chrono::nanoseconds>>(&value)) {
+        if (type != KP) return false;
+        kJ(column)[row] = ts->time_since_epoch().count() - KDB_EPOCH_NANOS;
+        return true;
+    }
+    if (const auto* date = std::get_if<std::chrono::sys_days>(&value)) {
+        if (type != KD) return false;
+        kI(column)[row] = static_cast<I>(date->time_since_epoch().count() - KDB_EPOCH_DAYS);
+        return true;
+    }
+    if (const auto* span = std::get_if<std::chrono::nanoseconds>(&value)) {
+        if (type != KN) return false;
+        kJ(column)[row] = span->count();
+        return true;
+    }
+    if (const Guid* guid = std::get_if<Guid>(&value)) {
+        if (type != UU) return false;
+        std::memcpy(kU(column)[row].g, guid->bytes.data(), 16);
+        return true;
+    }
+    if (std::holds_alternative<CharString>(value)) return false;  // Only simple vector columns are buffered
+
+    // Strings are symbols, or text parsed by the type map for any other column
+    const std::string& text = std::get<std::string>(value);
+    if (type == KS) {
+        kS(column)[row] = intern_symbol(text);
+        return true;
+    }
+    try {
+        info->value_assigner(column, text, row);
+    } catch (...) {
+        info->null_assigner(column, row);
+    }
+    return true;
+}
+
+}  // namespace
+
+TableWriter::TableWriter(std::string table_name,
+                         std::vector<std::string> column_names,
+                         const std::vector<std::string>& column_types,
+                         TableWriterOptions options)
+    : table_name_(std::move(table_name)),
+      names_(std::move(column_names)),
+      options_(std::move(options)),
+      columns_(names_.size(), nullptr) {
+    options_.batch_rows = std::max<size_t>(1, options_.batch_rows);
+    options_.max_in_flight = std::max<size_t>(1, options_.max_in_flight);
+
+    std::vector<I> codes;
+    if (table_name_.empty() || names_.empty() ||
+        !detail::resolve_column_types(column_types, names_.size(), codes)) {
+        std::cerr << "Error: TableWriter needs a table name and a type for each column." << std::endl;
+        valid_ = false;
+        return;
+    }
+    for (size_t col = 0; col < codes.size(); ++col) {
+        const TypeInfo* info = find_type_info(codes[col]);
+        if (!info || element_size(codes[col]) == 0) {
+            std::cerr << "Error: Column '" << names_[col] << "' of type " << column_types[col]
+                      << " is not a simple vector type." << std::endl;
+            valid_ = false;
+        }
+        types_.push_back(info);
+    }
+}
+
+TableWriter::~TableWriter() {
+    if (valid_) sync();
+    for (K column : columns_) {
+        if (column) r0(column);
+    }
+}
+
+/**
+ * @brief Resizes the current batch to `capacity` rows, keeping the rows filled so far
+ */
+void TableWriter::allocate(size_t capacity) {
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        K grown = ktn(types_[col]->kdb_type, static_cast<J>(capacity));
+        if (K old = columns_[col]) {
+            std::memcpy(kG(grown), kG(old), rows_ * element_size(old->t));
+            r0(old);
+        }
+        columns_[col] = grown;
+    }
+    capacity_ = capacity;
+}
+
+bool TableWriter::write(const std::vector<KDBType>& row) {
+    if (!valid_) return false;
+    if (row.size() != names_.size()) {
+        std::cerr << "Error: Expected " << names_.size() << " values, found " << row.size() << std::endl;
+        return false;
+    }
+    if (rows_ == capacity_) {
+        allocate(std::min(options_.batch_rows, std::max(INITIAL_ROWS, capacity_ * 2)));
+    }
+
+    // A rejected row leaves the slot to be overwritten by the next one
+    for (size_t col = 0; col < names_.size(); ++col) {
+        if (!store_value(columns_[col], types_[col], row[col], rows_)) {
+            std::cerr << "Error: Column '" << names_[col] << "' of type " << types_[col]->name
+                      << " cannot hold the value given." << std::endl;
+            return false;
+        }
+    }
+    if (rows_++ == 0) oldest_ = std::chrono::steady_clock::now();
+    return rows_ == options_.batch_rows ? flush() : poll();
+}
+
+bool TableWriter::write_columns(std::vector<TableColumn>&& columns) {
+    if (!valid_) return false;
+    K table = build_table(std::move(columns));
+    return table && write_table(table);
+}
+
+bool TableWriter::write_table(K table) {
+    if (!table) return false;
+    if (!valid_ || table->t != XT) {
+        if (valid_) std::cerr << "Error: TableWriter expects an unkeyed table." << std::endl;
+        r0(table);
+        return false;
+    }
+    K values = kK(table->k)[1];
+    if (static_cast<size_t>(values->n) != names_.size()) {
+        std::cerr << "Error: Expected " << names_.size() << " columns, found " << values->n << std::endl;
+        r0(table);
+        return false;
+    }
+    for (size_t col = 0; col < names_.size(); ++col) {
+        if (kK(values)[col]->t != types_[col]->kdb_type) {
+            std::cerr << "Error: Column '" << names_[col] << "' has type " << static_cast<int>(kK(values)[col]->t)
+                      << ", expected " << types_[col]->kdb_type << std::endl;
+            r0(table);
+            return false;
+        }
+    }
+
+    size_t count = static_cast<size_t>(kK(values)[0]->n);
+    if (rows_ == 0 && count >= options_.batch_rows) {
+        // Send as it is, under the writer's column names
+        K names = ktn(KS, static_cast<J>(names_.size()));
+        for (size_t col = 0; col < names_.size(); ++col) {
+            kS(names)[col] = ss(const_cast<S>(names_[col].c_str()));
+        }
+        r0(kK(table->k)[0]);
+        kK(table->k)[0] = names;
+        return send(table);
+    }
+
+    bool ok = append_rows(table, 0, count);
+    r0(table);
+    return ok && poll();
+}
+
+/**
+ * @brief Copies rows `[first, first + count)` of a checked table into the batch, sending full batches
+ */
+bool TableWriter::append_rows(K table, size_t first, size_t count) {
+    K values = kK(table->k)[1];
+    while (count > 0) {
+        if (rows_ == capacity_) {
+            allocate(std::min(options_.batch_rows, std::max({INITIAL_ROWS, capacity_ * 2, rows_ + count})));
+        }
+        size_t n = std::min(count, capacity_ - rows_);
+        for (size_t col = 0; col < names_.size(); ++col) {
+            size_t width = element_size(types_[col]->kdb_type);
+            std::memcpy(kG(columns_[col]) + rows_ * width, kG(kK(values)[col]) + first * width, n * width);
+        }
+        if (rows_ == 0) oldest_ = std::chrono::steady_clock::now();
+        rows_ += n;
+        first += n;
+        count -= n;
+        if (rows_ == options_.batch_rows && !flush()) return false;
+    }
+    return true;
+}
+
+bool TableWriter::poll() {
+    if (rows_ == 0 || options_.max_age.count() == 0) return true;
+    if (std::chrono::steady_clock::now() - oldest_ < options_.max_age) return true;
+    return flush();
+}
+
+bool TableWriter::flush() {
+    if (!valid_) return false;
+    K batch = take_batch();
+    return !batch || send(batch);
+}
+
+bool TableWriter::sync() {
+    if (!flush()) return false;
+    if (in_flight_ == 0) return true;
+
+    // Messages on a handle are processed in order, so this returns after every batch before it
+    in_flight_ = 0;
+    auto result = inline_query("::");
+    if (K data = result.get_result()) r0(data);
+    return bool(result);
+}
+
+/**
+ * @brief Trims the batch to the rows filled and wraps it in a table
+ */
+K TableWriter::take_batch() {
+    if (rows_ == 0) return nullptr;
+
+    K names = ktn(KS, static_cast<J>(names_.size()));
+    K values = ktn(0, static_cast<J>(columns_.size()));
+    for (size_t col = 0; col < columns_.size(); ++col) {
+        kS(names)[col] = ss(const_cast<S>(names_[col].c_str()));
+        columns_[col]->n = static_cast<J>(rows_);
+        kK(values)[col] = columns_[col];
+        columns_[col] = nullptr;
+    }
+    rows_ = 0;
+    capacity_ = 0;
+    return xT(xD(names, values));
+}
+
+/**
+ * @brief Applies the write function to one batch, waiting for the server as the window requires
+ *
+ * @param batch Table to send, released by the call
+ */
+bool TableWriter::send(K batch) {
+    size_t count = static_cast<size_t>(kK(kK(batch->k)[1])[0]->n);
+    K name = ks(const_cast<S>(table_name_.c_str()));
+
+    if (options_.async) {
+        I handle;
+        try {
+            handle = KDBConnection::getHandle();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            r0(name);
+            r0(batch);
+            return false;
+        }
+        if (!k(-handle, const_cast<S>(options_.function.c_str()), name, batch, (K)0)) {
+            std::cerr << "Error: Network error sending rows to table '" << table_name_ << "'." << std::endl;
+            return false;
+        }
+        rows_sent_ += count;
+        batches_sent_++;
+        return ++in_flight_ < options_.max_in_flight || sync();
+    }
+
+    auto result = inline_query(options_.function, {name, batch});
+    if (K data = result.get_result()) r0(data);
+    if (!bool(result)) {
+        std::cerr << "Error: Failed to upload rows to table '" << table_name_ << "'." << std::endl;
+        return false;
+    }
+    rows_sent_ += count;
+    batches_sent_++;
+    return true;
+}
@@ -1,9 +1,13 @@
 #include "type_map.h"
+#include "symbol_cache.h"
 #include <limits>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
-#include <regex>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <chrono>
 #include <ctime>
 #include "k.h"
@@ -15,100 +19,301 @@
 #include <iomanip>
 #include <iostream>
 
+namespace {
+
+constexpr J NANOS_PER_SECOND = 1000000000LL;
+constexpr J NANOS_PER_MINUTE = 60 * NANOS_PER_SECOND;
+constexpr J NANOS_PER_HOUR = 60 * NANOS_PER_MINUTE;
+constexpr J NANOS_PER_DAY = 24 * NANOS_PER_HOUR;
+constexpr I KDB_EPOCH_DAYS = 10957;  ///< Days from 1970.01.01 to the kdb+ epoch 2000.01.01
+
+/**
+ * @brief Converts a civil date to days since 2000.01.01 using integer arithmetic only.
+ * @note Proleptic Gregorian calendar, valid for any year representable in an int.
+ */
+I days_from_civil(I y, I m, I d) {
+    y -= m <= 2;
+    const I era = (y >= 0 ? y : y - 399) / 400;
+    const I yoe = y - era * 400;
+    const I doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const I doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468 - KDB_EPOCH_DAYS;
+}
+
+/**
+ * @brief Converts days since 2000.01.01 back to a civil year, month and day.
+ */
+void civil_from_days(I days, I& y, I& m, I& d) {
+    const I z = days + KDB_EPOCH_DAYS + 719468;
+    const I era = (z >= 0 ? z : z - 146096) / 146097;
+    const I doe = z - era * 146097;
+    const I yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const I doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const I mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = yoe + era * 400 + (m <= 2);
+}
+
+/**
+ * @brief Reads exactly `count` decimal digits and advances `p`.
+ */
+bool read_digits(const char*& p, const char* end, int count, I& value) {
+    if (end - p < count) return false;
+    value = 0;
+    for (int i = 0; i < count; ++i, ++p) {
+        if (*p < '0' || *p > '9') return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+/**
+ * @brief Parses "YYYY-MM-DD" or kdb+ "YYYY.MM.DD" into days since 2000.01.01.
+ */
+bool parse_date_part(const char*& p, const char* end, I& days) {
+    I y, m, d;
+    if (!read_digits(p, end, 4, y) || p == end) return false;
+    const char sep = *p++;
+    if (sep != '-' && sep != '.') return false;
+    if (!read_digits(p, end, 2, m) || p == end || *p++ != sep) return false;
+    if (!read_digits(p, end, 2, d)) return false;
+
+    static const I month_days[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (m < 1 || m > 12 || d < 1 || d > month_days[m - 1]) return false;
+    const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    if (m == 2 && d == 29 && !leap) return false;
+
+    days = days_from_civil(y, m, d);
+    return true;
+}
+
+/**
+ * @brief Parses "hh:mm[:ss[.fffffffff]]" into nanoseconds since midnight.
+ *
+ * Fractions are read up to nanosecond precision; any further digits are
+ * accepted and truncated.
+ *
+ * @param require_seconds Reject "hh:mm" when true.
+ * @param max_hours Exclusive upper bound for the hour field.
+ */
+bool parse_clock_part(const char*& p, const char* end, J& nanos,
+                      bool require_seconds, I max_hours = 24) {
+    I hh, mm, ss = 0;
+    if (!read_digits(p, end, 2, hh) || p == end || *p++ != ':') return false;
+    if (!read_digits(p, end, 2, mm)) return false;
+    if (p < end && *p == ':') {
+        ++p;
+        if (!read_digits(p, end, 2, ss)) return false;
+    } else if (require_seconds) {
+        return false;
+    }
+    if (hh >= max_hours || mm >= 60 || ss >= 60) return false;
+
+    J fraction = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        int digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits) {
+            if (digits < 9) fraction = fraction * 10 + (*p - '0');
+        }
+        if (digits == 0) return false;
+        for (; digits < 9; ++digits) fraction *= 10;
+    }
+
+    nanos = hh * NANOS_PER_HOUR + mm * NANOS_PER_MINUTE + ss * NANOS_PER_SECOND + fraction;
+    return true;
+}
+
+/**
+ * @brief Parses a date and time of day joined by 'T', ' ' or kdb+'s 'D'.
+ * @return bool True if the whole string was consumed.
+ */
+bool parse_timestamp_nanos(const std::string& s, J& nanos) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    I days;
+    J clock;
+    if (!parse_date_part(p, end, days) || p == end) return false;
+    if (*p != 'T' && *p != ' ' && *p != 'D') return false;
+    ++p;
+    if (!parse_clock_part(p, end, clock, true) || p != end) return false;
+    nanos = days * NANOS_PER_DAY + clock;
+    return true;
+}
+
+/**
+ * @brief Formats days since 2000.01.01 as "YYYY-MM-DD".
+ */
+std::string format_civil_date(I days) {
+    I y, m, d;
+    civil_from_days(days, y, m, d);
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", y, m, d);
+    return buf;
+}
+
+/**
+ * @brief Formats nanoseconds since midnight as "HH:MM:SS" plus `fraction_digits` decimals.
+ */
+std::string format_clock(J nanos, int fraction_digits) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%02lld:%02lld:%02lld",
+                  nanos / NANOS_PER_HOUR,
+                  (nanos % NANOS_PER_HOUR) / NANOS_PER_MINUTE,
+                  (nanos % NANOS_PER_MINUTE) / NANOS_PER_SECOND);
+    std::string out = buf;
+
+    // Leading digits of the nanoseconds, at most nine of them, written by hand
+    int digits = std::clamp(fraction_digits, 0, 9);
+    if (digits > 0) {
+        J fraction = nanos % NANOS_PER_SECOND;
+        for (int i = digits; i < 9; ++i) fraction /= 10;
+        char text[9];
+        for (int i = digits - 1; i >= 0; --i) {
+            text[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        out += '.';
+        out.append(text, digits);
+    }
+    return out;
+}
+
+}  // namespace
+
 namespace detail {
 
 /**
- * @brief Parses a date string in "YYYY-MM-DD" format to a kdb+ integer date.
+ * @brief Parses a date string in "YYYY-MM-DD" (or kdb+ "YYYY.MM.DD") format to a kdb+ integer date.
  * @param s The input date string.
  * @return I The integer representation of the date (days since 2000-01-01) or `ni` if parsing fails.
  */
 I parse_date(const std::string& s) {
-    std::tm tm = {};
-    std::istringstream ss(s);
-    ss >> std::get_time(&tm, "%Y-%m-%d");
-    if (ss.fail()) return ni;
-    std::time_t time = std::mktime(&tm);
-    if (time == -1) return ni;
-    return static_cast<I>((time - 946684800LL) / 86400);
+    const char* p = s.data();
+    const char* end = p + s.size();
+    I days;
+    if (!parse_date_part(p, end, days) || p != end) return ni;
+    return days;
 }
 
 /**
- * @brief Parses a datetime string in "YYYY-MM-DD HH:MM:SS" format to a kdb+ float datetime.
+ * @brief Parses a datetime string in "YYYY-MM-DD HH:MM:SS[.fff]" format to a kdb+ float datetime.
  * @param s The input datetime string.
  * @return F The float representation of the datetime (days since 2000-01-01) or `nf` if parsing fails.
  */
 F parse_datetime(const std::string& s) {
-    std::tm tm = {};
-    std::istringstream ss(s);
-    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-    if (ss.fail()) return nf;
-    std::time_t time = std::mktime(&tm);
-    if (time == -1) return nf;
-    return static_cast<F>((time - 946684800LL) / 86400.0);
+    J nanos;
+    if (!parse_timestamp_nanos(s, nanos)) return nf;
+    return static_cast<F>(nanos) / static_cast<F>(NANOS_PER_DAY);
 }
 
 /**
- * @brief Parses a time string in "HH:MM:SS" format to a kdb+ integer time in milliseconds.
+ * @brief Parses a time string in "HH:MM:SS[.fff]" format to a kdb+ integer time in milliseconds.
  * @param s The input time string.
  * @return I The integer representation of time in milliseconds or `ni` if parsing fails.
  */
 I parse_time(const std::string& s) {
-    std::tm tm = {};
-    std::istringstream ss(s);
-    ss >> std::get_time(&tm, "%H:%M:%S");
-    if (ss.fail()) return ni;
-    return (tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec) * 1000;
+    const char* p = s.data();
+    const char* end = p + s.size();
+    J nanos;
+    if (!parse_clock_part(p, end, nanos, true) || p != end) return ni;
+    return static_cast<I>(nanos / 1000000);
 }
 
-}  // namespace detail
+/**
+ * @brief Parses an ISO ("YYYY-MM-DD HH:MM:SS.ffffff", 'T' or space separated) or kdb+
+ *        ("YYYY.MM.DDDHH:MM:SS.fffffffff") timestamp to nanoseconds since 2000-01-01.
+ * @param s The input timestamp string.
+ * @return J The kdb+ timestamp or `nj` if parsing fails.
+ */
+J parse_timestamp(const std::string& s) {
+    J nanos;
+    return parse_timestamp_nanos(s, nanos) ? nanos : nj;
+}
 
-// Validation helper functions
-namespace {
+/**
+ * @brief Parses a timespan string in "[-][d]DHH:MM:SS[.fffffffff]" format to nanoseconds.
+ * @param s The input timespan string.
+ * @return J The kdb+ timespan or `nj` if parsing fails.
+ */
+J parse_timespan(const std::string& s) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+
+    J days = 0;
+    const char* day_marker = static_cast<const char*>(std::memchr(p, 'D', end - p));
+    if (day_marker) {
+        for (; p < day_marker; ++p) {
+            if (*p < '0' || *p > '9') return nj;
+            days = days * 10 + (*p - '0');
+        }
+        ++p;
+    }
+
+    J clock;
+    if (!parse_clock_part(p, end, clock, true) || p != end) return nj;
+    J nanos = days * NANOS_PER_DAY + clock;
+    return negative ? -nanos : nanos;
+}
 
 /**
- * @brief Validates if a string represents an integer.
- * @param s The input string.
- * @return bool True if the string represents a valid integer, false otherwise.
+ * @brief Parses a month string in "YYYY.MM" or "YYYY-MM" format, with an optional 'm' suffix.
+ * @param s The input month string.
+ * @return I Months since 2000.01 or `ni` if parsing fails.
  */
-bool is_integer(const std::string& s) {
-    if (s.empty()) return false;
-    char* end = nullptr;
-    std::strtol(s.c_str(), &end, 10);
-    return end != s.c_str() && *end == '\0';
+I parse_month(const std::string& s) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    I y, m;
+    if (!read_digits(p, end, 4, y) || p == end || (*p != '.' && *p != '-')) return ni;
+    ++p;
+    if (!read_digits(p, end, 2, m) || m < 1 || m > 12) return ni;
+    if (p < end && *p == 'm') ++p;
+    if (p != end) return ni;
+    return (y - 2000) * 12 + (m - 1);
 }
 
 /**
- * @brief Validates if a string represents a float.
- * @param s The input string.
- * @return bool True if the string represents a valid float, false otherwise.
+ * @brief Parses a minute string in "HH:MM" format.
+ * @param s The input minute string.
+ * @return I Minutes since midnight or `ni` if parsing fails.
  */
-bool is_float(const std::string& s) {
-    if (s.empty()) return false;
-    char* end = nullptr;
-    std::strtod(s.c_str(), &end);
-    return end != s.c_str() && *end == '\0';
+I parse_minute(const std::string& s) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    J nanos;
+    if (s.size() != 5 || !parse_clock_part(p, end, nanos, false) || p != end) return ni;
+    return static_cast<I>(nanos / NANOS_PER_MINUTE);
 }
 
 /**
- * @brief Validates if a string represents a boolean value.
- * Acceptable values are case-insensitive "true", "false", "1", or "0".
- * @param s The input string.
- * @return bool True if the string represents a valid boolean, false otherwise.
+ * @brief Parses a second string in "HH:MM:SS" format.
+ * @param s The input second string.
+ * @return I Seconds since midnight or `ni` if parsing fails.
  */
-bool is_boolean(const std::string& s) {
-    std::string lower = s;
-    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-    return (lower == "true" || lower == "false" || lower == "1" || lower == "0");
+I parse_second(const std::string& s) {
+    const char* p = s.data();
+    const char* end = p + s.size();
+    J nanos;
+    if (s.size() != 8 || !parse_clock_part(p, end, nanos, true) || p != end) return ni;
+    return static_cast<I>(nanos / NANOS_PER_SECOND);
 }
 
+}  // namespace detail
+
+// Validation helper functions
+namespace {
+
 /**
  * @brief Validates if a string matches the "YYYY-MM-DD" date format.
  * @param s The input string.
  * @return bool True if the string matches the date format, false otherwise.
  */
 bool is_date(const std::string& s) {
-    static const std::regex date_regex(R"(\d{4}-\d{2}-\d{2})");
-    return std::regex_match(s, date_regex);
+    return s.size() == 10 && detail::parse_date(s) != ni;
 }
 
 /**
@@ -118,10 +323,8 @@ bool is_date(const std::string& s) {
  * @return bool True if the string matches the datetime format, false otherwise.
  */
 bool is_datetime(const std::string& s) {
-    static const std::regex datetime_regex(
-        R"(\d{4}-\d{2}-\d{2}[T ]\d{2}:\d{2}:\d{2}(\.\d+)?)"
-    );
-    return std::regex_match(s, datetime_regex);
+    J nanos;
+    return s.size() >= 19 && s[10] != 'D' && parse_timestamp_nanos(s, nanos);
 }
 
 /**
@@ -130,32 +333,28 @@ bool is_datetime(const std::string& s) {
  * @return bool True if the string matches the time format, false otherwise.
  */
 bool is_time(const std::string& s) {
-    static const std::regex time_regex(R"(\d{2}:\d{2}:\d{2}(\.\d+)?)");
-    return std::regex_match(s, time_regex);
+    return detail::parse_time(s) != ni;
 }
 
 /**
- * @brief Validates if a string matches the "YYYY.MM.DD D HH:MM:SS.fffffffff" timestamp format.
- * This format is specific to kdb+.
+ * @brief Validates if a string is a timestamp, either ISO "YYYY-MM-DD HH:MM:SS.ffffff"
+ * ('T' or space separated) or kdb+ "YYYY.MM.DDDHH:MM:SS.fffffffff".
  * @param s The input string.
- * @return bool True if the string matches the timestamp format, false otherwise.
+ * @return bool True if the string matches a timestamp format, false otherwise.
  */
 bool is_timestamp(const std::string& s) {
-    static const std::regex timestamp_regex(
-        R"(\d{4}\.\d{2}\.\d{2}D\d{2}:\d{2}:\d{2}\.\d{9})"
-    );
-    return std::regex_match(s, timestamp_regex);
+    J nanos;
+    return parse_timestamp_nanos(s, nanos);
 }
 
 /**
  * @brief Validates if a string matches the "YYYY.MM" month format.
- * This format is specific to kdb+.
+ * This format is specific to kdb+ and requires the trailing 'm'.
  * @param s The input string.
  * @return bool True if the string matches the month format, false otherwise.
  */
 bool is_month(const std::string& s) {
-    static const std::regex month_regex(R"(\d{4}\.\d{2}m)");
-    return std::regex_match(s, month_regex);
+    return !s.empty() && s.back() == 'm' && detail::parse_month(s) != ni;
 }
 
 /**
@@ -165,8 +364,7 @@ bool is_month(const std::string& s) {
  * @return bool True if the string matches the timespan format, false otherwise.
  */
 bool is_timespan(const std::string& s) {
-    static const std::regex timespan_regex(R"(\d+D\d{2}:\d{2}:\d{2}\.\d{9})");
-    return std::regex_match(s, timespan_regex);
+    return s.find('D') != std::string::npos && detail::parse_timespan(s) != nj;
 }
 
 /**
@@ -175,8 +373,7 @@ bool is_timespan(const std::string& s) {
  * @return bool True if the string matches the minute format, false otherwise.
  */
 bool is_minute(const std::string& s) {
-    static const std::regex minute_regex(R"(\d{2}:\d{2})");
-    return std::regex_match(s, minute_regex);
+    return detail::parse_minute(s) != ni;
 }
 
 /**
@@ -185,8 +382,7 @@ bool is_minute(const std::string& s) {
  * @return bool True if the string matches the second format, false otherwise.
  */
 bool is_second(const std::string& s) {
-    static const std::regex second_regex(R"(\d{2}:\d{2}:\d{2})");
-    return std::regex_match(s, second_regex);
+    return detail::parse_second(s) != ni;
 }
 
 // Parsing helper functions
@@ -218,6 +414,20 @@ I parse_time(const std::string& s) {
     return detail::parse_time(s);
 }
 
+/**
+ * @brief Checks that a string is a whole integer that fits a kdb+ integral type.
+ * @param min Smallest accepted value; the type's minimum is its null, so callers pass min + 1.
+ * @param max Largest accepted value.
+ * @return bool False for non-integers and for values the assigner could not store.
+ */
+bool is_integer_in_range(const std::string& s, long long min, long long max) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    long long value = std::strtoll(s.c_str(), &end, 10);
+    return end != s.c_str() && *end == '\0' && errno != ERANGE && value >= min && value <= max;
+}
+
 }  // namespace
 /**
  * @brief Creates an extended type map containing metadata for all supported kdb+ types.
@@ -238,34 +448,32 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         return (lower == "true" || lower == "false" || lower == "1" || lower == "0");
     };
 
-    // Integer type validator
-    auto validate_integer = [](const std::string& s) -> bool {
+    // Integer type validators, bounded so that values std::stoi and friends
+    // would reject (and the assigner would store as null) fail validation instead
+    auto validate_short = [](const std::string& s) -> bool {
+        return is_integer_in_range(s, std::numeric_limits<H>::min() + 1, std::numeric_limits<H>::max());
+    };
+    auto validate_int = [](const std::string& s) -> bool {
+        return is_integer_in_range(s, std::numeric_limits<I>::min() + 1LL, std::numeric_limits<I>::max());
+    };
+    auto validate_long = [](const std::string& s) -> bool {
+        return is_integer_in_range(s, std::numeric_limits<J>::min() + 1, std::numeric_limits<J>::max());
+    };
+
+    // Float type validators; out-of-range values make std::stof/std::stod throw
+    auto validate_real = [](const std::string& s) -> bool {
         if (s.empty()) return false;
         char* end = nullptr;
-        std::strtol(s.c_str(), &end, 10);
-        return end != s.c_str() && *end == '\0';
+        errno = 0;
+        std::strtof(s.c_str(), &end);
+        return end != s.c_str() && *end == '\0' && errno != ERANGE;
     };
-
-    // Float type validator
     auto validate_float = [](const std::string& s) -> bool {
         if (s.empty()) return false;
         char* end = nullptr;
+        errno = 0;
         std::strtod(s.c_str(), &end);
-        return end != s.c_str() && *end == '\0';
-    };
-
-    // Date type validator (YYYY-MM-DD format)
-    auto validate_date = [](const std::string& s) -> bool {
-        static const std::regex date_regex(R"(\d{4}-\d{2}-\d{2})");
-        return std::regex_match(s, date_regex);
-    };
-
-    // Datetime type validator (YYYY-MM-DD HH:MM:SS or YYYY-MM-DDTHH:MM:SS format)
-    auto validate_datetime = [](const std::string& s) -> bool {
-        static const std::regex datetime_regex(
-            R"(\d{4}-\d{2}-\d{2}[T ]\d{2}:\d{2}:\d{2}(\.\d+)?)"
-        );
-        return std::regex_match(s, datetime_regex);
+        return end != s.c_str() && *end == '\0' && errno != ERANGE;
     };
 
     // Boolean type metadata
@@ -289,7 +497,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return kG(k)[idx] ? "true" : "false";
-        }
+        },
+        .null_initializer = "0b"
     };
 
     // Byte type metadata
@@ -304,7 +513,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return std::to_string(static_cast<int>(kG(k)[idx]));
-        }
+        },
+        .null_initializer = "0x00"
     };
 
     // Short type metadata
@@ -312,14 +522,15 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         .kdb_type = KH,
         .name = "short",
         .type_char = 'h',
-        .validator = validate_integer,
+        .validator = validate_short,
         .null_assigner = [](K k, size_t idx) { kH(k)[idx] = nh; },
         .value_assigner = [](K k, const std::string& v, size_t idx) {
             kH(k)[idx] = static_cast<H>(std::stoi(v));
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return std::to_string(kH(k)[idx]);
-        }
+        },
+        .null_initializer = "0Nh"
     };
 
     // Integer type metadata
@@ -327,14 +538,15 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         .kdb_type = KI,
         .name = "int",
         .type_char = 'i',
-        .validator = validate_integer,
+        .validator = validate_int,
         .null_assigner = [](K k, size_t idx) { kI(k)[idx] = ni; },
         .value_assigner = [](K k, const std::string& v, size_t idx) {
             kI(k)[idx] = std::stoi(v);
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return std::to_string(kI(k)[idx]);
-        }
+        },
+        .null_initializer = "0Ni"
     };
 
     // Long type metadata
@@ -342,14 +554,15 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         .kdb_type = KJ,
         .name = "long",
         .type_char = 'j',
-        .validator = validate_integer,
+        .validator = validate_long,
         .null_assigner = [](K k, size_t idx) { kJ(k)[idx] = nj; },
         .value_assigner = [](K k, const std::string& v, size_t idx) {
             kJ(k)[idx] = std::stoll(v);
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return std::to_string(kJ(k)[idx]);
-        }
+        },
+        .null_initializer = "0Nj"
     };
 
     // Real type metadata
@@ -357,7 +570,7 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         .kdb_type = KE,
         .name = "real",
         .type_char = 'e',
-        .validator = validate_float,
+        .validator = validate_real,
         .null_assigner = [](K k, size_t idx) { kE(k)[idx] = ne; },
         .value_assigner = [](K k, const std::string& v, size_t idx) {
             kE(k)[idx] = std::stof(v);
@@ -366,7 +579,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
             std::ostringstream oss;
             oss << std::fixed << std::setprecision(7) << kE(k)[idx];
             return oss.str();
-        }
+        },
+        .null_initializer = "0Ne"
     };
 
     // Float type metadata
@@ -383,7 +597,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
             std::ostringstream oss;
             oss << std::fixed << std::setprecision(7) << kF(k)[idx];
             return oss.str();
-        }
+        },
+        .null_initializer = "0n"
     };
 
     // Char type metadata
@@ -398,7 +613,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return std::string(1, kC(k)[idx]);
-        }
+        },
+        .null_initializer = "\" \""
     };
 
     // Date type metadata
@@ -419,7 +635,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
             std::ostringstream oss;
             oss << std::put_time(tm, "%Y-%m-%d");  ///< Formats the date as "YYYY-MM-DD"
             return oss.str();
-        }
+        },
+        .null_initializer = "0Nd"
     };
 
     // Datetime type metadata
@@ -440,7 +657,8 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
             std::ostringstream oss;
             oss << std::put_time(tm, "%Y-%m-%d %H:%M:%S");  ///< Formats the datetime as "YYYY-MM-DD HH:MM:SS"
             return oss.str();
-        }
+        },
+        .null_initializer = "0Nz"
     };
 
     // Time type metadata
@@ -465,22 +683,127 @@ std::unordered_map<std::string, TypeInfo> createExtendedTypeMap() {
                 << std::setw(2) << std::setfill('0') << minutes << ":"
                 << std::setw(2) << std::setfill('0') << seconds;  ///< Formats the time as "HH:MM:SS"
             return oss.str();
-        }
+        },
+        .null_initializer = "0Nt"
         };
     
+    // Timestamp type metadata
+    type_map["p"] = TypeInfo{
+        .kdb_type = KP,  ///< KDB+ type identifier for timestamp
+        .name = "timestamp",
+        .type_char = 'p',
+        .validator = is_timestamp,
+        .null_assigner = [](K k, size_t idx) { kJ(k)[idx] = nj; },
+        .value_assigner = [](K k, const std::string& v, size_t idx) {
+            kJ(k)[idx] = detail::parse_timestamp(v);  ///< Nanoseconds since 2000-01-01
+        },
+        .formatter = [](K k, size_t idx) -> std::string {
+            J nanos = kJ(k)[idx];
+            if (nanos == nj) return "NULL";
+            J days = nanos / NANOS_PER_DAY;
+            J clock = nanos % NANOS_PER_DAY;
+            if (clock < 0) {
+                clock += NANOS_PER_DAY;
+                days -= 1;
+            }
+            return format_civil_date(static_cast<I>(days)) + " " + format_clock(clock, 9);  ///< "YYYY-MM-DD HH:MM:SS.nnnnnnnnn"
+        },
+        .null_initializer = "0Np"
+    };
+
+    // Timespan type metadata
+    type_map["n"] = TypeInfo{
+        .kdb_type = KN,  ///< KDB+ type identifier for timespan
+        .name = "timespan",
+        .type_char = 'n',
+        .validator = is_timespan,
+        .null_assigner = [](K k, size_t idx) { kJ(k)[idx] = nj; },
+        .value_assigner = [](K k, const std::string& v, size_t idx) {
+            kJ(k)[idx] = detail::parse_timespan(v);
+        },
+        .formatter = [](K k, size_t idx) -> std::string {
+            J nanos = kJ(k)[idx];
+            if (nanos == nj) return "NULL";
+            std::string sign = nanos < 0 ? "-" : "";
+            if (nanos < 0) nanos = -nanos;
+            return sign + std::to_string(nanos / NANOS_PER_DAY) + "D" +
+                   format_clock(nanos % NANOS_PER_DAY, 9);  ///< "dDHH:MM:SS.nnnnnnnnn"
+        },
+        .null_initializer = "0Nn"
+    };
+
+    // Month type metadata
+    type_map["m"] = TypeInfo{
+        .kdb_type = KM,  ///< KDB+ type identifier for month
+        .name = "month",
+        .type_char = 'm',
+        .validator = is_month,
+        .null_assigner = [](K k, size_t idx) { kI(k)[idx] = ni; },
+        .value_assigner = [](K k, const std::string& v, size_t idx) {
+            kI(k)[idx] = detail::parse_month(v);  ///< Months since 2000.01
+        },
+        .formatter = [](K k, size_t idx) -> std::string {
+            I months = kI(k)[idx];
+            if (months == ni) return "NULL";
+            I year = 2000 + (months >= 0 ? months / 12 : (months - 11) / 12);
+            I month = months - (year - 2000) * 12 + 1;
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%04d.%02dm", year, month);  ///< "YYYY.MMm"
+            return buf;
+        },
+        .null_initializer = "0Nm"
+    };
+
+    // Minute type metadata
+    type_map["u"] = TypeInfo{
+        .kdb_type = KU,  ///< KDB+ type identifier for minute
+        .name = "minute",
+        .type_char = 'u',
+        .validator = is_minute,
+        .null_assigner = [](K k, size_t idx) { kI(k)[idx] = ni; },
+        .value_assigner = [](K k, const std::string& v, size_t idx) {
+            kI(k)[idx] = detail::parse_minute(v);
+        },
+        .formatter = [](K k, size_t idx) -> std::string {
+            I minutes = kI(k)[idx];
+            if (minutes == ni) return "NULL";
+            return format_clock(minutes * NANOS_PER_MINUTE, 0).substr(0, 5);  ///< "HH:MM"
+        },
+        .null_initializer = "0Nu"
+    };
+
+    // Second type metadata
+    type_map["v"] = TypeInfo{
+        .kdb_type = KV,  ///< KDB+ type identifier for second
+        .name = "second",
+        .type_char = 'v',
+        .validator = is_second,
+        .null_assigner = [](K k, size_t idx) { kI(k)[idx] = ni; },
+        .value_assigner = [](K k, const std::string& v, size_t idx) {
+            kI(k)[idx] = detail::parse_second(v);
+        },
+        .formatter = [](K k, size_t idx) -> std::string {
+            I seconds = kI(k)[idx];
+            if (seconds == ni) return "NULL";
+            return format_clock(seconds * NANOS_PER_SECOND, 0);  ///< "HH:MM:SS"
+        },
+        .null_initializer = "0Nv"
+    };
+
     // Symbol type metadata
     type_map["s"] = TypeInfo{
         .kdb_type = KS,
         .name = "symbol",
         .type_char = 's',
         .validator = nullptr,  // Symbols accept any string
-        .null_assigner = [](K k, size_t idx) { kS(k)[idx] = nullptr; },
+        .null_assigner = [](K k, size_t idx) { kS(k)[idx] = ss((S)""); },  // Null symbol is `, never nullptr
         .value_assigner = [](K k, const std::string& v, size_t idx) {
-            kS(k)[idx] = ss((S)v.c_str());
+            kS(k)[idx] = intern_symbol(v);
         },
         .formatter = [](K k, size_t idx) -> std::string {
             return kS(k)[idx] ? std::string(kS(k)[idx]) : "";
-        }
+        },
+        .null_initializer = "`"
     };
 
 
@@ -498,26 +821,55 @@ const std::unordered_map<std::string, TypeInfo>& getExtendedTypeMap() {
     return type_map;
 }
 
+/**
+ * @brief Finds the type map entry for a kdb+ type code
+ * @param kdb_type The kdb+ type code (vector type, e.g. KJ)
+ * @return const TypeInfo* The matching entry, or nullptr for unsupported types
+ */
+const TypeInfo* find_type_info(int kdb_type) {
+    static const auto by_code = [] {
+        std::unordered_map<int, const TypeInfo*> index;
+        for (const auto& [key, info] : getExtendedTypeMap()) {
+            index.emplace(info.kdb_type, &info);
+        }
+        return index;
+    }();
+    auto it = by_code.find(kdb_type);
+    return it == by_code.end() ? nullptr : it->second;
+}
+
+/**
+ * @brief Returns the width of one element of a simple kdb+ vector
+ * @param kdb_type The vector type code (sign is ignored)
+ * @return size_t Bytes per element; symbols count as one pointer
+ */
+size_t element_size(int kdb_type) {
+    switch (kdb_type < 0 ? -kdb_type : kdb_type) {
+        case KB: case KG: case KC: return 1;
+        case KH: return 2;
+        case KI: case KE: case KD: case KM: case KU: case KV: case KT: return 4;
+        case KJ: case KF: case KP: case KN: case KZ: return 8;
+        case KS: return sizeof(S);
+        case UU: return 16;
+        default: return 0;
+    }
+}
+
 /**
  * @brief Checks whether a value in a kdb+ column is null
  * @param col_data The kdb+ column (K object)
  * @param idx The index of the value to check
  * @return bool True if the value is null, false otherwise
- * @note Symbol type (KS) has special null handling with nullptr check
+ * @note Symbol type (KS) treats both the empty symbol and nullptr as null
  * @note Returns true for unrecognized types as a safety measure
  */
 bool is_null_value(K col_data, size_t idx) {
-    auto type_map = getExtendedTypeMap();
-
-    // Iterate through the type map to find the matching type handler
-    for (const auto& [key, info] : type_map) {
-        if (info.kdb_type == col_data->t) {
-            // Handle nulls for symbol type separately
-            if (col_data->t == KS) return kS(col_data)[idx] == nullptr;
-            return info.formatter(col_data, idx) == "NULL";
-        }
-    }
-    return true;  // Default to true if type is unrecognized
+    const TypeInfo* info = find_type_info(col_data->t);
+    if (!info) return true;  // Default to true if type is unrecognized
+
+    // Handle nulls for symbol type separately
+    if (col_data->t == KS) return kS(col_data)[idx] == nullptr || kS(col_data)[idx][0] == '\0';
+    return info->formatter(col_data, idx) == "NULL";
 }
 
 /**
@@ -528,14 +880,8 @@ bool is_null_value(K col_data, size_t idx) {
  * @param idx The index to assign a null value to.
  */
 void assign_null_value(K col_data, size_t idx) {
-    auto type_map = getExtendedTypeMap();
-
-    // Find the appropriate type handler and assign null
-    for (const auto& [key, info] : type_map) {
-        if (info.kdb_type == col_data->t) {
-            info.null_assigner(col_data, idx);
-            return;
-        }
+    if (const TypeInfo* info = find_type_info(col_data->t)) {
+        info->null_assigner(col_data, idx);
     }
 }
 
@@ -554,19 +900,14 @@ void assign_value(K col_data, const std::string& value, size_t idx) {
         return;
     }
 
-    auto type_map = getExtendedTypeMap();
-
     // Find the appropriate type handler and assign the value
-    for (const auto& [key, info] : type_map) {
-        if (info.kdb_type == col_data->t) {
-            try {
-                info.value_assigner(col_data, value, idx);
-            } catch (...) {
-                // Assign null if an exception occurs during assignment
-                assign_null_value(col_data, idx);
-            }
-            return;
-        }
+    const TypeInfo* info = find_type_info(col_data->t);
+    if (!info) return;
+    try {
+        info->value_assigner(col_data, value, idx);
+    } catch (...) {
+        // Assign null if an exception occurs during assignment
+        info->null_assigner(col_data, idx);
     }
 }
 
@@ -592,63 +933,104 @@ std::string format_value(K col_data, size_t idx) {
         return "NULL";
     }
 
-    auto type_map = getExtendedTypeMap();
-
     // Find the appropriate type handler and format the value
-    for (const auto& [key, info] : type_map) {
-        if (info.kdb_type == col_data->t) {
-            return info.formatter(col_data, idx);
-        }
-    }
-    return "NULL";  // Default to "NULL" if type is unrecognized
+    const TypeInfo* info = find_type_info(col_data->t);
+    return info ? info->formatter(col_data, idx) : "NULL";  // "NULL" if type is unrecognized
 }
 
+namespace {
+
 /**
- * @brief Infers the kdb+ type of a column based on its data
- * @param data Vector of strings representing the column's values
- * @return I The inferred kdb+ type code
- * @note Uses a priority order for type inference:
- *       boolean -> integer -> long -> float -> date -> datetime ->
- *       time -> timestamp -> month -> timespan -> minute -> second -> symbol
- * @note Returns symbol type (KS) if no other type matches
+ * @brief Priority order for type inference; earlier entries win when several types fit.
+ * @note Timestamp precedes the float-based datetime so sub-millisecond
+ *       precision survives the load.
  */
-I infer_column_type(const std::vector<std::string>& data) {
-    auto type_map = getExtendedTypeMap();
-
-    // Priority order for type inference
-    std::vector<std::string> type_priority = {
-        "b", "i", "j", "f", "d", "z", "t", "p", "m", "n", "u", "v", "s"
+const std::vector<std::string>& inference_priority() {
+    static const std::vector<std::string> type_priority = {
+        "b", "i", "j", "f", "d", "p", "z", "t", "m", "n", "u", "v", "s"
     };
+    return type_priority;
+}
 
-    bool has_non_empty = false;
-    std::unordered_map<std::string, bool> type_validity;
+}  // namespace
 
-    // Initialize all types as valid
-    for (const auto& [key, _] : type_map) {
-        type_validity[key] = true;
+/**
+ * @brief Creates an accumulator with every known type still a candidate.
+ * @note Priority entries missing from the extended type map are skipped
+ *       rather than looked up, so they can never be returned.
+ */
+ColumnTypeAccumulator::ColumnTypeAccumulator() {
+    const auto& type_map = getExtendedTypeMap();
+    for (const auto& key : inference_priority()) {
+        auto it = type_map.find(key);
+        if (it == type_map.end()) continue;
+        candidates_.push_back(&it->second);
+        valid_.push_back(1);
+        if (it->second.validator) remaining_++;
     }
+}
 
-    // Test each value against each type's validator
-    for (const auto& value : data) {
-        if (!value.empty()) {
-            has_non_empty = true;
-            for (const auto& [key, info] : type_map) {
-                if (info.validator && type_validity[key]) {
-                    type_validity[key] = info.validator(value);
-                }
-            }
+/**
+ * @brief Tests one value against every type that is still a candidate.
+ * @param value The raw field text; empty values are treated as nulls and ignored.
+ * @note Once every validated type has been ruled out this is a no-op, so
+ *       feeding a whole column costs little after the type has settled.
+ */
+void ColumnTypeAccumulator::observe(const std::string& value) {
+    if (value.empty()) return;
+    observed_++;
+    if (remaining_ == 0) return;
+
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+        if (valid_[i] && candidates_[i]->validator && !candidates_[i]->validator(value)) {
+            valid_[i] = 0;
+            remaining_--;
         }
     }
+}
 
-    // Return the first valid type according to priority
-    for (const auto& type : type_priority) {
-        if (type_validity[type] && has_non_empty) {
-            return type_map[type].kdb_type;
+/**
+ * @brief Combines the evidence of another accumulator into this one.
+ * @param other Accumulator built over a different subset of the same column.
+ */
+void ColumnTypeAccumulator::merge(const ColumnTypeAccumulator& other) {
+    for (size_t i = 0; i < candidates_.size() && i < other.valid_.size(); ++i) {
+        if (valid_[i] && !other.valid_[i]) {
+            valid_[i] = 0;
+            if (candidates_[i]->validator) remaining_--;
         }
     }
+    observed_ += other.observed_;
+}
 
-    // Default to symbol type if no other type matches
-    return type_map["s"].kdb_type;
+/**
+ * @brief Returns the highest priority type consistent with every observed value.
+ * @return I The inferred kdb+ type code, or symbol (KS) when nothing was observed.
+ */
+I ColumnTypeAccumulator::resolve() const {
+    if (observed_ > 0) {
+        for (size_t i = 0; i < candidates_.size(); ++i) {
+            if (valid_[i]) return candidates_[i]->kdb_type;
+        }
+    }
+    return KS;
+}
+
+/**
+ * @brief Infers the kdb+ type of a column based on its data
+ * @param data Vector of strings representing the column's values
+ * @return I The inferred kdb+ type code
+ * @note Uses a priority order for type inference:
+ *       boolean -> integer -> long -> float -> date -> timestamp ->
+ *       datetime -> time -> month -> timespan -> minute -> second -> symbol
+ * @note Returns symbol type (KS) if no other type matches
+ */
+I infer_column_type(const std::vector<std::string>& data) {
+    ColumnTypeAccumulator accumulator;
+    for (const auto& value : data) {
+        accumulator.observe(value);
+    }
+    return accumulator.resolve();
 }
 
 /**
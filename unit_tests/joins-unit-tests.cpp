@@ -1,5 +1,6 @@
 
 #include "joins.h"
+#include "local_joins.h"
 #include "inline_query.h"
 #include "make_table.h"
 #include <cassert>
@@ -8,6 +9,7 @@
 #include <string>
 #include <variant>
 #include <stdexcept>
+#include <thread>
 #include "print_table.h"
 namespace test {
 
@@ -183,6 +185,41 @@ public:
 
 
 
+    bool test_window_join_aggregations() {
+        // Timestamps, so the 500us pre-window is not rounded away: the window of
+        // the one left row starts at 09:29:59.9995, taking the 09:29:58 quote as
+        // prevailing on entry plus the two inside it. A millisecond window would
+        // start at 09:30:00 and see only the last quote.
+        bool success = inline_query(
+            "ts_left:([] ticker:enlist`A; time:enlist 2024.01.02D09:30:00.000000000; price:enlist 100)") &&
+            inline_query(
+            "ts_right:([] ticker:`A`A`B`A; time:2024.01.02D09:29:58.000000000 2024.01.02D09:29:59.999700000 "
+            "2024.01.02D09:29:59.999800000 2024.01.02D09:30:00.000000000; bid:6 10 99 20; ask:1 1 99 2)");
+
+        std::vector<std::string> join_cols = {"ticker"};
+        std::vector<joins::WindowAggregation> aggregations = {
+            {"count", "bid", "", "quotes"},
+            {"sum", "ask", "", "ask_total"},
+            {"wavg", "bid", "ask", "weighted_bid"},
+        };
+        auto result = joins::window_join("ts_left", "ts_right", "test_result", "time", "time",
+                                         std::chrono::microseconds(500), std::chrono::nanoseconds(0),
+                                         join_cols, aggregations);
+
+        success = success && bool(result) && result.rows() == 1 && result.columns().size() == 6 &&
+                  result.columns()[3].name == "quotes" && result.columns()[5].name == "weighted_bid";
+        if (success) {
+            // wavg of bids 6 10 20 weighted by asks 1 1 2 is 56%4
+            auto check = inline_query("(3;4;14f)~first each test_result`quotes`ask_total`weighted_bid");
+            K value = check.get_result();
+            success = value && value->t == -KB && value->g;
+            if (value) r0(value);
+        }
+
+        inline_query("delete ts_left, ts_right, test_result from `.");
+        return success;
+    }
+
     bool test_asof_join_basic() {
         if (!setup_time_test_tables()) return false;
 
@@ -198,6 +235,225 @@ public:
     }
 
 
+    bool test_asof_join_unsorted_right() {
+        if (!setup_time_test_tables()) return false;
+
+        // aj needs the right table in time order; the join sorts its own copy
+        std::vector<std::string> join_cols = {"ticker"};
+        bool success = inline_query("table2_reversed:reverse table2_time") &&
+                       joins::asof_join("table1_time", "table2_time", "test_result", "time", "time", join_cols) &&
+                       joins::asof_join("table1_time", "table2_reversed", "test_reversed", "time", "time", join_cols);
+
+        auto same = inline_query("(test_result~test_reversed) and not `s in exec a from meta table2_reversed");
+        K same_k = same.get_result();
+        success = success && same_k && same_k->t == -KB && same_k->g;
+        if (same_k) r0(same_k);
+
+        inline_query("delete table2_reversed, test_reversed from `.");
+        cleanup_time_test_tables();
+        return success;
+    }
+
+    bool test_asof_join_partitioned() {
+        if (!setup_time_test_tables()) return false;
+
+        // Both modes must reproduce the plain as-of join, rows in the same order
+        std::vector<std::string> join_cols = {"ticker"};
+        joins::PartitionOptions options;
+        options.partition_column = "ticker";
+        options.partitions = 2;
+        bool success = bool(joins::asof_join("table1_time", "table2_time", "test_result", "time", "time", join_cols));
+
+        auto on_server = joins::asof_join_partitioned("table1_time", "table2_time", "test_partitioned",
+                                                      "time", "time", join_cols, options);
+        auto same = inline_query("test_result~test_partitioned");
+        K same_k = same.get_result();
+        success = success && on_server && same_k && same_k->t == -KB && same_k->g;
+        if (same_k) r0(same_k);
+
+        options.endpoints = {{"localhost", 6000}};
+        auto pooled = joins::asof_join_partitioned("table1_time", "table2_time", "test_partitioned",
+                                                   "time", "time", join_cols, options);
+        same = inline_query("test_result~test_partitioned");
+        same_k = same.get_result();
+        success = success && pooled && same_k && same_k->t == -KB && same_k->g;
+        if (same_k) r0(same_k);
+
+        // An empty left table gives an empty result in both modes, as asof_join does
+        success = success && inline_query("table1_empty:0#table1_time") &&
+                  joins::asof_join("table1_empty", "table2_time", "test_result", "time", "time", join_cols);
+        for (bool pool : {false, true}) {
+            options.endpoints.clear();
+            if (pool) options.endpoints = {{"localhost", 6000}};
+            auto empty = joins::asof_join_partitioned("table1_empty", "table2_time", "test_partitioned",
+                                                      "time", "time", join_cols, options);
+            same = inline_query("(0=count test_partitioned) and (cols test_result)~cols test_partitioned");
+            same_k = same.get_result();
+            success = success && empty && empty.rows() == 0 && same_k && same_k->t == -KB && same_k->g;
+            if (same_k) r0(same_k);
+        }
+
+        inline_query("delete test_partitioned, table1_empty from `.");
+        cleanup_time_test_tables();
+        return success;
+    }
+
+    bool test_joins_leave_no_globals() {
+        if (!setup_time_test_tables()) return false;
+
+        auto before = inline_query("count key `.");
+        std::vector<std::string> join_cols = {"ticker"};
+        bool success = joins::inner_join("table1_time", "table2_time", "test_result", join_cols) &&
+                       joins::asof_join("table1_time", "table2_time", "test_result", "time", "time", join_cols) &&
+                       joins::window_join("table1_time", "table2_time", "test_result", "time", "time", 60.0, join_cols);
+        auto after = inline_query("count key `.");
+
+        // Only test_result may have been added to the root namespace
+        K before_k = before.get_result();
+        K after_k = after.get_result();
+        success = success && before_k && after_k && after_k->j <= before_k->j + 1;
+        if (before_k) r0(before_k);
+        if (after_k) r0(after_k);
+
+        cleanup_time_test_tables();
+        return success;
+    }
+
+
+    bool test_lazy_join_result() {
+        if (!setup_test_tables()) return false;
+
+        std::vector<std::string> join_cols = {"ticker"};
+        auto joined = joins::inner_join("table1", "table2", "test_result", join_cols);
+        if (!joined || joined.rows() != 2 || joined.columns().empty()) {
+            cleanup_test_tables();
+            return false;
+        }
+
+        // Fetch one row, then one column
+        bool success = true;
+        K head = joined.fetch_rows(0, 1);
+        success = success && head && head->t == XT && kK(kK(head->k)[1])[0]->n == 1;
+        if (head) r0(head);
+        K tickers = joined.fetch_columns({"ticker"});
+        success = success && tickers && tickers->t == XT && kK(tickers->k)[0]->n == 1;
+        if (tickers) r0(tickers);
+
+        // Chain a second join on the server-side result
+        auto chained = joins::left_join(joined.name(), "table2", "test_chained", join_cols);
+        success = success && chained && chained.rows() == 2;
+        if (chained) chained.drop();
+
+        cleanup_test_tables();
+        return success;
+    }
+
+    bool test_concurrent_scratch_joins() {
+        if (!setup_test_tables()) return false;
+
+        // Two threads, each on its own connection, join the same tables at once
+        std::vector<std::string> join_cols = {"ticker"};
+        joins::JoinResult results[2];
+        std::vector<std::thread> threads;
+        for (auto& result : results) {
+            threads.emplace_back([&result, &join_cols] {
+                I handle = connect("localhost", 6000);
+                if (handle <= 0) return;
+                KDBConnection::bind_thread(handle);
+                result = joins::inner_join("table1", "table2", "", join_cols);
+                joins::clear_scratch();
+                KDBConnection::bind_thread(0);
+                kclose(handle);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        bool success = results[0] && results[1] && results[0].rows() == 2 && results[1].rows() == 2 &&
+                       results[0].name() != results[1].name() &&
+                       results[0].name().rfind(joins::SCRATCH_NAMESPACE, 0) == 0;
+
+        // Each session cleared only its own scratch results
+        auto remaining = inline_query("@[{count key value x};`" + std::string(joins::SCRATCH_NAMESPACE) + ";0]");
+        K remaining_k = remaining.get_result();
+        success = success && remaining_k && remaining_k->j <= 1;
+        if (remaining_k) r0(remaining_k);
+
+        cleanup_test_tables();
+        return success;
+    }
+
+    bool test_local_asof_join() {
+        if (!setup_time_test_tables()) return false;
+
+        // Join both tables on the client and compare with the server's aj
+        std::vector<std::string> join_cols = {"ticker"};
+        K left = inline_query("table1_time").get_result();
+        K right = inline_query("table2_time").get_result();
+        K local = (left && right) ? joins::local_asof_join(left, right, "time", "time", join_cols) : nullptr;
+        if (left) r0(left);
+        if (right) r0(right);
+
+        auto server = joins::asof_join("table1_time", "table2_time", "test_result", "time", "time", join_cols);
+        K expected = server.fetch();
+        bool success = false;
+        if (local && expected) {
+            K same = inline_query("~", {local, expected}).get_result();
+            success = same && same->t == -KB && same->g;
+            if (same) r0(same);
+        } else {
+            if (local) r0(local);
+            if (expected) r0(expected);
+        }
+
+        cleanup_time_test_tables();
+        return success;
+    }
+
+    bool test_local_hash_joins() {
+        if (!setup_test_tables()) return false;
+
+        // Each local join must match its server-side counterpart exactly
+        std::vector<std::string> join_cols = {"ticker"};
+        K left = inline_query("0!table1").get_result();
+        K right = inline_query("0!table2").get_result();
+        if (!left || !right) {
+            if (left) r0(left);
+            if (right) r0(right);
+            return false;
+        }
+
+        struct Case {
+            K (*local)(K, K, const std::vector<std::string>&, const joins::LocalJoinOptions&);
+            joins::JoinResult (*server)(const std::string&, const std::string&, const std::string&,
+                                        const std::vector<std::string>&);
+        };
+        Case cases[] = {
+            {joins::local_inner_join, joins::inner_join},
+            {joins::local_left_join, joins::left_join},
+            {joins::local_right_join, joins::right_join},
+        };
+
+        bool success = true;
+        for (const auto& c : cases) {
+            K local = c.local(left, right, join_cols, joins::LocalJoinOptions());
+            K expected = c.server("table1", "table2", "test_result", join_cols).fetch();
+            if (!local || !expected) {
+                if (local) r0(local);
+                if (expected) r0(expected);
+                success = false;
+                continue;
+            }
+            K same = inline_query("~", {local, expected}).get_result();
+            success = success && same && same->t == -KB && same->g;
+            if (same) r0(same);
+        }
+
+        r0(left);
+        r0(right);
+        cleanup_test_tables();
+        return success;
+    }
+
     void run_all_tests() {
         // Ensure we're connected to KDB+
         if (!KDBConnection::connect("localhost", 6000)) {
@@ -219,7 +475,15 @@ public:
                 {"Right join basic test", &JoinsTest::test_right_join_basic},
                 {"Union join basic test", &JoinsTest::test_union_join_basic},
                 {"Window join basic test", &JoinsTest::test_window_join_basic},
+                {"Window join aggregations test", &JoinsTest::test_window_join_aggregations},
                 {"Asof join basic test", &JoinsTest::test_asof_join_basic}, // New test added here
+                {"Asof join unsorted right table test", &JoinsTest::test_asof_join_unsorted_right},
+                {"Partitioned asof join test", &JoinsTest::test_asof_join_partitioned},
+                {"Joins leave no globals test", &JoinsTest::test_joins_leave_no_globals},
+                {"Lazy join result test", &JoinsTest::test_lazy_join_result},
+                {"Concurrent scratch joins test", &JoinsTest::test_concurrent_scratch_joins},
+                {"Local asof join test", &JoinsTest::test_local_asof_join},
+                {"Local hash joins test", &JoinsTest::test_local_hash_joins},
             };
 
             for (const auto& test : tests) {
@@ -1,11 +1,25 @@
 #include "make_table.h"
+#include "schema.h"
+#include "symbol_cache.h"
+#include "table_builder.h"
+#include "table_writer.h"
 #include "connections.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <variant>
 #include <limits>
+#include <chrono>
 #include "inline_query.h"
+
+struct Trade {
+    std::chrono::sys_time<std::chrono::nanoseconds> ts;
+    double price;
+    int64_t size;
+    std::string sym;
+};
+KDBEAR_SCHEMA(Trade, ts, price, size, sym)
+
 class TestResult {
 public:
     bool passed;
@@ -28,6 +42,15 @@ private:
         if (passed) passedTests++;
     }
 
+    // Evaluates a q boolean expression against the server
+    bool checkOnServer(const std::string& expression) {
+        auto check = inline_query(expression);
+        K value = check.get_result();
+        bool passed = value && value->t == -KB && value->g;
+        if (value) r0(value);
+        return passed;
+    }
+
     // Helper to verify table existence and content
     bool verifyTable(const std::string& tableName, size_t expectedRows, size_t expectedCols) {
         try {
@@ -71,6 +94,13 @@ public:
             testDuplicateTableNames();
             testValidNames();      // Renamed from testUnicodeSupport
             testEdgeCases();
+            testTypedColumns();
+            testColumnarTable();
+            testWideTypes();
+            testTableWriter();
+            testTableWriterAsync();
+            testSchemaRoundTrip();
+            testSymbolCache();
         } catch (const std::exception& e) {
             std::cerr << "Test execution error: " << e.what() << std::endl;
         }
@@ -236,6 +266,201 @@ public:
         cleanupTable("edge_cases");
     }
 
+    void testTypedColumns() {
+        std::vector<std::string> columns = {"ID", "Price", "Sym", "Flag"};
+        std::vector<std::vector<KDBType>> data;
+        for (int i = 0; i < 100000; ++i) {
+            data.push_back({i, i % 3 ? KDBType(i * 0.5) : KDBType(i), std::string("S") + std::to_string(i % 10),
+                            i % 7 ? KDBType(i % 2 == 0) : KDBType()});
+        }
+
+        // Ints widen into the float column; nulls stay typed
+        bool verified = make_table("typed_table", columns, data);
+        verified = verified && checkOnServer(
+            "(\"jfsb\"~exec t from meta typed_table) and (100000~count typed_table) and"
+            "(4.5~typed_table[9;`Price]) and (`S3~typed_table[3;`Sym])");
+
+        recordResult(verified,
+            verified ? "Columns are typed vectors" : "Columns were not built as typed vectors",
+            "Typed Columns");
+
+        cleanupTable("typed_table");
+    }
+
+    void testColumnarTable() {
+        using namespace std::chrono;
+        std::vector<int64_t> ids(100000);
+        std::vector<double> prices(ids.size());
+        std::vector<std::string> syms(ids.size());
+        std::vector<sys_days> dates(ids.size());
+        std::vector<sys_time<nanoseconds>> times(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ids[i] = static_cast<int64_t>(i);
+            prices[i] = i * 0.25;
+            syms[i] = "S" + std::to_string(i % 10);
+            dates[i] = sys_days(year(2024) / 1 / 1) + days(i % 5);
+            times[i] = sys_days(year(2024) / 1 / 1) + milliseconds(i);
+        }
+
+        std::vector<TableColumn> columns;
+        columns.push_back({"ID", std::move(ids)});
+        columns.push_back({"Price", std::move(prices)});
+        columns.push_back({"Sym", std::move(syms)});
+        columns.push_back({"Date", std::move(dates)});
+        columns.push_back({"Time", std::move(times)});
+        bool verified = make_table("columnar_table", std::move(columns));
+
+        verified = verified && checkOnServer(
+            "{[t] (\"jfsdp\"~exec t from meta t) and (100000~count t) and"
+            "(til[100000]~t`ID) and (2024.01.03~t[7;`Date]) and (2024.01.01D00:00:01.5~t[1500;`Time])}[columnar_table]");
+
+        // Columns must be the same length
+        std::vector<TableColumn> ragged;
+        ragged.push_back({"A", std::vector<int32_t>{1, 2}});
+        ragged.push_back({"B", std::vector<float>{1.0f}});
+        bool rejected = !make_table("ragged_table", std::move(ragged));
+
+        recordResult(verified && rejected,
+            verified && rejected ? "Uploaded whole typed columns" : "Columnar make_table failed",
+            "Columnar Table");
+
+        cleanupTable("columnar_table");
+    }
+
+    void testWideTypes() {
+        using namespace std::chrono;
+        Guid guid;
+        guid.bytes[15] = 1;
+        std::vector<std::string> columns = {"Long", "Real", "Time", "Date", "Span", "Text", "Id"};
+        std::vector<std::vector<KDBType>> data = {
+            {int64_t(5000000000), 1.5f, sys_days(year(2024) / 1 / 2) + hours(9), sys_days(year(2024) / 1 / 2),
+             milliseconds(1500), CharString{"first"}, guid},
+            {std::monostate(), std::monostate(), std::monostate(), std::monostate(),
+             std::monostate(), CharString{"second"}, std::monostate()}
+        };
+
+        // Each alternative lands in its own vector type, without passing through text
+        bool verified = make_table("wide_table", columns, data);
+        verified = verified && checkOnServer(
+            "{[t] (\"jepdnCg\"~exec t from meta t) and (5000000000~t[0;`Long]) and"
+            "(2024.01.02D09:00:00~t[0;`Time]) and (0D00:00:01.5~t[0;`Span]) and (\"second\"~t[1;`Text]) and"
+            "(\"G\"$\"00000000-0000-0000-0000-000000000001\")~t[0;`Id]}[wide_table]");
+
+        recordResult(verified,
+            verified ? "Wide variant types mapped to typed columns" : "Wide variant types were not typed",
+            "Wide Types");
+
+        cleanupTable("wide_table");
+    }
+
+    void testTableWriter() {
+        cleanupTable("writer_table");
+        inline_query("writer_table:([] ID:`long$(); Price:`float$(); Sym:`symbol$(); Time:`timestamp$())");
+
+        TableWriterOptions options;
+        options.batch_rows = 1000;
+        bool verified = true;
+        {
+            TableWriter writer("writer_table", {"ID", "Price", "Sym", "Time"}, {"j", "f", "s", "p"}, options);
+            for (int i = 0; i < 2500; ++i) {
+                verified = verified && writer.write({i, i * 0.5, std::string("S") + std::to_string(i % 4),
+                                                     std::string("2024.01.02D10:00:00")});
+            }
+            // A row of the wrong shape is refused without disturbing the batch
+            verified = verified && !writer.write({1, 2.0}) && writer.rows_buffered() == 500;
+
+            std::vector<TableColumn> block;
+            block.push_back({"ID", std::vector<int64_t>{2500, 2501}});
+            block.push_back({"Price", std::vector<double>{1250.0, 1250.5}});
+            block.push_back({"Sym", std::vector<std::string>{"S0", "S1"}});
+            block.push_back({"Time", std::vector<std::chrono::sys_time<std::chrono::nanoseconds>>(2)});
+            verified = verified && writer.write_columns(std::move(block)) && writer.batches_sent() == 2;
+        }
+
+        // The destructor sent the last 502 rows
+        verified = verified && checkOnServer(
+            "(til[2502]~writer_table`ID) and (\"jfsp\"~exec t from meta writer_table) and"
+            "(2024.01.02D10:00:00~writer_table[5;`Time])");
+
+        recordResult(verified,
+            verified ? "Appended rows and column blocks in batches" : "TableWriter append failed",
+            "Table Writer");
+
+        cleanupTable("writer_table");
+    }
+
+    void testTableWriterAsync() {
+        cleanupTable("async_table");
+        inline_query("async_table:([] ID:`long$())");
+
+        TableWriterOptions options;
+        options.batch_rows = 100;
+        options.async = true;
+        options.max_in_flight = 3;
+        TableWriter writer("async_table", {"ID"}, {"j"}, options);
+        bool verified = true;
+        for (int i = 0; i < 1050; ++i) verified = verified && writer.write({i});
+        verified = verified && writer.sync() && writer.rows_sent() == 1050;
+
+        // After sync the server has applied every batch
+        verified = verified && checkOnServer("til[1050]~async_table`ID");
+
+        recordResult(verified,
+            verified ? "Async batches applied in order" : "Async TableWriter failed",
+            "Table Writer Async");
+
+        cleanupTable("async_table");
+    }
+
+    void testSchemaRoundTrip() {
+        using namespace std::chrono;
+        static_assert(schema::column_types<Trade>() == std::array<I, 4>{KP, KF, KJ, KS});
+
+        std::vector<Trade> trades;
+        for (int i = 0; i < 10000; ++i) {
+            trades.push_back({sys_days(year(2024) / 1 / 2) + milliseconds(i), i * 0.5, i, i % 2 ? "AAPL" : "MSFT"});
+        }
+        bool verified = upload_table("schema_table", schema::to_table<Trade>(trades), false);
+
+        // The server sees typed columns; reading them back restores every struct
+        std::vector<Trade> back;
+        if (verified) {
+            auto result = inline_query("update size:2*size from schema_table");
+            K table = result.get_result();
+            verified = table && schema::from_table(table, back) && back.size() == trades.size() &&
+                       back[7].ts == trades[7].ts && back[7].size == 14 && back[7].sym == "AAPL";
+            if (table) r0(table);
+        }
+
+        recordResult(verified,
+            verified ? "Structs converted to and from a typed table" : "Schema round trip failed",
+            "Schema Round Trip");
+
+        cleanupTable("schema_table");
+    }
+
+    void testSymbolCache() {
+        // Each distinct string reaches ss() once and maps to the interned pointer
+        SymbolCache cache(1000);
+        std::vector<std::string> column;
+        for (int i = 0; i < 100000; ++i) column.push_back("SYM" + std::to_string((i * 7919) % 500));
+        std::vector<S> symbols(column.size());
+        cache.intern_all(column, symbols.data());
+        bool verified = cache.size() == 500 && cache.misses() == 500 &&
+                        symbols[42] == ss(const_cast<S>(column[42].c_str())) &&
+                        cache.intern("") == ss(const_cast<S>(""));
+
+        // Past max_entries the cache starts over instead of growing
+        SymbolCache small(2);
+        small.intern("a");
+        small.intern("b");
+        verified = verified && small.intern("c") == ss(const_cast<S>("c")) && small.size() == 1;
+
+        recordResult(verified,
+            verified ? "Interned each distinct symbol once" : "Symbol cache returned wrong symbols",
+            "Symbol Cache");
+    }
+
     void printResults() {
         std::cout << "\n=== Make Table Test Results ===\n";
         std::cout << "Total Tests: " << totalTests << "\n";
@@ -3,11 +3,19 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
 #include "inline_query.h"
 #include "read_csv.h"
+#include "follow_csv.h"
+#include "read_csv_glob.h"
+#include "read_fixed.h"
+#include "read_jsonl.h"
+#include "decompress.h"
+#include <zlib.h>
 
 class TestResult {
 public:
@@ -34,6 +42,15 @@ private:
         if (passed) passedTests++;
     }
 
+    // Evaluates a q boolean expression against the server
+    bool checkOnServer(const std::string& expression) {
+        auto check = inline_query(expression);
+        K value = check.get_result();
+        bool passed = value && value->t == -KB && value->g;
+        if (value) r0(value);
+        return passed;
+    }
+
     bool checkFileExists(const std::string& filepath) {
         std::ifstream f(filepath);
         if (!f.good()) {
@@ -108,6 +125,20 @@ public:
             testKeyColumn();	
             testNoHeader();
             testDuplicateTableNames();
+            testLateTypeChange();
+            testFullScanSampling();
+            testTimestampColumns();
+            testGzipInput();
+            testGzipBlockBoundary();
+            testFollowAppends();
+            testFollowInference();
+            testFollowRotation();
+            testGlobIngest();
+            testHdbPartitions();
+            testQuarantineBadRows();
+            testJsonlIngest();
+            testFixedWidthIngest();
+            testBinaryRecordIngest();
         } catch (const std::exception& e) {
             std::cerr << "Test execution error: " << e.what() << std::endl;
         }
@@ -269,6 +300,476 @@ public:
         cleanupTable("duplicate_test");
     }
 
+    char columnType(const std::string& tableName, const std::string& column) {
+        auto result = inline_query("first exec t from meta " + tableName + " where c=`" + column);
+        K type = result.get_result();
+        if (!type || type->t != -KC) return ' ';
+        char t = static_cast<char>(type->g);
+        r0(type);
+        return t;
+    }
+
+    void testLateTypeChange() {
+        std::string filepath = TEST_DATA_DIR + "late_types.csv";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: late_types.csv", "Late Type Change");
+            return;
+        }
+
+        // The first float appears after the head rows, only the stride sample sees it
+        bool result = read_csv("late_types_test", filepath, true);
+        bool verified = result && verifyTableData("late_types_test", 8) &&
+                        columnType("late_types_test", "Value") == 'f';
+
+        recordResult(verified,
+            verified ? "Inferred float from a row past the head" : "Mis-typed column with late float",
+            "Late Type Change");
+
+        inline_query("delete late_types_test from `.");
+    }
+
+    void testFullScanSampling() {
+        std::string filepath = TEST_DATA_DIR + "late_types.csv";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: late_types.csv", "Full Scan Sampling");
+            return;
+        }
+
+        SampleOptions sampling;
+        sampling.mode = SampleMode::FullScan;
+        sampling.threads = 2;
+        bool result = read_csv("full_scan_test", filepath, true, ',', "", {}, sampling);
+        bool verified = result && verifyTableData("full_scan_test", 8) &&
+                        columnType("full_scan_test", "Value") == 'f' &&
+                        columnType("full_scan_test", "ID") == 'i';
+
+        recordResult(verified,
+            verified ? "Full scan inferred all column types" : "Full scan mis-typed a column",
+            "Full Scan Sampling");
+
+        inline_query("delete full_scan_test from `.");
+    }
+
+    void testTimestampColumns() {
+        std::string filepath = TEST_DATA_DIR + "timestamps.csv";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: timestamps.csv", "Timestamp Columns");
+            return;
+        }
+
+        bool result = read_csv("timestamp_test", filepath, true);
+        bool verified = result && verifyTableData("timestamp_test", 3) &&
+                        columnType("timestamp_test", "Timestamp") == 'p' &&
+                        columnType("timestamp_test", "Window") == 'n';
+
+        // Microseconds must survive the load
+        if (verified) {
+            auto micros = inline_query("`long$(last exec Timestamp from timestamp_test) mod 1000000000");
+            K value = micros.get_result();
+            verified = value && value->t == -KJ && value->j == 1000;
+            if (value) r0(value);
+        }
+
+        recordResult(verified,
+            verified ? "Loaded ISO timestamps at full precision" : "Timestamps lost precision or type",
+            "Timestamp Columns");
+
+        inline_query("delete timestamp_test from `.");
+    }
+
+    void testGzipInput() {
+        std::string filepath = TEST_DATA_DIR + "basic_data.csv.gz";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: basic_data.csv.gz", "Gzip Input");
+            return;
+        }
+
+        cleanupTable("gzip_test");
+        bool result = read_csv("gzip_test", filepath, true, ',', "Name");
+        bool verified = result && verifyTableData("gzip_test", 4) &&
+                        columnType("gzip_test", "Age") == 'i' &&
+                        columnType("gzip_test", "Department") == 's';
+
+        recordResult(verified,
+            verified ? "Streamed gzip CSV into a keyed table" : "Failed to load gzip CSV",
+            "Gzip Input");
+
+        cleanupTable("gzip_test");
+    }
+
+    void testGzipBlockBoundary() {
+        // Decompressed size is an exact multiple of the block size, so the last
+        // block fills just as the compressed input runs out
+        const size_t block_size = 4096;
+        std::string data;
+        for (int i = 0; data.size() < 16 * block_size; ++i) {
+            data += "S" + std::to_string(i % 97) + "," + std::to_string(i) + "\n";
+        }
+        data.resize(16 * block_size);
+
+        std::string filepath = (std::filesystem::temp_directory_path() / "kdbear_blocks.csv.gz").string();
+        gzFile gz = gzopen(filepath.c_str(), "wb");
+        bool verified = gz && gzwrite(gz, data.data(), static_cast<unsigned>(data.size())) > 0;
+        if (gz) gzclose(gz);
+
+        if (verified) {
+            DecompressingReader reader(filepath, Compression::Gzip, block_size);
+            std::string block, contents;
+            size_t blocks = 0;
+            while (reader.next(block)) {
+                contents += block;
+                ++blocks;
+            }
+            verified = !reader.failed() && blocks == 16 && contents == data;
+        }
+
+        recordResult(verified,
+            verified ? "Decompressed every full block at end of input" : "Lost or rejected the final gzip block",
+            "Gzip Block Boundary");
+
+        std::filesystem::remove(filepath);
+    }
+
+    void testFollowAppends() {
+        std::string filepath = (std::filesystem::temp_directory_path() / "kdbear_follow.csv").string();
+        {
+            std::ofstream out(filepath, std::ios::trunc);
+            out << "Sym,Qty,Price\nAAPL,100,187.5\nMSFT,250,402.25\n";
+        }
+
+        FollowOptions options;
+        options.column_types = {"s", "j", "f"};
+        CsvFollower follower("follow_test", filepath, options);
+        bool verified = follower.poll() == 2 && verifyTableData("follow_test", 2);
+
+        // Append more rows, leaving the last line unfinished
+        {
+            std::ofstream out(filepath, std::ios::app);
+            out << "IBM,75,165.0\nGOOG,30,141.8\nAMZN,12";
+        }
+        verified = verified && follower.poll() == 2 && verifyTableData("follow_test", 4);
+
+        // The held-back line is loaded once the writer finishes it
+        {
+            std::ofstream out(filepath, std::ios::app);
+            out << ",178.3\n";
+        }
+        verified = verified && follower.poll() == 1 && verifyTableData("follow_test", 5) &&
+                   follower.offset() == std::filesystem::file_size(filepath);
+
+        recordResult(verified,
+            verified ? "Appended only the new complete lines" : "Follow mode missed or repeated rows",
+            "Follow Appends");
+
+        inline_query("delete follow_test from `.");
+        std::filesystem::remove(filepath);
+    }
+
+    void testFollowInference() {
+        std::string filepath = (std::filesystem::temp_directory_path() / "kdbear_follow_infer.csv").string();
+        {
+            std::ofstream out(filepath, std::ios::trunc);
+            out << "Sym,Qty\nAAPL,100\nMSFT,250\n";
+        }
+
+        // No column_types: rows wait until inference_rows have been seen
+        FollowOptions options;
+        options.inference_rows = 4;
+        options.inference_timeout = std::chrono::hours(1);
+        CsvFollower follower("follow_infer", filepath, options);
+        bool verified = follower.poll() == 0 && follower.rows_loaded() == 0;
+
+        // The fourth row decides the type of Qty for all of them
+        {
+            std::ofstream out(filepath, std::ios::app);
+            out << "IBM,75\nGOOG,30.5\n";
+        }
+        verified = verified && follower.poll() == 4 && verifyTableData("follow_infer", 4) &&
+                   columnType("follow_infer", "Qty") == 'f';
+
+        // Rows still held when following stops are loaded by finish()
+        {
+            std::ofstream out(filepath, std::ios::trunc);
+            out << "Sym,Qty\nAAPL,100\n";
+        }
+        CsvFollower early("follow_early", filepath, options);
+        verified = verified && early.poll() == 0 && early.finish() == 1 &&
+                   verifyTableData("follow_early", 1) && columnType("follow_early", "Qty") == 'j';
+
+        recordResult(verified,
+            verified ? "Held rows until the schema could be inferred" : "Schema fixed before inference_rows were seen",
+            "Follow Inference");
+
+        inline_query("delete follow_infer, follow_early from `.");
+        std::filesystem::remove(filepath);
+    }
+
+    void testFollowRotation() {
+        namespace fs = std::filesystem;
+        fs::path filepath = fs::temp_directory_path() / "kdbear_follow_rotate.csv";
+        fs::path rotated = fs::temp_directory_path() / "kdbear_follow_rotate.csv.1";
+        {
+            std::ofstream out(filepath, std::ios::trunc);
+            out << "Sym,Qty\nAAPL,100\nMSFT,250\nIBM,75\n";
+        }
+
+        FollowOptions options;
+        options.column_types = {"s", "j"};
+        CsvFollower follower("follow_rotate", filepath.string(), options);
+        bool verified = follower.poll() == 3;
+
+        // Lines reach the old file after the last poll, then it is rotated away
+        {
+            std::ofstream out(filepath, std::ios::app);
+            out << "GOOG,30\nAMZN,12\n";
+        }
+        fs::rename(filepath, rotated);
+        {
+            std::ofstream out(filepath, std::ios::trunc);
+            out << "Sym,Qty\nNVDA,5\n";
+        }
+
+        verified = verified && follower.poll() == 3 && verifyTableData("follow_rotate", 6);
+        verified = verified && checkOnServer("(exec Sym from follow_rotate) ~ `AAPL`MSFT`IBM`GOOG`AMZN`NVDA");
+
+        recordResult(verified,
+            verified ? "Drained the rotated file before following the new one" : "Lost lines across rotation",
+            "Follow Rotation");
+
+        inline_query("delete follow_rotate from `.");
+        fs::remove(filepath);
+        fs::remove(rotated);
+    }
+
+    void testGlobIngest() {
+        namespace fs = std::filesystem;
+        fs::path dir = fs::temp_directory_path() / "kdbear_glob";
+        fs::create_directories(dir);
+        for (int hour = 0; hour < 3; ++hour) {
+            std::ofstream out(dir / ("trades_0" + std::to_string(hour) + ".csv"), std::ios::trunc);
+            out << "Time,Sym,Price\n";
+            for (int i = 0; i < 4; ++i) {
+                // Later files hold earlier times so the sort is observable
+                out << "0" << (2 - hour) << ":00:0" << i << ",S" << i << "," << 100 + i << ".5\n";
+            }
+        }
+
+        GlobOptions options;
+        options.sort_column = "Time";
+        IngestStats stats;
+        bool result = read_csv_glob("glob_test", (dir / "trades_*.csv").string(), options, &stats);
+        bool verified = result && stats.files == 3 && stats.rows == 12 &&
+                        verifyTableData("glob_test", 12) &&
+                        columnType("glob_test", "Time") == 't';
+
+        verified = verified && checkOnServer("(exec Time from glob_test) ~ asc exec Time from glob_test");
+
+        recordResult(verified,
+            verified ? "Loaded three files into one sorted table" : "Multi-file load failed",
+            "Glob Ingest");
+
+        inline_query("delete glob_test from `.");
+        fs::remove_all(dir);
+    }
+
+    void testHdbPartitions() {
+        std::string filepath = TEST_DATA_DIR + "partitioned.csv";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: partitioned.csv", "HDB Partitions");
+            return;
+        }
+
+        std::string db_root = (std::filesystem::temp_directory_path() / "kdbear_hdb").string();
+        std::filesystem::remove_all(db_root);
+
+        HdbOptions hdb;
+        hdb.db_root = db_root;
+        hdb.partition_column = "Date";
+        bool verified = read_csv("trades", filepath, hdb);
+
+        // Partition sizes, enumerated syms and the dropped date column
+        verified = verified && checkOnServer(
+            "{[db] (3 2~{[db;p] count get ` sv db,p,`trades`}[db] each `2024.12.02`2024.12.03) and"
+            "(`sym in key db) and not `Date in cols get ` sv db,`2024.12.02`trades`}[`$\":" + db_root + "\"]");
+
+        recordResult(verified,
+            verified ? "Wrote one splayed table per date" : "Failed to write date partitions",
+            "HDB Partitions");
+
+        std::filesystem::remove_all(db_root);
+    }
+
+    void testQuarantineBadRows() {
+        std::string filepath = TEST_DATA_DIR + "bad_rows.csv";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: bad_rows.csv", "Quarantine Bad Rows");
+            return;
+        }
+
+        std::string side_file = (std::filesystem::temp_directory_path() / "kdbear_bad_rows.csv").string();
+        QuarantineOptions quarantine;
+        quarantine.file = side_file;
+        quarantine.table = "bad_rows";
+        QuarantineReport report;
+        bool verified = read_csv("quarantine_test", filepath, quarantine, true, ',', "",
+                                 {"s", "j", "j"}, SampleOptions(), &report);
+
+        // Four bad rows (bad long, short row, bad long, extra field); the quoted
+        // multi-line record still loads and pushes the next line number to 9
+        verified = verified && report.rows_loaded == 4 && report.rows_quarantined == 4;
+        verified = verified && checkOnServer(
+            "(4~count quarantine_test) and (3 4 6 9~exec line from bad_rows) and"
+            "(\"Bob,abc,65000\"~first exec record from bad_rows)");
+        if (verified) {
+            std::ifstream side(side_file);
+            std::string line;
+            size_t lines = 0;
+            while (std::getline(side, line)) lines++;
+            verified = lines == 5;  // Header plus one line per bad row
+        }
+
+        recordResult(verified,
+            verified ? "Bad rows diverted with line numbers, the rest loaded" : "Tolerant load failed",
+            "Quarantine Bad Rows");
+
+        // A limit below the number of bad rows abandons the load
+        quarantine.max_bad_rows = 1;
+        quarantine.table.clear();
+        bool abandoned = !read_csv("quarantine_test", filepath, quarantine, true, ',', "", {"s", "j", "j"});
+        recordResult(abandoned,
+            abandoned ? "Load abandoned past the bad-row limit" : "Bad-row limit ignored",
+            "Quarantine Limit");
+
+        // Integers that parse but do not fit the column are bad rows, not nulls
+        std::string range_file = (std::filesystem::temp_directory_path() / "kdbear_range.csv").string();
+        {
+            std::ofstream out(range_file, std::ios::trunc);
+            out << "Name,Qty,Lots\nAAPL,100,1\nMSFT,3000000000,2\nIBM,75,40000\n";
+        }
+        QuarantineOptions range_quarantine;
+        QuarantineReport range_report;
+        bool ranged = read_csv("range_test", range_file, range_quarantine, true, ',', "",
+                               {"s", "i", "h"}, SampleOptions(), &range_report) &&
+                      range_report.rows_loaded == 1 && range_report.rows_quarantined == 2;
+        recordResult(ranged,
+            ranged ? "Out-of-range integers quarantined" : "Out-of-range integers loaded as nulls",
+            "Quarantine Out Of Range");
+
+        inline_query("delete quarantine_test from `.");
+        inline_query("delete bad_rows from `.");
+        inline_query("delete range_test from `.");
+        std::filesystem::remove(side_file);
+        std::filesystem::remove(range_file);
+    }
+
+    void testJsonlIngest() {
+        std::string filepath = TEST_DATA_DIR + "trades.jsonl";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: trades.jsonl", "JSONL Ingest");
+            return;
+        }
+
+        // Small chunks so the four records are parsed by separate tasks
+        JsonlOptions options;
+        options.chunk_bytes = 64;
+        options.threads = 2;
+        bool verified = read_jsonl("jsonl_test", filepath, options);
+
+        // Types inferred as for CSV; fields missing from a record are null
+        verified = verified && checkOnServer(
+            "{[t] (4~count t) and (\"sfitb\"~(exec t from meta t) 1 2 3 4 5) and"
+            "(`AAPL`MSFT`IBM,`$\"Caf\\303\\251 \\\"Q\\\"\")~t`sym) and"
+            "(`XNAS~t[1;`venue]) and null t[2;`price]}[0!jsonl_test]");
+
+        recordResult(verified,
+            verified ? "Loaded NDJSON records with inferred column types" : "JSONL load failed",
+            "JSONL Ingest");
+
+        inline_query("delete jsonl_test from `.");
+    }
+
+    void testFixedWidthIngest() {
+        std::string filepath = TEST_DATA_DIR + "fixed_width.txt";
+        if (!checkFileExists(filepath)) {
+            recordResult(false, "File not found: fixed_width.txt", "Fixed Width Ingest");
+            return;
+        }
+
+        // One record per line; the last line is short and its price is blank
+        std::vector<FixedField> fields = {
+            {"sym", 0, 6, "s"}, {"date", 6, 10, "d"}, {"qty", 16, 6, "j"}, {"price", 22, 8, "f"}};
+        FixedRecordOptions options;
+        options.key_column = "sym";
+        bool verified = read_fixed_width("fixed_test", filepath, fields, options);
+
+        verified = verified && checkOnServer(
+            "{[t] (3~count t) and (\"sdjf\"~(exec t from meta t) 0 1 2 3) and"
+            "(`AAPL`MSFT`IBM~t`sym) and (2024.01.02~t[0;`date]) and (250~t[1;`qty]) and null t[2;`price]}[0!fixed_test]");
+
+        recordResult(verified,
+            verified ? "Loaded fixed-width records by byte range" : "Fixed-width load failed",
+            "Fixed Width Ingest");
+
+        // Blank lines are not records, and the last line need not end in a newline
+        std::string gappy = (std::filesystem::temp_directory_path() / "kdbear_fixed_gaps.txt").string();
+        {
+            std::ofstream out(gappy, std::ios::binary | std::ios::trunc);
+            out << "AAPL  2024.01.02   100  187.50\r\n\r\n\nMSFT  2024.01.02   250  402.10";
+        }
+        bool skipped = read_fixed_width("fixed_gaps", gappy, fields, FixedRecordOptions()) &&
+                       checkOnServer("{[t] (2~count t) and (`AAPL`MSFT~t`sym) and 402.1~t[1;`price]}[0!fixed_gaps]");
+        recordResult(skipped,
+            skipped ? "Skipped blank lines and read the unterminated last line" : "Blank or unterminated lines mishandled",
+            "Fixed Width Blank Lines");
+
+        inline_query("delete fixed_test, fixed_gaps from `.");
+        std::filesystem::remove(gappy);
+    }
+
+    void testBinaryRecordIngest() {
+        // 8-byte symbol, int32 date (days since 2000.01.01), int64 qty, float64 price
+        std::string filepath = (std::filesystem::temp_directory_path() / "kdbear_records.bin").string();
+        {
+            std::ofstream out(filepath, std::ios::binary);
+            out.write("HDR!", 4);
+            for (int i = 0; i < 5000; ++i) {
+                char record[28] = {};
+                std::snprintf(record, 8, "S%d", i % 10);
+                int32_t date = 8766 + i % 7;  // 2024.01.01 onwards
+                int64_t qty = i;
+                double price = i * 0.5;
+                std::memcpy(record + 8, &date, 4);
+                std::memcpy(record + 12, &qty, 8);
+                std::memcpy(record + 20, &price, 8);
+                out.write(record, sizeof(record));
+            }
+        }
+
+        std::vector<FixedField> fields = {
+            {"sym", 0, 8, "s"}, {"date", 8, 4, "d"}, {"qty", 12, 8, "j"}, {"price", 20, 8, "f"}};
+        FixedRecordOptions options;
+        options.record_length = 28;
+        options.skip_bytes = 4;
+        options.batch_rows = 2000;  // Three batches
+        options.threads = 2;
+        bool verified = read_binary_records("binary_test", filepath, fields, options);
+
+        verified = verified && checkOnServer(
+            "{[t] (5000~count t) and (til[5000]~t`qty) and ((0.5*til 5000)~t`price) and"
+            "(`S3~t[4993;`sym]) and (2024.01.04~t[3;`date])}[0!binary_test]");
+
+        // Widths must match the kdb+ representation of the type
+        std::vector<FixedField> bad = {{"qty", 0, 4, "j"}};
+        bool rejected = !read_binary_records("binary_bad", filepath, bad, options);
+
+        recordResult(verified && rejected,
+            verified && rejected ? "Transposed binary records into typed columns" : "Binary record load failed",
+            "Binary Record Ingest");
+
+        inline_query("delete binary_test from `.");
+        std::filesystem::remove(filepath);
+    }
+
     void printResults() {
         std::cout << "\n=== Read CSV Test Results ===\n";
         std::cout << "Total Tests: " << totalTests << "\n";
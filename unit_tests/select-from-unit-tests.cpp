@@ -152,6 +152,24 @@ void test_loc() {
     }
 }
 
+void test_attributes() {
+    std::cout << "Testing get_attributes and set_attribute..." << std::endl;
+
+    inline_query("table1:([] ticker:`GOOG`MSFT`AAPL;price:20 30 40;size:10 20 30)");
+    check(set_attribute("table1", "ticker", Attribute::Grouped), "Failed to group ticker");
+    check(set_attribute("table1", "price", Attribute::Sorted), "Failed to sort-mark ascending price");
+    check(!set_attribute("table1", "ticker", Attribute::Sorted), "Unsorted ticker accepted s#");
+
+    auto attributes = get_attributes("table1");
+    check(attributes.size() == 3, "Expected one attribute per column");
+    check(attributes[0].first == "ticker" && attributes[0].second == Attribute::Grouped, "ticker should be g#");
+    check(attributes[1].second == Attribute::Sorted, "price should be s#");
+    check(attributes[2].second == Attribute::None, "size should have no attribute");
+
+    check(set_attribute("table1", "ticker", Attribute::None), "Failed to remove ticker attribute");
+    check(get_attributes("table1")[0].second == Attribute::None, "ticker attribute not removed");
+}
+
 int main() {
     try {
         // Initialize connection
@@ -162,6 +180,7 @@ int main() {
         test_iloc_unkeyed_table();
         test_iloc_keyed_table();
         test_loc();
+        test_attributes();
 
         std::cout << "All tests passed!" << std::endl;
     } catch (const std::exception& e) {
@@ -0,0 +1,224 @@
+#include "splayed_reader.h"
+#include "splayed_writer.h"
+#include "connections.h"
+#include "inline_query.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+class TestResult {
+public:
+    bool passed;
+    std::string message;
+    std::string testName;
+
+    TestResult(bool p, const std::string& msg, const std::string& name)
+        : passed(p), message(msg), testName(name) {}
+};
+
+class SplayedTests {
+private:
+    std::vector<TestResult> results;
+    int totalTests = 0;
+    int passedTests = 0;
+
+    std::string current_path = std::filesystem::current_path().string();
+    const std::string TEST_DATA_DIR = current_path + "/unit_tests/test_data/";
+    const std::string DB_ROOT = (std::filesystem::temp_directory_path() / "kdbear_splayed").string();
+
+    void recordResult(bool passed, const std::string& message, const std::string& testName) {
+        results.emplace_back(passed, message, testName);
+        totalTests++;
+        if (passed) passedTests++;
+    }
+
+    // Evaluates a q boolean expression against the server
+    bool checkOnServer(const std::string& expression) {
+        auto check = inline_query(expression);
+        K value = check.get_result();
+        bool passed = value && value->t == -KB && value->g;
+        if (value) r0(value);
+        return passed;
+    }
+
+public:
+    void runAllTests() {
+        if (!KDBConnection::connect("localhost", 6000)) {
+            std::cerr << "Failed to connect to KDB+ server" << std::endl;
+            return;
+        }
+
+        try {
+            testWriteRows();
+            testWriteCsv();
+            testPartitionedSymbols();
+            testRejectNestedColumns();
+            testReaderLoopback();
+            testReaderRejectsBadHeader();
+        } catch (const std::exception& e) {
+            std::cerr << "Test execution error: " << e.what() << std::endl;
+        }
+
+        std::filesystem::remove_all(DB_ROOT);
+        KDBConnection::disconnect();
+        printResults();
+    }
+
+    void testWriteRows() {
+        std::filesystem::remove_all(DB_ROOT);
+        std::vector<std::string> columns = {"Name", "Age", "Salary", "Active"};
+        std::vector<std::vector<KDBType>> data = {
+            {std::string("Alice"), 30, 70000.0, true},
+            {std::string("Bob"), 25, std::monostate{}, false},
+            {std::string("Alice"), 41, 52000.5, true}
+        };
+
+        SplayedWriter writer(DB_ROOT);
+        bool verified = writer.write_table("people", columns, data) && writer.symbol_count() == 2;
+
+        // The server reads the columns back with their types and enumerated symbols
+        verified = verified && checkOnServer(
+            "{[t] (\"sjfb\"~exec t from meta t) and (`Alice`Bob`Alice~value t`Name) and"
+            "(30 25 41~t`Age) and null t[`Salary;1]}[select from get `$\":" + DB_ROOT + "/people/\"]");
+
+        recordResult(verified,
+            verified ? "Rows round-trip through the splayed files" : "Failed to write rows as a splayed table",
+            "Write Rows");
+    }
+
+    void testWriteCsv() {
+        std::filesystem::remove_all(DB_ROOT);
+        SplayedWriter writer(DB_ROOT);
+        bool verified = writer.write_csv("basic", TEST_DATA_DIR + "basic_data.csv");
+
+        verified = verified && checkOnServer(
+            "{[c;t] (cols[c]~cols t) and c[`Name]~value t`Name}["
+            "(\"S***\";enlist \",\") 0: `$\":" + TEST_DATA_DIR + "basic_data.csv\";"
+            "select from get `$\":" + DB_ROOT + "/basic/\"]");
+
+        recordResult(verified,
+            verified ? "CSV written without a server load matches 0:" : "Failed to splay a CSV file",
+            "Write CSV");
+    }
+
+    void testPartitionedSymbols() {
+        std::filesystem::remove_all(DB_ROOT);
+        std::vector<std::string> columns = {"sym", "price"};
+        bool verified;
+        {
+            SplayedWriter writer(DB_ROOT);
+            verified = writer.write_table("trades", columns,
+                {{std::string("AAPL"), 1.5}, {std::string("MSFT"), 2.5}}, "2024.12.02");
+        }
+        {
+            // A second writer extends the existing sym file rather than replacing it
+            SplayedWriter writer(DB_ROOT);
+            verified = verified && writer.write_table("trades", columns,
+                {{std::string("IBM"), 3.5}, {std::string("AAPL"), 4.5}}, "2024.12.03");
+            verified = verified && writer.symbol_count() == 3;
+        }
+
+        // Read each partition with get rather than \l, which would move the server's
+        // working directory and load the database into the root namespace
+        verified = verified && checkOnServer(
+            "{[root] d:get `$root,\"/sym\"; p:asc \"D\"$string k where (k:key `$root) like \"????.??.??\";"
+            "s:raze {[root;d;p] d \"j\"$(get `$root,\"/\",string[p],\"/trades/\")`sym}[root;d] each p;"
+            "(`AAPL`MSFT`IBM~d) and (`AAPL`MSFT`IBM`AAPL~s) and 2024.12.02 2024.12.03~p}[\":" + DB_ROOT + "\"]");
+
+        recordResult(verified,
+            verified ? "Partitions share one sym file" : "Failed to write partitioned symbols",
+            "Partitioned Symbols");
+    }
+
+    void testRejectNestedColumns() {
+        std::filesystem::remove_all(DB_ROOT);
+        auto result = inline_query("([] a:1 2; b:(\"ab\";\"cd\"))");
+        K table = result.get_result();
+        SplayedWriter writer(DB_ROOT);
+        bool rejected = table && !writer.write_table("nested", table);
+        if (table) r0(table);
+
+        recordResult(rejected,
+            rejected ? "Nested columns are rejected" : "Accepted a nested column",
+            "Reject Nested Columns");
+    }
+
+    void testReaderLoopback() {
+        std::filesystem::remove_all(DB_ROOT);
+        std::vector<std::string> columns = {"sym", "size", "price"};
+        SplayedWriter writer(DB_ROOT);
+        bool verified = writer.write_table("trades", columns,
+            {{std::string("AAPL"), 100, 1.5}, {std::string("MSFT"), 200, 2.5}, {std::string("AAPL"), 300, 3.5}},
+            "2024.12.02");
+
+        // Read back through the mapped files, finding sym two directories up
+        SplayedTable table(DB_ROOT + "/2024.12.02/trades");
+        verified = verified && table.is_open() && table.rows() == 3 && table.column_type("sym") == KS;
+        if (verified) {
+            auto sizes = table.column<int64_t>("size");
+            auto prices = table.column<double>("price");
+            auto syms = table.symbols("sym");
+            verified = sizes.size() == 3 && sizes[2] == 300 && prices[1] == 2.5 &&
+                       syms.size() == 3 && syms[0] == "AAPL" && syms[1] == "MSFT" &&
+                       table.column<int32_t>("size").empty();
+        }
+        if (verified) {
+            K rows = table.slice(1, 5);
+            verified = rows && kK(kK(rows->k)[1])[0]->n == 2 &&
+                       std::string(kS(kK(kK(rows->k)[1])[0])[1]) == "AAPL";
+            if (rows) r0(rows);
+        }
+
+        recordResult(verified,
+            verified ? "Mapped columns match what the writer wrote" : "Failed to read back a splayed table",
+            "Reader Loopback");
+    }
+
+    void testReaderRejectsBadHeader() {
+        std::filesystem::remove_all(DB_ROOT);
+        SplayedWriter writer(DB_ROOT);
+        bool written = writer.write_table("bad", std::vector<std::string>{"x"}, {{1}, {2}});
+
+        // Truncate the column so it is shorter than its header's count
+        std::filesystem::resize_file(DB_ROOT + "/bad/x", sizeof(splayed::VectorHeader) + 4);
+        SplayedTable truncated(DB_ROOT + "/bad");
+        {
+            std::ofstream out(DB_ROOT + "/bad/x", std::ios::binary | std::ios::trunc);
+            out << "not a kdb+ vector file";
+        }
+        SplayedTable garbage(DB_ROOT + "/bad");
+        bool rejected = written && !truncated.is_open() && !garbage.is_open();
+
+        recordResult(rejected,
+            rejected ? "Truncated and foreign column files are rejected" : "Opened an invalid column file",
+            "Reader Rejects Bad Header");
+    }
+
+    void printResults() {
+        std::cout << "\n=== Splayed Table Test Results ===\n";
+        std::cout << "Total Tests: " << totalTests << "\n";
+        std::cout << "Passed: " << passedTests << "\n";
+        std::cout << "Failed: " << (totalTests - passedTests) << "\n\n";
+
+        for (const auto& result : results) {
+            std::cout << (result.passed ? "[PASS] " : "[FAIL] ")
+                     << result.testName << ": "
+                     << result.message << "\n";
+        }
+        std::cout << "\n";
+    }
+};
+
+int main() {
+    try {
+        std::cout << "Starting Splayed Table Tests...\n";
+        SplayedTests tests;
+        tests.runAllTests();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+}